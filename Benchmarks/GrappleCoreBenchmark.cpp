@@ -0,0 +1,751 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+/**
+ * Microbenchmarks of the grapple core solvers, built by the top level CMakeLists.txt.
+ *
+ *   GrappleCoreBenchmark --benchmark_filter=PendulumBatch
+ *
+ * Items per second are swingers, rope particles, trajectory samples or anchor queries, so runs with different counts
+ * compare directly.
+ */
+
+#include "AnchorGrid.h"
+#include "GrappleSimd.h"
+#include "GrappleSnapshot.h"
+#include "HookBallistics.h"
+#include "Pendulum.h"
+#include "PendulumBatch.h"
+#include "RopeSimulation.h"
+#include "SphericalPendulumBatch.h"
+#include "SphericalPendulumTiers.h"
+#include "SwingPredictor.h"
+#include "SwingQuantizer.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+using namespace GrappleCore;
+
+namespace
+{
+	const float Gravity = -980.f;
+	const float FrameTime = 1.f / 60.f;
+
+	/** Swing setups drawn from the ranges the game produces, the seed keeps runs comparable */
+	struct FSwingSetup
+	{
+		Vec3 Origin;
+		float Velocity;
+		float Angle;
+		float Length;
+		float X, Y;
+	};
+
+	std::vector<FSwingSetup> MakeSwingSetups(int32_t Count)
+	{
+		std::mt19937 Random(1234);
+		std::uniform_real_distribution<float> Position(-10000.f, 10000.f);
+		std::uniform_real_distribution<float> Velocity(-2.f, 2.f);
+		std::uniform_real_distribution<float> Angle(-1.2f, 1.2f);
+		std::uniform_real_distribution<float> Length(200.f, 2000.f);
+		std::uniform_real_distribution<float> Direction(-1.f, 1.f);
+
+		std::vector<FSwingSetup> Setups(Count);
+		for (FSwingSetup& Setup : Setups)
+		{
+			Setup.Origin = Vec3(Position(Random), Position(Random), 1000.f);
+			Setup.Velocity = Velocity(Random);
+			Setup.Angle = Angle(Random);
+			Setup.Length = Length(Random);
+			Setup.X = Direction(Random);
+			Setup.Y = Direction(Random);
+		}
+		return Setups;
+	}
+
+	/** Offsets from the anchor and velocities around it of spherical swings, anywhere short of straight above */
+	struct FSphericalSwingSetup
+	{
+		Vec3 Offset;
+		Vec3 Velocity;
+	};
+
+	std::vector<FSphericalSwingSetup> MakeSphericalSwingSetups(int32_t Count)
+	{
+		std::mt19937 Random(1234);
+		std::uniform_real_distribution<float> Direction(-1.f, 1.f);
+		std::uniform_real_distribution<float> Length(200.f, 2000.f);
+		std::uniform_real_distribution<float> Speed(-2000.f, 2000.f);
+
+		std::vector<FSphericalSwingSetup> Setups(Count);
+		for (FSphericalSwingSetup& Setup : Setups)
+		{
+			Vec3 RopeDirection;
+			do
+			{
+				RopeDirection = Vec3(Direction(Random), Direction(Random), Direction(Random));
+			} while (RopeDirection.SizeSquared() > 1.f || RopeDirection.GetSafeNormal().Z > 0.98f);
+
+			Setup.Offset = RopeDirection.GetSafeNormal() * Length(Random);
+			const Vec3 Velocity(Speed(Random), Speed(Random), Speed(Random));
+			Setup.Velocity = Velocity - RopeDirection.GetSafeNormal() * Dot(Velocity, RopeDirection.GetSafeNormal());
+		}
+		return Setups;
+	}
+
+	/**
+	 * Swingers with a ring of rollback snapshots each, the way a character saves its grapple state every frame. Only
+	 * the GrappleCore part: the swingers share one batch and step together, where UGrappleSubsystem::Resimulate rolls
+	 * one character back at a time on a pendulum of its own and also updates its hooks. The GrappleBenchmark
+	 * commandlet's -Rollback times that path.
+	 */
+	struct FRollbackSetup
+	{
+		static const int32_t RingFrames = 64;
+
+		SphericalPendulumBatch Batch;
+		std::vector<SphericalPendulumBatch::FHandle> Handles;
+		std::vector<SnapshotRing<FCharacterSnapshot, RingFrames>> Rings;
+		uint32_t Frame = 0;
+
+		explicit FRollbackSetup(int32_t Count)
+			: Rings(Count)
+		{
+			for (const FSphericalSwingSetup& Setup : MakeSphericalSwingSetups(Count))
+			{
+				Handles.push_back(Batch.Add(Vec3(0.f, 0.f, 3000.f), Setup.Offset, Setup.Velocity, Vec3(1.f, 0.f, 0.f), Gravity, 600.f));
+			}
+		}
+
+		void SaveFrame()
+		{
+			++Frame;
+			for (size_t Swinger = 0; Swinger < Handles.size(); ++Swinger)
+			{
+				// Frames only move forward, every save finds its slot
+				FCharacterSnapshot& Snapshot = *Rings[Swinger].Save(Frame);
+				Snapshot.Location = Batch.GetPosition(Handles[Swinger]);
+				Snapshot.Velocity = Batch.GetVelocity(Handles[Swinger]);
+				Snapshot.DeltaTime = FrameTime;
+				Snapshot.SwingForward = (Frame & 16) != 0 ? 1.f : 0.f;
+				Snapshot.SwingRight = 0.f;
+				Snapshot.SwingHook = 0;
+				Snapshot.HookCount = 1;
+				Snapshot.Hooks[0].Location = Batch.GetAnchor(Handles[Swinger]);
+				Snapshot.Hooks[0].FlightVelocity = Vec3();
+				Snapshot.Hooks[0].RopeRestLength = 0.f;
+				Snapshot.Hooks[0].State = 3;
+				Batch.GetSwingerState(Handles[Swinger], Snapshot.Swing);
+			}
+		}
+
+		/** Steps and saves frames until every ring is full */
+		void FillRings()
+		{
+			for (int32_t RingFrame = 0; RingFrame < RingFrames; ++RingFrame)
+			{
+				Batch.Update(FrameTime);
+				SaveFrame();
+			}
+		}
+
+		void Restore(uint32_t RestoredFrame)
+		{
+			for (size_t Swinger = 0; Swinger < Handles.size(); ++Swinger)
+			{
+				Batch.SetSwingerState(Handles[Swinger], Rings[Swinger].Find(RestoredFrame)->Swing);
+			}
+		}
+	};
+
+	/** Anchors 5 m apart on a jittered cubic grid, with random query origins and directions inside it */
+	struct FAnchorSetup
+	{
+		std::vector<Vec3> Positions;
+		std::vector<Vec3> Origins;
+		std::vector<Vec3> Directions;
+	};
+
+	FAnchorSetup MakeAnchorSetup(int32_t AnchorCount, int32_t QueryCount)
+	{
+		const float Spacing = 500.f;
+		const int32_t GridSize = static_cast<int32_t>(std::ceil(std::cbrt(static_cast<float>(AnchorCount))));
+		const float HalfWidth = GridSize * Spacing * 0.5f;
+
+		std::mt19937 Random(1234);
+		std::uniform_real_distribution<float> Jitter(-0.4f * Spacing, 0.4f * Spacing);
+		std::uniform_real_distribution<float> Position(-HalfWidth, HalfWidth);
+		std::uniform_real_distribution<float> Direction(-1.f, 1.f);
+
+		FAnchorSetup Setup;
+		for (int32_t Anchor = 0; Anchor < AnchorCount; ++Anchor)
+		{
+			const Vec3 Cell(static_cast<float>(Anchor % GridSize), static_cast<float>((Anchor / GridSize) % GridSize), static_cast<float>(Anchor / (GridSize * GridSize)));
+			Setup.Positions.push_back(Cell * Spacing - Vec3(HalfWidth, HalfWidth, HalfWidth) + Vec3(Jitter(Random), Jitter(Random), Jitter(Random)));
+		}
+		for (int32_t Query = 0; Query < QueryCount; ++Query)
+		{
+			Setup.Origins.push_back(Vec3(Position(Random), Position(Random), Position(Random)));
+			Setup.Directions.push_back(Vec3(Direction(Random), Direction(Random), Direction(Random)).GetSafeNormal());
+		}
+		return Setup;
+	}
+}
+
+/** One frame of the scalar reference pendulum, stepped once per frame like the original game code */
+static void BM_Pendulum(benchmark::State& State)
+{
+	std::vector<Pendulum> Pendulums;
+	for (const FSwingSetup& Setup : MakeSwingSetups(static_cast<int32_t>(State.range(0))))
+	{
+		Pendulums.emplace_back(Setup.Origin, Setup.Velocity, Setup.Angle, Setup.Length, Gravity, Setup.X, Setup.Y);
+	}
+
+	for (auto _ : State)
+	{
+		for (Pendulum& Swinger : Pendulums)
+		{
+			Swinger.update(FrameTime);
+		}
+		benchmark::DoNotOptimize(Pendulums.data());
+		benchmark::ClobberMemory();
+	}
+	State.SetItemsProcessed(State.iterations() * State.range(0));
+}
+BENCHMARK(BM_Pendulum)->RangeMultiplier(4)->Range(4, 4096);
+
+/** One frame of the batch solver with a fixed step of a frame, so a run does exactly one integration step */
+static void BM_PendulumBatch(benchmark::State& State)
+{
+	PendulumBatch Batch;
+	Batch.SetIntegrator(static_cast<PendulumIntegrator>(State.range(0)));
+	Batch.SetFixedTimeStep(FrameTime);
+	for (const FSwingSetup& Setup : MakeSwingSetups(static_cast<int32_t>(State.range(1))))
+	{
+		Batch.Add(Setup.Origin, Setup.Velocity, Setup.Angle, Setup.Length, Gravity, Setup.X, Setup.Y);
+	}
+
+	// A hair over a step, float rounding would otherwise skip the step on some frames
+	const float DeltaTime = FrameTime * 1.0001f;
+	for (auto _ : State)
+	{
+		Batch.Update(DeltaTime);
+		Batch.SetAccumulatedTime(0.f);
+		benchmark::ClobberMemory();
+	}
+	benchmark::DoNotOptimize(Batch.GetPosition(0));
+	State.SetItemsProcessed(State.iterations() * State.range(1));
+}
+BENCHMARK(BM_PendulumBatch)
+	->ArgNames({ "Integrator", "Swingers" })
+	->ArgsProduct({ { static_cast<int64_t>(PendulumIntegrator::SEMI_IMPLICIT_EULER), static_cast<int64_t>(PendulumIntegrator::VERLET), static_cast<int64_t>(PendulumIntegrator::RK4) }, benchmark::CreateRange(4, 4096, 4) });
+
+/** One frame of the spherical solver, steered swingers orbit while the others swing freely */
+static void BM_SphericalPendulumBatch(benchmark::State& State)
+{
+	SphericalPendulumBatch Batch;
+	Batch.SetFixedTimeStep(FrameTime);
+	int32_t Index = 0;
+	for (const FSwingSetup& Setup : MakeSwingSetups(static_cast<int32_t>(State.range(0))))
+	{
+		const Vec3 Offset(Setup.X * Setup.Length * std::sin(Setup.Angle), Setup.Y * Setup.Length * std::sin(Setup.Angle), -Setup.Length * std::cos(Setup.Angle));
+		const SphericalPendulumBatch::FHandle Handle = Batch.Add(Setup.Origin, Offset, Vec3(0.f, Setup.Velocity * Setup.Length, 0.f), Vec3(Setup.X, Setup.Y, 0.f), Gravity, 600.f);
+		if (Index++ % 2 == 0)
+		{
+			Batch.SetSteering(Handle, 0.f, 1.f);
+		}
+	}
+
+	// A hair over a step, float rounding would otherwise skip the step on some frames
+	const float DeltaTime = FrameTime * 1.0001f;
+	for (auto _ : State)
+	{
+		Batch.Update(DeltaTime);
+		Batch.SetAccumulatedTime(0.f);
+		benchmark::ClobberMemory();
+	}
+	benchmark::DoNotOptimize(Batch.GetPosition(0));
+	State.SetItemsProcessed(State.iterations() * State.range(0));
+}
+BENCHMARK(BM_SphericalPendulumBatch)->RangeMultiplier(4)->Range(4, 4096);
+
+/** Frames of a crowd with every swinger in a tier of the given step multiplier, the saving of far significance buckets */
+static void BM_SphericalPendulumTiers(benchmark::State& State)
+{
+	SphericalPendulumTiers Tiers;
+	Tiers.SetTierCount(2);
+	Tiers.SetStepMultiplier(1, static_cast<int32_t>(State.range(0)));
+	Tiers.SetFixedTimeStep(FrameTime);
+	for (const FSwingSetup& Setup : MakeSwingSetups(static_cast<int32_t>(State.range(1))))
+	{
+		const Vec3 Offset(Setup.X * Setup.Length * std::sin(Setup.Angle), Setup.Y * Setup.Length * std::sin(Setup.Angle), -Setup.Length * std::cos(Setup.Angle));
+		Tiers.Add(Setup.Origin, Offset, Vec3(0.f, Setup.Velocity * Setup.Length, 0.f), Vec3(Setup.X, Setup.Y, 0.f), Gravity, 600.f, 1);
+	}
+
+	// Whole frames, tiers with longer steps only step on some of them
+	for (auto _ : State)
+	{
+		Tiers.Update(FrameTime);
+		benchmark::ClobberMemory();
+	}
+	benchmark::DoNotOptimize(Tiers.GetPosition(0));
+	State.SetItemsProcessed(State.iterations() * State.range(1));
+}
+BENCHMARK(BM_SphericalPendulumTiers)
+	->ArgNames({ "StepMultiplier", "Swingers" })
+	->ArgsProduct({ { 1, 2, 4 }, { 256, 4096 } });
+
+/** Add and remove churn, the cost of hooking and releasing */
+static void BM_PendulumBatchChurn(benchmark::State& State)
+{
+	const std::vector<FSwingSetup> Setups = MakeSwingSetups(static_cast<int32_t>(State.range(0)));
+
+	PendulumBatch Batch;
+	std::vector<PendulumBatch::FHandle> Handles;
+	for (const FSwingSetup& Setup : Setups)
+	{
+		Handles.push_back(Batch.Add(Setup.Origin, Setup.Velocity, Setup.Angle, Setup.Length, Gravity, Setup.X, Setup.Y));
+	}
+
+	size_t Next = 0;
+	for (auto _ : State)
+	{
+		const FSwingSetup& Setup = Setups[Next];
+		Batch.Remove(Handles[Next]);
+		Handles[Next] = Batch.Add(Setup.Origin, Setup.Velocity, Setup.Angle, Setup.Length, Gravity, Setup.X, Setup.Y);
+		Next = (Next * 7 + 1) % Setups.size();
+	}
+	State.SetItemsProcessed(State.iterations());
+}
+BENCHMARK(BM_PendulumBatchChurn)->RangeMultiplier(8)->Range(8, 4096);
+
+/** One update of a rope hanging between a swinging character and its anchor */
+static void BM_RopeSimulation(benchmark::State& State)
+{
+	const int32_t Segments = static_cast<int32_t>(State.range(0));
+	const Vec3 Anchor(0.f, 0.f, 1000.f);
+	const Vec3 GravityVector(0.f, 0.f, Gravity);
+
+	RopeSimulation Rope;
+	Rope.Reset(Anchor, Vec3(600.f, 0.f, 200.f), Segments);
+	Rope.SetRestLength(1100.f);
+
+	float Time = 0.f;
+	for (auto _ : State)
+	{
+		// Keep the end moving so the rope never settles
+		Time += FrameTime;
+		const Vec3 End(600.f * std::sin(Time), 0.f, 200.f);
+		Rope.Update(FrameTime, Anchor, End, GravityVector);
+		benchmark::DoNotOptimize(Rope.GetPositions().data());
+		benchmark::ClobberMemory();
+	}
+	State.SetItemsProcessed(State.iterations() * (Segments + 1));
+}
+BENCHMARK(BM_RopeSimulation)->RangeMultiplier(2)->Range(4, 256);
+
+static void BM_SinCos4(benchmark::State& State)
+{
+	std::vector<float> Angles(1024);
+	for (size_t Index = 0; Index < Angles.size(); ++Index)
+	{
+		Angles[Index] = -10.f + 20.f * Index / Angles.size();
+	}
+	std::vector<float> Sines(Angles.size()), Cosines(Angles.size());
+
+	for (auto _ : State)
+	{
+		for (size_t Index = 0; Index < Angles.size(); Index += 4)
+		{
+			Float4 Sin, Cos;
+			SinCos4(Sin, Cos, Load4(Angles.data() + Index));
+			Store4(Sin, Sines.data() + Index);
+			Store4(Cos, Cosines.data() + Index);
+		}
+		benchmark::DoNotOptimize(Sines.data());
+		benchmark::DoNotOptimize(Cosines.data());
+		benchmark::ClobberMemory();
+	}
+	State.SetItemsProcessed(State.iterations() * Angles.size());
+}
+BENCHMARK(BM_SinCos4);
+
+/** Baseline for BM_SinCos4 */
+static void BM_StdSinCos(benchmark::State& State)
+{
+	std::vector<float> Angles(1024);
+	for (size_t Index = 0; Index < Angles.size(); ++Index)
+	{
+		Angles[Index] = -10.f + 20.f * Index / Angles.size();
+	}
+	std::vector<float> Sines(Angles.size()), Cosines(Angles.size());
+
+	for (auto _ : State)
+	{
+		for (size_t Index = 0; Index < Angles.size(); ++Index)
+		{
+			Sines[Index] = std::sin(Angles[Index]);
+			Cosines[Index] = std::cos(Angles[Index]);
+		}
+		benchmark::DoNotOptimize(Sines.data());
+		benchmark::DoNotOptimize(Cosines.data());
+		benchmark::ClobberMemory();
+	}
+	State.SetItemsProcessed(State.iterations() * Angles.size());
+}
+BENCHMARK(BM_StdSinCos);
+
+/** Hook flight stepped frame by frame, until it would reach its maximum range */
+static void BM_HookBallisticsStep(benchmark::State& State)
+{
+	const Vec3 GravityVector(0.f, 0.f, Gravity);
+	const int32_t Frames = static_cast<int32_t>(State.range(0));
+
+	for (auto _ : State)
+	{
+		Vec3 Position;
+		Vec3 Velocity(3000.f, 0.f, 1500.f);
+		for (int32_t Frame = 0; Frame < Frames; ++Frame)
+		{
+			HookBallistics::Step(Position, Velocity, GravityVector, FrameTime, 3000.f);
+		}
+		benchmark::DoNotOptimize(Position);
+	}
+	State.SetItemsProcessed(State.iterations() * Frames);
+}
+BENCHMARK(BM_HookBallisticsStep)->Arg(60)->Arg(240);
+
+static void BM_HookBallisticsSamplePath(benchmark::State& State)
+{
+	const Vec3 GravityVector(0.f, 0.f, Gravity);
+	std::vector<Vec3> Samples(static_cast<size_t>(State.range(0)));
+
+	for (auto _ : State)
+	{
+		HookBallistics::SamplePath(Vec3(), Vec3(3000.f, 0.f, 1500.f), GravityVector, 2.f, static_cast<int32_t>(Samples.size()), Samples.data());
+		benchmark::DoNotOptimize(Samples.data());
+		benchmark::ClobberMemory();
+	}
+	State.SetItemsProcessed(State.iterations() * Samples.size());
+}
+BENCHMARK(BM_HookBallisticsSamplePath)->Arg(16)->Arg(128);
+
+/** Angle of every swing setup two seconds ahead, in closed form */
+static void BM_SwingPredictor(benchmark::State& State)
+{
+	const SwingPredictor& Predictor = SwingPredictor::Get();
+	std::vector<SwingPredictor::FSwing> Swings;
+	for (const FSwingSetup& Setup : MakeSwingSetups(1024))
+	{
+		SwingPredictor::FSwing Swing;
+		if (Predictor.MakeSwing(Setup.Angle, Setup.Velocity, Setup.Length, Gravity, Swing))
+		{
+			Swings.push_back(Swing);
+		}
+	}
+
+	for (auto _ : State)
+	{
+		for (const SwingPredictor::FSwing& Swing : Swings)
+		{
+			benchmark::DoNotOptimize(Predictor.GetAngle(Swing, 2.f));
+		}
+	}
+	State.SetItemsProcessed(State.iterations() * Swings.size());
+}
+BENCHMARK(BM_SwingPredictor);
+
+/** The same two second prediction by stepping the reference pendulum frame by frame, what SwingPredictor replaces */
+static void BM_PendulumStepAhead(benchmark::State& State)
+{
+	const std::vector<FSwingSetup> Setups = MakeSwingSetups(1024);
+	const int32_t Frames = static_cast<int32_t>(2.f / FrameTime);
+
+	for (auto _ : State)
+	{
+		for (const FSwingSetup& Setup : Setups)
+		{
+			Pendulum Swinger(Setup.Origin, Setup.Velocity, Setup.Angle, Setup.Length, Gravity, Setup.X, Setup.Y);
+			for (int32_t Frame = 0; Frame < Frames; ++Frame)
+			{
+				Swinger.update(FrameTime);
+			}
+			benchmark::DoNotOptimize(Swinger.GetAngle());
+		}
+	}
+	State.SetItemsProcessed(State.iterations() * Setups.size());
+}
+BENCHMARK(BM_PendulumStepAhead);
+
+/**
+ * Error of SwingPredictor: largest angle difference, in radians, and distance, in cm, with PendulumBatch's RK4 at a
+ * 0.5 ms step over five seconds of every swing setup. TableError is the part of it due to the table interpolation.
+ * Fails past SwingPredictor::MaxPositionErrorBound or MaxTableErrorBound, the SwingPredictor tests gate the bounds.
+ */
+static void BM_SwingPredictorError(benchmark::State& State)
+{
+	const SwingPredictor& Predictor = SwingPredictor::Get();
+	const float Duration = 5.f;
+	const int32_t Samples = 300;
+
+	double MaxAngleError = 0.0;
+	double MaxPositionError = 0.0;
+	for (auto _ : State)
+	{
+		PendulumBatch Batch;
+		Batch.SetIntegrator(PendulumIntegrator::RK4);
+		Batch.SetFixedTimeStep(0.0005f);
+		Batch.SetMaxSubsteps(1 << 20);
+
+		std::vector<SwingPredictor::FSwing> Swings;
+		std::vector<PendulumBatch::FHandle> Handles;
+		std::vector<float> Lengths;
+		for (const FSwingSetup& Setup : MakeSwingSetups(256))
+		{
+			SwingPredictor::FSwing Swing;
+			if (Predictor.MakeSwing(Setup.Angle, Setup.Velocity, Setup.Length, Gravity, Swing))
+			{
+				Swings.push_back(Swing);
+				Handles.push_back(Batch.Add(Setup.Origin, Setup.Velocity, Setup.Angle, Setup.Length, Gravity, Setup.X, Setup.Y));
+				Lengths.push_back(Setup.Length);
+			}
+		}
+
+		for (int32_t Sample = 1; Sample <= Samples; ++Sample)
+		{
+			Batch.Update(Duration / Samples);
+			const float Time = Duration * Sample / Samples;
+			for (size_t Swinger = 0; Swinger < Swings.size(); ++Swinger)
+			{
+				const float Error = std::remainder(Batch.GetAngle(Handles[Swinger]) - Predictor.GetAngle(Swings[Swinger], Time), 2.f * Pi);
+				MaxAngleError = std::max(MaxAngleError, static_cast<double>(std::abs(Error)));
+				// Chord between the two points on the swing's circle
+				MaxPositionError = std::max(MaxPositionError, 2.0 * Lengths[Swinger] * std::abs(std::sin(0.5 * Error)));
+			}
+		}
+	}
+	State.counters["MaxAngleError"] = MaxAngleError;
+	State.counters["MaxPositionError"] = MaxPositionError;
+	State.counters["TableError"] = Predictor.GetTableError();
+
+	if (MaxPositionError > SwingPredictor::MaxPositionErrorBound)
+	{
+		State.SkipWithError("Predicted swingers are further from the stepped ones than SwingPredictor::MaxPositionErrorBound");
+	}
+	else if (Predictor.GetTableError() > SwingPredictor::MaxTableErrorBound)
+	{
+		State.SkipWithError("SwingPredictor's tables interpolate worse than SwingPredictor::MaxTableErrorBound");
+	}
+}
+BENCHMARK(BM_SwingPredictorError)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+/** Packing and unpacking of a replicated swing state */
+static void BM_SwingQuantizer(benchmark::State& State)
+{
+	const SwingQuantizer Quantizer;
+	const std::vector<FSphericalSwingSetup> Setups = MakeSphericalSwingSetups(1024);
+
+	for (auto _ : State)
+	{
+		for (const FSphericalSwingSetup& Setup : Setups)
+		{
+			Vec3 Offset, Velocity;
+			Quantizer.Dequantize(Quantizer.Quantize(Setup.Offset, Setup.Velocity), Offset, Velocity);
+			benchmark::DoNotOptimize(Offset);
+			benchmark::DoNotOptimize(Velocity);
+		}
+	}
+	State.SetItemsProcessed(State.iterations() * Setups.size());
+}
+BENCHMARK(BM_SwingQuantizer);
+
+/**
+ * Error bound of SwingQuantizer: largest distance between a swing state and its unpacked copy, position in cm and
+ * velocity in cm/s. Bytes is the size of the packed state.
+ */
+static void BM_SwingQuantizerError(benchmark::State& State)
+{
+	const SwingQuantizer Quantizer;
+
+	double MaxPositionError = 0.0;
+	double MaxVelocityError = 0.0;
+	for (auto _ : State)
+	{
+		for (const FSphericalSwingSetup& Setup : MakeSphericalSwingSetups(1 << 16))
+		{
+			Vec3 Offset, Velocity;
+			Quantizer.Dequantize(Quantizer.Quantize(Setup.Offset, Setup.Velocity), Offset, Velocity);
+			MaxPositionError = std::max(MaxPositionError, static_cast<double>(Dist(Offset, Setup.Offset)));
+			MaxVelocityError = std::max(MaxVelocityError, static_cast<double>(Dist(Velocity, Setup.Velocity)));
+		}
+	}
+	State.counters["MaxPositionError"] = MaxPositionError;
+	State.counters["MaxVelocityError"] = MaxVelocityError;
+	State.counters["Bytes"] = static_cast<double>(sizeof(SwingQuantizer::FQuantizedSwing));
+}
+BENCHMARK(BM_SwingQuantizerError)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+/** Rollback snapshot of every swinger at the end of a frame, pendulum state copied into its ring */
+static void BM_SnapshotSave(benchmark::State& State)
+{
+	FRollbackSetup Setup(static_cast<int32_t>(State.range(0)));
+
+	for (auto _ : State)
+	{
+		Setup.SaveFrame();
+		benchmark::ClobberMemory();
+	}
+	State.SetItemsProcessed(State.iterations() * Setup.Handles.size());
+	State.counters["SnapshotBytes"] = static_cast<double>(sizeof(FCharacterSnapshot));
+}
+BENCHMARK(BM_SnapshotSave)->Arg(64)->Arg(1024);
+
+/** Every swinger put back to its state of half a ring ago */
+static void BM_SnapshotRestore(benchmark::State& State)
+{
+	FRollbackSetup Setup(static_cast<int32_t>(State.range(0)));
+	Setup.FillRings();
+
+	for (auto _ : State)
+	{
+		Setup.Restore(Setup.Frame - FRollbackSetup::RingFrames / 2);
+		benchmark::ClobberMemory();
+	}
+	State.SetItemsProcessed(State.iterations() * Setup.Handles.size());
+}
+BENCHMARK(BM_SnapshotRestore)->Arg(64)->Arg(1024);
+
+/**
+ * A whole rollback: restore every swinger Frames frames back, then step and save those frames again with their saved
+ * steering. Items are swingers, so the time per item is the pendulum and snapshot share of one swinger's rollback, a
+ * lower bound of what the commandlet's -Rollback logs per rollback.
+ */
+static void BM_SnapshotResimulate(benchmark::State& State)
+{
+	FRollbackSetup Setup(static_cast<int32_t>(State.range(0)));
+	const uint32_t Frames = static_cast<uint32_t>(State.range(1));
+	Setup.FillRings();
+
+	for (auto _ : State)
+	{
+		const uint32_t NewestFrame = Setup.Frame;
+		Setup.Frame -= Frames;
+		Setup.Restore(Setup.Frame);
+		while (Setup.Frame < NewestFrame)
+		{
+			for (size_t Swinger = 0; Swinger < Setup.Handles.size(); ++Swinger)
+			{
+				const FCharacterSnapshot& Next = *Setup.Rings[Swinger].Find(Setup.Frame + 1);
+				Setup.Batch.SetSteering(Setup.Handles[Swinger], Next.SwingForward, Next.SwingRight);
+			}
+			Setup.Batch.Update(FrameTime);
+			Setup.SaveFrame();
+		}
+		benchmark::ClobberMemory();
+	}
+	State.SetItemsProcessed(State.iterations() * Setup.Handles.size());
+}
+BENCHMARK(BM_SnapshotResimulate)->Args({ 64, 8 })->Args({ 1024, 8 })->Args({ 1024, 32 });
+
+enum class EAnchorQuery : int64_t { Radius, Cone, Raycast };
+
+/** Queries of the GrappleAnchorSubsystem defaults: 10 m cells, 20 m radius, 20 degree cones and rays of 50 m */
+static void BM_AnchorGridQuery(benchmark::State& State)
+{
+	const EAnchorQuery Query = static_cast<EAnchorQuery>(State.range(0));
+	const FAnchorSetup Setup = MakeAnchorSetup(static_cast<int32_t>(State.range(1)), 1024);
+
+	AnchorGrid Grid(1000.f, 50.f);
+	for (const Vec3& Position : Setup.Positions)
+	{
+		Grid.Add(Position);
+	}
+
+	std::vector<AnchorGrid::FHandle> Found;
+	size_t QueryIndex = 0;
+	for (auto _ : State)
+	{
+		const Vec3& Origin = Setup.Origins[QueryIndex];
+		const Vec3& Direction = Setup.Directions[QueryIndex];
+		QueryIndex = (QueryIndex + 1) % Setup.Origins.size();
+
+		Found.clear();
+		switch (Query)
+		{
+		case EAnchorQuery::Radius:
+			Grid.QueryRadius(Origin, 2000.f, Found);
+			break;
+		case EAnchorQuery::Cone:
+			Grid.QueryCone(Origin, Direction, 20.f * Pi / 180.f, 5000.f, Found);
+			break;
+		case EAnchorQuery::Raycast:
+		{
+			AnchorGrid::FHandle Handle;
+			float Distance;
+			Found.push_back(Grid.Raycast(Origin, Direction, 5000.f, Handle, Distance) ? Handle : AnchorGrid::InvalidHandle);
+			break;
+		}
+		}
+		benchmark::DoNotOptimize(Found.data());
+	}
+	State.SetItemsProcessed(State.iterations());
+}
+BENCHMARK(BM_AnchorGridQuery)
+	->ArgNames({ "Query", "Anchors" })
+	->ArgsProduct({ { static_cast<int64_t>(EAnchorQuery::Radius), static_cast<int64_t>(EAnchorQuery::Cone), static_cast<int64_t>(EAnchorQuery::Raycast) }, { 1024, 16384, 131072 } });
+
+/** Radius query by testing every anchor, what the grid saves */
+static void BM_AnchorLinearScan(benchmark::State& State)
+{
+	const FAnchorSetup Setup = MakeAnchorSetup(static_cast<int32_t>(State.range(0)), 1024);
+	const float RadiusSquared = Square(2000.f);
+
+	std::vector<int32_t> Found;
+	size_t QueryIndex = 0;
+	for (auto _ : State)
+	{
+		const Vec3& Origin = Setup.Origins[QueryIndex];
+		QueryIndex = (QueryIndex + 1) % Setup.Origins.size();
+
+		Found.clear();
+		for (int32_t Anchor = 0; Anchor < static_cast<int32_t>(Setup.Positions.size()); ++Anchor)
+		{
+			if (DistSquared(Origin, Setup.Positions[Anchor]) <= RadiusSquared)
+			{
+				Found.push_back(Anchor);
+			}
+		}
+		benchmark::DoNotOptimize(Found.data());
+	}
+	State.SetItemsProcessed(State.iterations());
+}
+BENCHMARK(BM_AnchorLinearScan)->Arg(1024)->Arg(16384)->Arg(131072);
+
+/** Every anchor drifts by up to 50 cm per iteration, most stay in their cells */
+static void BM_AnchorGridMove(benchmark::State& State)
+{
+	const FAnchorSetup Setup = MakeAnchorSetup(static_cast<int32_t>(State.range(0)), 64);
+
+	AnchorGrid Grid(1000.f, 50.f);
+	std::vector<AnchorGrid::FHandle> Handles;
+	for (const Vec3& Position : Setup.Positions)
+	{
+		Handles.push_back(Grid.Add(Position));
+	}
+
+	int32_t Frame = 0;
+	for (auto _ : State)
+	{
+		const Vec3 Offset = Setup.Directions[Frame % Setup.Directions.size()] * 50.f;
+		++Frame;
+		for (size_t Anchor = 0; Anchor < Handles.size(); ++Anchor)
+		{
+			Grid.Move(Handles[Anchor], Setup.Positions[Anchor] + Offset);
+		}
+	}
+	State.SetItemsProcessed(State.iterations() * Handles.size());
+}
+BENCHMARK(BM_AnchorGridMove)->Arg(1024)->Arg(16384);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,14 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+public class GrappleCore : ModuleRules
+{
+	public GrappleCore(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		// Only the module boilerplate uses the engine, the solvers are plain C++ also built by CMakeLists.txt
+		PrivateDependencyModuleNames.AddRange(new string[] { "Core" });
+	}
+}
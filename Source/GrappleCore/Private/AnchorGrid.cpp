@@ -0,0 +1,430 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AnchorGrid.h"
+
+namespace GrappleCore
+{
+	namespace
+	{
+		/** Cell coordinates are packed on 21 bits each, which spans +-10000 km with 1 m cells */
+		const int32_t CellCoordBias = 1 << 20;
+		const int32_t MaxCellCoord = CellCoordBias - 1;
+
+		/** Distance along the ray where it enters the sphere, 0 if Origin is inside, negative if it misses */
+		GRAPPLECORE_FORCEINLINE float RaySphere(const Vec3& Origin, const Vec3& Direction, const Vec3& Center, float RadiusSquared)
+		{
+			const Vec3 ToOrigin = Origin - Center;
+			const float Along = Dot(ToOrigin, Direction);
+			const float Outside = ToOrigin.SizeSquared() - RadiusSquared;
+			if (Outside <= 0.f)
+				return 0.f;
+			if (Along > 0.f)
+				return -1.f;
+
+			const float Discriminant = Along * Along - Outside;
+			return Discriminant >= 0.f ? -Along - std::sqrt(Discriminant) : -1.f;
+		}
+	}
+
+	const AnchorGrid::FHandle AnchorGrid::InvalidHandle;
+
+	AnchorGrid::AnchorGrid(float InCellSize, float InAnchorRadius)
+	{
+		SetCellSize(InCellSize, InAnchorRadius);
+	}
+
+	void AnchorGrid::SetCellSize(float NewCellSize, float NewAnchorRadius)
+	{
+		CellSize = std::max(NewCellSize, 1.f);
+		InvCellSize = 1.f / CellSize;
+		AnchorRadius = Clamp(NewAnchorRadius, 0.f, CellSize * 0.5f);
+
+		Cells.clear();
+		for (FHandle Handle = 0; Handle < static_cast<FHandle>(Anchors.size()); ++Handle)
+		{
+			if (Anchors[Handle].bValid)
+			{
+				Insert(Handle);
+			}
+		}
+	}
+
+	AnchorGrid::FHandle AnchorGrid::Add(const Vec3& Position)
+	{
+		FHandle Handle;
+		if (!FreeHandles.empty())
+		{
+			Handle = FreeHandles.back();
+			FreeHandles.pop_back();
+		}
+		else
+		{
+			Handle = static_cast<FHandle>(Anchors.size());
+			Anchors.emplace_back();
+		}
+
+		FAnchor& Anchor = Anchors[Handle];
+		Anchor.Position = Position;
+		Anchor.bValid = true;
+		Insert(Handle);
+		return Handle;
+	}
+
+	void AnchorGrid::Remove(FHandle Handle)
+	{
+		if (!IsValid(Handle))
+			return;
+
+		Erase(Handle);
+		Anchors[Handle].bValid = false;
+		FreeHandles.push_back(Handle);
+	}
+
+	bool AnchorGrid::IsValid(FHandle Handle) const
+	{
+		return Handle >= 0 && Handle < static_cast<FHandle>(Anchors.size()) && Anchors[Handle].bValid;
+	}
+
+	void AnchorGrid::Move(FHandle Handle, const Vec3& Position)
+	{
+		if (!IsValid(Handle))
+			return;
+
+		FAnchor& Anchor = Anchors[Handle];
+		FCellKey NewCells[8];
+		const int32_t NewCellCount = GetAnchorCells(Position, NewCells);
+
+		if (NewCellCount != Anchor.CellCount || !std::equal(NewCells, NewCells + NewCellCount, Anchor.Cells))
+		{
+			Erase(Handle);
+			Anchor.Position = Position;
+			Insert(Handle);
+			return;
+		}
+
+		// Same cells, only the copies of the position change
+		Anchor.Position = Position;
+		for (int32_t CellIndex = 0; CellIndex < Anchor.CellCount; ++CellIndex)
+		{
+			for (FCellEntry& Entry : Cells[Anchor.Cells[CellIndex]])
+			{
+				if (Entry.Handle == Handle)
+				{
+					Entry.Position = Position;
+					break;
+				}
+			}
+		}
+	}
+
+	void AnchorGrid::Reset()
+	{
+		Cells.clear();
+		Anchors.clear();
+		FreeHandles.clear();
+	}
+
+	template <typename FunctionType>
+	void AnchorGrid::ForEachPointInBox(const Vec3& Min, const Vec3& Max, FunctionType Function) const
+	{
+		int32_t Low[3];
+		int32_t High[3];
+		GetCellCoords(Min, Low[0], Low[1], Low[2]);
+		GetCellCoords(Max, High[0], High[1], High[2]);
+
+		const int64_t CellCount = static_cast<int64_t>(High[0] - Low[0] + 1) * (High[1] - Low[1] + 1) * (High[2] - Low[2] + 1);
+		if (CellCount > Num())
+		{
+			for (FHandle Handle = 0; Handle < static_cast<FHandle>(Anchors.size()); ++Handle)
+			{
+				if (Anchors[Handle].bValid)
+				{
+					Function(Anchors[Handle].Position, Handle);
+				}
+			}
+			return;
+		}
+
+		for (int32_t X = Low[0]; X <= High[0]; ++X)
+		{
+			for (int32_t Y = Low[1]; Y <= High[1]; ++Y)
+			{
+				for (int32_t Z = Low[2]; Z <= High[2]; ++Z)
+				{
+					const auto Found = Cells.find(MakeKey(X, Y, Z));
+					if (Found == Cells.end())
+						continue;
+
+					for (const FCellEntry& Entry : Found->second)
+					{
+						if (Entry.bHome)
+						{
+							Function(Entry.Position, Entry.Handle);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	int32_t AnchorGrid::QueryRadius(const Vec3& Center, float Radius, std::vector<FHandle>& OutHandles) const
+	{
+		if (Radius < 0.f)
+			return 0;
+
+		const size_t FirstFound = OutHandles.size();
+		const float RadiusSquared = Radius * Radius;
+		const Vec3 Extent(Radius, Radius, Radius);
+
+		ForEachPointInBox(Center - Extent, Center + Extent, [&](const Vec3& Position, FHandle Handle)
+		{
+			if (DistSquared(Center, Position) <= RadiusSquared)
+			{
+				OutHandles.push_back(Handle);
+			}
+		});
+		return static_cast<int32_t>(OutHandles.size() - FirstFound);
+	}
+
+	int32_t AnchorGrid::QueryCone(const Vec3& Origin, const Vec3& Direction, float HalfAngle, float MaxDistance, std::vector<FHandle>& OutHandles) const
+	{
+		const Vec3 Axis = Direction.GetSafeNormal();
+		if (MaxDistance < 0.f || Axis.SizeSquared() == 0.f)
+			return 0;
+
+		HalfAngle = Clamp(HalfAngle, 0.f, Pi);
+		const float CosHalfAngle = std::cos(HalfAngle);
+
+		// Bounds of the cone: its apex, the rim of its spherical cap, and the cap's furthest point on the axes inside it
+		Vec3 Min = Origin;
+		Vec3 Max = Origin;
+		if (HalfAngle >= Pi * 0.5f)
+		{
+			const Vec3 Extent(MaxDistance, MaxDistance, MaxDistance);
+			Min = Origin - Extent;
+			Max = Origin + Extent;
+		}
+		else
+		{
+			const Vec3 RimCenter = Origin + Axis * (MaxDistance * CosHalfAngle);
+			const float RimRadius = MaxDistance * std::sin(HalfAngle);
+			float* const MinAxes[3] = { &Min.X, &Min.Y, &Min.Z };
+			float* const MaxAxes[3] = { &Max.X, &Max.Y, &Max.Z };
+			const float OriginAxes[3] = { Origin.X, Origin.Y, Origin.Z };
+			const float RimAxes[3] = { RimCenter.X, RimCenter.Y, RimCenter.Z };
+			const float DirectionAxes[3] = { Axis.X, Axis.Y, Axis.Z };
+
+			for (int32_t AxisIndex = 0; AxisIndex < 3; ++AxisIndex)
+			{
+				const float RimExtent = RimRadius * std::sqrt(std::max(1.f - Square(DirectionAxes[AxisIndex]), 0.f));
+				*MinAxes[AxisIndex] = std::min(*MinAxes[AxisIndex], RimAxes[AxisIndex] - RimExtent);
+				*MaxAxes[AxisIndex] = std::max(*MaxAxes[AxisIndex], RimAxes[AxisIndex] + RimExtent);
+
+				if (DirectionAxes[AxisIndex] >= CosHalfAngle)
+				{
+					*MaxAxes[AxisIndex] = OriginAxes[AxisIndex] + MaxDistance;
+				}
+				if (-DirectionAxes[AxisIndex] >= CosHalfAngle)
+				{
+					*MinAxes[AxisIndex] = OriginAxes[AxisIndex] - MaxDistance;
+				}
+			}
+		}
+
+		const size_t FirstFound = OutHandles.size();
+		const float MaxDistanceSquared = MaxDistance * MaxDistance;
+
+		ForEachPointInBox(Min, Max, [&](const Vec3& Position, FHandle Handle)
+		{
+			const Vec3 ToAnchor = Position - Origin;
+			const float DistanceSquared = ToAnchor.SizeSquared();
+			if (DistanceSquared <= MaxDistanceSquared && Dot(ToAnchor, Axis) >= CosHalfAngle * std::sqrt(DistanceSquared))
+			{
+				OutHandles.push_back(Handle);
+			}
+		});
+		return static_cast<int32_t>(OutHandles.size() - FirstFound);
+	}
+
+	bool AnchorGrid::Raycast(const Vec3& Origin, const Vec3& Direction, float MaxDistance, FHandle& OutHandle, float& OutDistance) const
+	{
+		OutHandle = InvalidHandle;
+		const Vec3 RayDirection = Direction.GetSafeNormal();
+		if (MaxDistance < 0.f || RayDirection.SizeSquared() == 0.f || Num() == 0)
+			return false;
+
+		const float RadiusSquared = AnchorRadius * AnchorRadius;
+		float BestDistance = MaxDistance;
+
+		// A long ray through a sparse grid crosses more empty cells than there are anchors to test
+		if ((MaxDistance * InvCellSize + 1.f) * 3.f > static_cast<float>(Num()))
+		{
+			for (FHandle Handle = 0; Handle < static_cast<FHandle>(Anchors.size()); ++Handle)
+			{
+				const FAnchor& Anchor = Anchors[Handle];
+				if (!Anchor.bValid)
+					continue;
+
+				const float Distance = RaySphere(Origin, RayDirection, Anchor.Position, RadiusSquared);
+				if (Distance >= 0.f && Distance <= BestDistance)
+				{
+					BestDistance = Distance;
+					OutHandle = Handle;
+				}
+			}
+
+			OutDistance = BestDistance;
+			return OutHandle != InvalidHandle;
+		}
+
+		// Amanatides-Woo walk, the ray's parameter at the next boundary of each axis and between two boundaries
+		int32_t Cell[3];
+		GetCellCoords(Origin, Cell[0], Cell[1], Cell[2]);
+		const float OriginAxes[3] = { Origin.X, Origin.Y, Origin.Z };
+		const float DirectionAxes[3] = { RayDirection.X, RayDirection.Y, RayDirection.Z };
+		int32_t Step[3];
+		float NextBoundary[3];
+		float BoundaryInterval[3];
+		for (int32_t AxisIndex = 0; AxisIndex < 3; ++AxisIndex)
+		{
+			const float AxisDirection = DirectionAxes[AxisIndex];
+			if (AxisDirection > 0.f)
+			{
+				Step[AxisIndex] = 1;
+				NextBoundary[AxisIndex] = ((Cell[AxisIndex] + 1) * CellSize - OriginAxes[AxisIndex]) / AxisDirection;
+				BoundaryInterval[AxisIndex] = CellSize / AxisDirection;
+			}
+			else if (AxisDirection < 0.f)
+			{
+				Step[AxisIndex] = -1;
+				NextBoundary[AxisIndex] = (Cell[AxisIndex] * CellSize - OriginAxes[AxisIndex]) / AxisDirection;
+				BoundaryInterval[AxisIndex] = -CellSize / AxisDirection;
+			}
+			else
+			{
+				Step[AxisIndex] = 0;
+				NextBoundary[AxisIndex] = MaxFloat;
+				BoundaryInterval[AxisIndex] = MaxFloat;
+			}
+		}
+
+		for (;;)
+		{
+			// Anchors are filed in every cell they overlap, a sphere entered in this cell is found here
+			const auto Found = Cells.find(MakeKey(Cell[0], Cell[1], Cell[2]));
+			if (Found != Cells.end())
+			{
+				for (const FCellEntry& Entry : Found->second)
+				{
+					const float Distance = RaySphere(Origin, RayDirection, Entry.Position, RadiusSquared);
+					if (Distance >= 0.f && Distance <= BestDistance)
+					{
+						BestDistance = Distance;
+						OutHandle = Entry.Handle;
+					}
+				}
+			}
+
+			const int32_t NextAxis = NextBoundary[0] < NextBoundary[1]
+				? (NextBoundary[0] < NextBoundary[2] ? 0 : 2)
+				: (NextBoundary[1] < NextBoundary[2] ? 1 : 2);
+			const float CellExit = NextBoundary[NextAxis];
+
+			// A hit past this cell may still lose to a sphere entered in the next one
+			if ((OutHandle != InvalidHandle && BestDistance <= CellExit) || CellExit > MaxDistance)
+				break;
+
+			Cell[NextAxis] += Step[NextAxis];
+			NextBoundary[NextAxis] += BoundaryInterval[NextAxis];
+		}
+
+		OutDistance = BestDistance;
+		return OutHandle != InvalidHandle;
+	}
+
+	void AnchorGrid::GetCellCoords(const Vec3& Position, int32_t& OutX, int32_t& OutY, int32_t& OutZ) const
+	{
+		OutX = static_cast<int32_t>(Clamp(std::floor(Position.X * InvCellSize), static_cast<float>(-MaxCellCoord), static_cast<float>(MaxCellCoord)));
+		OutY = static_cast<int32_t>(Clamp(std::floor(Position.Y * InvCellSize), static_cast<float>(-MaxCellCoord), static_cast<float>(MaxCellCoord)));
+		OutZ = static_cast<int32_t>(Clamp(std::floor(Position.Z * InvCellSize), static_cast<float>(-MaxCellCoord), static_cast<float>(MaxCellCoord)));
+	}
+
+	AnchorGrid::FCellKey AnchorGrid::MakeKey(int32_t X, int32_t Y, int32_t Z)
+	{
+		return (static_cast<FCellKey>(X + CellCoordBias) << 42) | (static_cast<FCellKey>(Y + CellCoordBias) << 21) | static_cast<FCellKey>(Z + CellCoordBias);
+	}
+
+	int32_t AnchorGrid::GetAnchorCells(const Vec3& Position, FCellKey* OutCells) const
+	{
+		int32_t Home[3];
+		GetCellCoords(Position, Home[0], Home[1], Home[2]);
+
+		// The radius is at most half a cell, the sphere reaches one neighbour per axis at most
+		const Vec3 Extent(AnchorRadius, AnchorRadius, AnchorRadius);
+		int32_t Low[3];
+		int32_t High[3];
+		GetCellCoords(Position - Extent, Low[0], Low[1], Low[2]);
+		GetCellCoords(Position + Extent, High[0], High[1], High[2]);
+
+		int32_t CellCount = 0;
+		OutCells[CellCount++] = MakeKey(Home[0], Home[1], Home[2]);
+		for (int32_t X = Low[0]; X <= High[0]; ++X)
+		{
+			for (int32_t Y = Low[1]; Y <= High[1]; ++Y)
+			{
+				for (int32_t Z = Low[2]; Z <= High[2]; ++Z)
+				{
+					if (X != Home[0] || Y != Home[1] || Z != Home[2])
+					{
+						OutCells[CellCount++] = MakeKey(X, Y, Z);
+					}
+				}
+			}
+		}
+		return CellCount;
+	}
+
+	void AnchorGrid::Insert(FHandle Handle)
+	{
+		FAnchor& Anchor = Anchors[Handle];
+		Anchor.CellCount = GetAnchorCells(Anchor.Position, Anchor.Cells);
+
+		for (int32_t CellIndex = 0; CellIndex < Anchor.CellCount; ++CellIndex)
+		{
+			FCellEntry Entry;
+			Entry.Position = Anchor.Position;
+			Entry.Handle = Handle;
+			Entry.bHome = CellIndex == 0;
+			Cells[Anchor.Cells[CellIndex]].push_back(Entry);
+		}
+	}
+
+	void AnchorGrid::Erase(FHandle Handle)
+	{
+		FAnchor& Anchor = Anchors[Handle];
+		for (int32_t CellIndex = 0; CellIndex < Anchor.CellCount; ++CellIndex)
+		{
+			const auto Found = Cells.find(Anchor.Cells[CellIndex]);
+			if (Found == Cells.end())
+				continue;
+
+			std::vector<FCellEntry>& Entries = Found->second;
+			for (size_t EntryIndex = 0; EntryIndex < Entries.size(); ++EntryIndex)
+			{
+				if (Entries[EntryIndex].Handle == Handle)
+				{
+					Entries[EntryIndex] = Entries.back();
+					Entries.pop_back();
+					break;
+				}
+			}
+
+			if (Entries.empty())
+			{
+				Cells.erase(Found);
+			}
+		}
+		Anchor.CellCount = 0;
+	}
+}
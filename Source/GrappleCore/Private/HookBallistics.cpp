@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HookBallistics.h"
+
+namespace GrappleCore
+{
+	namespace HookBallistics
+	{
+		void SamplePath(const Vec3& Position, const Vec3& Velocity, const Vec3& Gravity, float Duration, int32_t SampleCount, Vec3* OutPositions)
+		{
+			if (SampleCount <= 0)
+				return;
+
+			const float TimeStep = SampleCount > 1 ? Duration / (SampleCount - 1) : 0.f;
+			for (int32_t Sample = 0; Sample < SampleCount; ++Sample)
+			{
+				OutPositions[Sample] = PredictPosition(Position, Velocity, Gravity, TimeStep * Sample);
+			}
+		}
+	}
+}
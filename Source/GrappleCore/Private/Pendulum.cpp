@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Pendulum.h"
+
+namespace GrappleCore
+{
+	Pendulum::Pendulum()
+	{
+		r = 0.f;
+		angle = 0.f;
+
+		aVelocity = 0.f;
+		aAcceleration = 0.f;
+		damping = 0.f;
+
+		gravity = 0.f;
+
+		x = y = 0.f;
+	}
+
+	// This constructor could be improved to allow a greater variety of pendulums
+	Pendulum::Pendulum(const Vec3& origin_, float velocity_, float angle_, float r_, float gravity_, float _x, float _y)
+	{
+		// Fill all variables
+		origin = origin_;
+		r = r_;
+		angle = angle_;
+
+		aVelocity = velocity_;
+		aAcceleration = 0.f;
+		damping = 1.f;      // Fraction of angular velocity kept after one second
+
+		gravity = gravity_;
+
+		x = _x;
+		y = _y;
+	}
+
+	// Function to update position
+	void Pendulum::update(float deltaTime)
+	{
+		aAcceleration = ((gravity) / r) * std::sin(angle);  // Calculate acceleration (see: http://www.myphysicslab.com/pendulum1.html)
+		aVelocity += aAcceleration * deltaTime;             // Increment velocity
+		aVelocity *= std::pow(damping, deltaTime);          // Damping, scaled to the step length
+		angle += aVelocity * deltaTime;                     // Increment angle
+
+		position = Vec3((x * r * std::sin(angle)) / std::sqrt(Square(x) + Square(y)),
+			(y * r * std::sin(angle)) / std::sqrt(Square(x) + Square(y)),
+			-r * std::cos(angle)) + origin;                 // Polar to cartesian conversion
+	}
+}
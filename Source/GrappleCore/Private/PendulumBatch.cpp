@@ -0,0 +1,236 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PendulumBatch.h"
+#include "GrappleSimd.h"
+
+namespace GrappleCore
+{
+	namespace
+	{
+		struct FStepConstants
+		{
+			Float4 Dt;
+			Float4 HalfDt;
+			Float4 SixthDt;
+			Float4 HalfDtSquared;
+			Float4 Damping;
+		};
+
+		/** Advances four swingers by one fixed step of theta'' = (g / r) * sin(theta) (see: http://www.myphysicslab.com/pendulum1.html) */
+		template <PendulumIntegrator Integrator>
+		GRAPPLECORE_FORCEINLINE void IntegrateLanes(float* GRAPPLECORE_RESTRICT AngleLanes, float* GRAPPLECORE_RESTRICT VelocityLanes, const float* GRAPPLECORE_RESTRICT GravityLanes, const FStepConstants& Step)
+		{
+			Float4 T = Load4(AngleLanes);
+			Float4 W = Load4(VelocityLanes);
+			const Float4 K = Load4(GravityLanes);
+
+			if (Integrator == PendulumIntegrator::SEMI_IMPLICIT_EULER)
+			{
+				W = MultiplyAdd4(Multiply4(K, Sin4(T)), Step.Dt, W);
+				W = Multiply4(W, Step.Damping);
+				T = MultiplyAdd4(W, Step.Dt, T);
+			}
+			else if (Integrator == PendulumIntegrator::VERLET)
+			{
+				const Float4 A0 = Multiply4(K, Sin4(T));
+				T = MultiplyAdd4(A0, Step.HalfDtSquared, MultiplyAdd4(W, Step.Dt, T));
+				const Float4 A1 = Multiply4(K, Sin4(T));
+				W = MultiplyAdd4(Add4(A0, A1), Step.HalfDt, W);
+				W = Multiply4(W, Step.Damping);
+			}
+			else
+			{
+				const Float4 Two = Set4(2.f);
+
+				const Float4 K1T = W;
+				const Float4 K1W = Multiply4(K, Sin4(T));
+				const Float4 K2T = MultiplyAdd4(K1W, Step.HalfDt, W);
+				const Float4 K2W = Multiply4(K, Sin4(MultiplyAdd4(K1T, Step.HalfDt, T)));
+				const Float4 K3T = MultiplyAdd4(K2W, Step.HalfDt, W);
+				const Float4 K3W = Multiply4(K, Sin4(MultiplyAdd4(K2T, Step.HalfDt, T)));
+				const Float4 K4T = MultiplyAdd4(K3W, Step.Dt, W);
+				const Float4 K4W = Multiply4(K, Sin4(MultiplyAdd4(K3T, Step.Dt, T)));
+
+				const Float4 SumT = Add4(Add4(K1T, K4T), Multiply4(Two, Add4(K2T, K3T)));
+				const Float4 SumW = Add4(Add4(K1W, K4W), Multiply4(Two, Add4(K2W, K3W)));
+				T = MultiplyAdd4(SumT, Step.SixthDt, T);
+				W = Multiply4(MultiplyAdd4(SumW, Step.SixthDt, W), Step.Damping);
+			}
+
+			Store4(T, AngleLanes);
+			Store4(W, VelocityLanes);
+		}
+
+		template <PendulumIntegrator Integrator>
+		void IntegrateAll(int32_t Count, float* GRAPPLECORE_RESTRICT AngleData, float* GRAPPLECORE_RESTRICT VelocityData, const float* GRAPPLECORE_RESTRICT GravityData, const FStepConstants& Step)
+		{
+			for (int32_t Index = 0; Index < Count; Index += BatchLanes)
+			{
+				IntegrateLanes<Integrator>(AngleData + Index, VelocityData + Index, GravityData + Index, Step);
+			}
+		}
+	}
+
+	const PendulumBatch::FHandle PendulumBatch::InvalidHandle;
+
+	const LaneStorage<PendulumBatch>::FStream PendulumBatch::Streams[] =
+	{
+		&PendulumBatch::Angle,
+		&PendulumBatch::PreviousAngle,
+		&PendulumBatch::AngularVelocity,
+		&PendulumBatch::GravityOverLength,
+		&PendulumBatch::Length,
+		&PendulumBatch::OriginX,
+		&PendulumBatch::OriginY,
+		&PendulumBatch::OriginZ,
+		&PendulumBatch::PlaneX,
+		&PendulumBatch::PlaneY,
+		&PendulumBatch::PositionX,
+		&PendulumBatch::PositionY,
+		&PendulumBatch::PositionZ,
+	};
+
+	PendulumBatch::PendulumBatch()
+		: Storage(Streams, sizeof(Streams) / sizeof(Streams[0]))
+	{
+		Integrator = PendulumIntegrator::SEMI_IMPLICIT_EULER;
+		FixedTimeStep = 1.f / 120.f;
+		MaxSubsteps = 8;
+		Damping = 1.f;
+		Accumulator = 0.f;
+	}
+
+	PendulumBatch::FHandle PendulumBatch::Add(const Vec3& Origin, float Velocity, float StartAngle, float ArmLength, float Gravity, float X, float Y)
+	{
+		const FHandle Handle = Storage.Allocate(*this);
+		const int32_t Dense = Storage.GetDense(Handle);
+
+		// The plane basis never changes during a swing, normalize it once instead of every update
+		const float PlaneSize = std::sqrt(Square(X) + Square(Y));
+		const float InvPlaneSize = PlaneSize > SmallNumber ? 1.f / PlaneSize : 0.f;
+
+		Angle[Dense] = StartAngle;
+		PreviousAngle[Dense] = StartAngle;
+		AngularVelocity[Dense] = Velocity;
+		GravityOverLength[Dense] = ArmLength > SmallNumber ? Gravity / ArmLength : 0.f;
+		Length[Dense] = ArmLength;
+		OriginX[Dense] = Origin.X;
+		OriginY[Dense] = Origin.Y;
+		OriginZ[Dense] = Origin.Z;
+		PlaneX[Dense] = X * InvPlaneSize;
+		PlaneY[Dense] = Y * InvPlaneSize;
+
+		const float Sin = std::sin(StartAngle);
+		const float Cos = std::cos(StartAngle);
+		PositionX[Dense] = Origin.X + PlaneX[Dense] * ArmLength * Sin;
+		PositionY[Dense] = Origin.Y + PlaneY[Dense] * ArmLength * Sin;
+		PositionZ[Dense] = Origin.Z - ArmLength * Cos;
+
+		return Handle;
+	}
+
+	void PendulumBatch::Remove(FHandle Handle)
+	{
+		if (IsValid(Handle))
+		{
+			Storage.Remove(*this, Handle);
+		}
+	}
+
+	bool PendulumBatch::IsValid(FHandle Handle) const
+	{
+		return Storage.IsValid(Handle);
+	}
+
+	void PendulumBatch::Update(float DeltaTime)
+	{
+		Accumulator += DeltaTime;
+
+		int32_t Steps = static_cast<int32_t>(std::floor(Accumulator / FixedTimeStep));
+		Accumulator -= Steps * FixedTimeStep;
+
+		// Past the substep budget the simulation runs slower than real time instead of spiralling
+		if (Steps > MaxSubsteps)
+		{
+			Steps = MaxSubsteps;
+			Accumulator = 0.f;
+		}
+
+		for (int32_t Step = 0; Step < Steps; ++Step)
+		{
+			Integrate(FixedTimeStep);
+		}
+
+		UpdatePositions(Accumulator / FixedTimeStep);
+	}
+
+	void PendulumBatch::Integrate(float StepTime)
+	{
+		PreviousAngle = Angle;
+
+		FStepConstants Step;
+		Step.Dt = Set4(StepTime);
+		Step.HalfDt = Set4(0.5f * StepTime);
+		Step.SixthDt = Set4(StepTime / 6.f);
+		Step.HalfDtSquared = Set4(0.5f * StepTime * StepTime);
+		Step.Damping = Set4(std::pow(Damping, StepTime));
+
+		const int32_t Count = static_cast<int32_t>(Angle.size());
+		switch (Integrator)
+		{
+		case PendulumIntegrator::SEMI_IMPLICIT_EULER:
+			IntegrateAll<PendulumIntegrator::SEMI_IMPLICIT_EULER>(Count, Angle.data(), AngularVelocity.data(), GravityOverLength.data(), Step);
+			break;
+		case PendulumIntegrator::VERLET:
+			IntegrateAll<PendulumIntegrator::VERLET>(Count, Angle.data(), AngularVelocity.data(), GravityOverLength.data(), Step);
+			break;
+		case PendulumIntegrator::RK4:
+			IntegrateAll<PendulumIntegrator::RK4>(Count, Angle.data(), AngularVelocity.data(), GravityOverLength.data(), Step);
+			break;
+		}
+	}
+
+	void PendulumBatch::UpdatePositions(float Alpha)
+	{
+		const int32_t Count = static_cast<int32_t>(Angle.size());
+		const Float4 VAlpha = Set4(Alpha);
+
+		const float* GRAPPLECORE_RESTRICT AngleData = Angle.data();
+		const float* GRAPPLECORE_RESTRICT PreviousAngleData = PreviousAngle.data();
+		const float* GRAPPLECORE_RESTRICT LengthData = Length.data();
+		const float* GRAPPLECORE_RESTRICT OriginXData = OriginX.data();
+		const float* GRAPPLECORE_RESTRICT OriginYData = OriginY.data();
+		const float* GRAPPLECORE_RESTRICT OriginZData = OriginZ.data();
+		const float* GRAPPLECORE_RESTRICT PlaneXData = PlaneX.data();
+		const float* GRAPPLECORE_RESTRICT PlaneYData = PlaneY.data();
+		float* GRAPPLECORE_RESTRICT PositionXData = PositionX.data();
+		float* GRAPPLECORE_RESTRICT PositionYData = PositionY.data();
+		float* GRAPPLECORE_RESTRICT PositionZData = PositionZ.data();
+
+		for (int32_t Index = 0; Index < Count; Index += BatchLanes)
+		{
+			// Interpolate between the last two fixed steps
+			const Float4 VPrevious = Load4(PreviousAngleData + Index);
+			const Float4 VAngle = MultiplyAdd4(Subtract4(Load4(AngleData + Index), VPrevious), VAlpha, VPrevious);
+
+			// Polar to cartesian conversion
+			Float4 VSin, VCos;
+			SinCos4(VSin, VCos, VAngle);
+			const Float4 VLength = Load4(LengthData + Index);
+			const Float4 VHorizontal = Multiply4(VLength, VSin);
+			Store4(MultiplyAdd4(Load4(PlaneXData + Index), VHorizontal, Load4(OriginXData + Index)), PositionXData + Index);
+			Store4(MultiplyAdd4(Load4(PlaneYData + Index), VHorizontal, Load4(OriginYData + Index)), PositionYData + Index);
+			Store4(Subtract4(Load4(OriginZData + Index), Multiply4(VLength, VCos)), PositionZData + Index);
+		}
+	}
+
+	Vec3 PendulumBatch::GetPosition(FHandle Handle) const
+	{
+		if (!IsValid(Handle))
+			return Vec3();
+
+		const int32_t Dense = Storage.GetDense(Handle);
+		return Vec3(PositionX[Dense], PositionY[Dense], PositionZ[Dense]);
+	}
+}
@@ -0,0 +1,146 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RopeSimulation.h"
+
+namespace GrappleCore
+{
+	namespace
+	{
+		// Larger steps make the rope explode when the hook moves fast, slow the rope down instead
+		const float MaxRopeDeltaTime = 1.f / 30.f;
+	}
+
+	RopeSimulation::RopeSimulation()
+	{
+		RestLength = 0.f;
+		LastMaxStep = 0.f;
+		Damping = 0.98f;
+		Iterations = 4;
+	}
+
+	void RopeSimulation::Reset(const Vec3& Start, const Vec3& End, int32_t SegmentCount)
+	{
+		SegmentCount = std::max(SegmentCount, 1);
+
+		Positions.resize(SegmentCount + 1);
+		for (int32_t Index = 0; Index <= SegmentCount; ++Index)
+		{
+			Positions[Index] = Lerp(Start, End, static_cast<float>(Index) / SegmentCount);
+		}
+		PreviousPositions = Positions;
+
+		RestLength = Dist(Start, End);
+		// A fresh rope has not settled yet
+		LastMaxStep = MaxFloat;
+	}
+
+	void RopeSimulation::SetSegmentCount(int32_t SegmentCount)
+	{
+		SegmentCount = std::max(SegmentCount, 1);
+		if (SegmentCount == GetSegmentCount() || Positions.size() < 2)
+			return;
+
+		Resample(Positions, SegmentCount);
+		Resample(PreviousPositions, SegmentCount);
+	}
+
+	void RopeSimulation::Resample(std::vector<Vec3>& Points, int32_t SegmentCount)
+	{
+		const int32_t PointCount = static_cast<int32_t>(Points.size());
+		float TotalLength = 0.f;
+		for (int32_t Index = 1; Index < PointCount; ++Index)
+		{
+			TotalLength += Dist(Points[Index - 1], Points[Index]);
+		}
+
+		std::vector<Vec3> Resampled(SegmentCount + 1);
+		Resampled[0] = Points[0];
+		Resampled[SegmentCount] = Points.back();
+
+		// Walk the old polyline once, emitting a point every TotalLength / SegmentCount
+		const float Spacing = TotalLength / SegmentCount;
+		int32_t Source = 1;
+		float Walked = 0.f;
+		for (int32_t Index = 1; Index < SegmentCount; ++Index)
+		{
+			const float Target = Spacing * Index;
+			float SegmentLength = Dist(Points[Source - 1], Points[Source]);
+			while (Walked + SegmentLength < Target && Source < PointCount - 1)
+			{
+				Walked += SegmentLength;
+				++Source;
+				SegmentLength = Dist(Points[Source - 1], Points[Source]);
+			}
+
+			const float Alpha = SegmentLength > SmallNumber ? (Target - Walked) / SegmentLength : 0.f;
+			Resampled[Index] = Lerp(Points[Source - 1], Points[Source], Clamp(Alpha, 0.f, 1.f));
+		}
+
+		Points = std::move(Resampled);
+	}
+
+	void RopeSimulation::Update(float DeltaTime, const Vec3& Start, const Vec3& End, const Vec3& Gravity)
+	{
+		const int32_t Count = static_cast<int32_t>(Positions.size());
+		if (Count < 2)
+			return;
+
+		Vec3* GRAPPLECORE_RESTRICT Current = Positions.data();
+		Vec3* GRAPPLECORE_RESTRICT Previous = PreviousPositions.data();
+
+		// Pin both ends
+		Current[0] = Previous[0] = Start;
+		Current[Count - 1] = Previous[Count - 1] = End;
+
+		// Verlet integration of the free particles
+		const float StepTime = std::min(DeltaTime, MaxRopeDeltaTime);
+		const Vec3 GravityStep = Gravity * (StepTime * StepTime);
+		for (int32_t Index = 1; Index < Count - 1; ++Index)
+		{
+			const Vec3 Velocity = (Current[Index] - Previous[Index]) * Damping;
+			Previous[Index] = Current[Index];
+			Current[Index] += Velocity + GravityStep;
+		}
+
+		// Relax the distance constraints, pinned ends never move
+		const float SegmentRestLength = RestLength / (Count - 1);
+		for (int32_t Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			for (int32_t Index = 0; Index < Count - 1; ++Index)
+			{
+				const Vec3 Delta = Current[Index + 1] - Current[Index];
+				const float Length = Delta.Size();
+				if (Length <= SmallNumber)
+					continue;
+
+				const bool bStartPinned = Index == 0;
+				const bool bEndPinned = Index + 1 == Count - 1;
+				if (bStartPinned && bEndPinned)
+					continue;
+
+				const Vec3 Correction = Delta * ((Length - SegmentRestLength) / Length);
+				if (bStartPinned)
+				{
+					Current[Index + 1] -= Correction;
+				}
+				else if (bEndPinned)
+				{
+					Current[Index] += Correction;
+				}
+				else
+				{
+					Current[Index] += Correction * 0.5f;
+					Current[Index + 1] -= Correction * 0.5f;
+				}
+			}
+		}
+
+		float MaxStepSquared = 0.f;
+		for (int32_t Index = 1; Index < Count - 1; ++Index)
+		{
+			MaxStepSquared = std::max(MaxStepSquared, DistSquared(Current[Index], Previous[Index]));
+		}
+		LastMaxStep = std::sqrt(MaxStepSquared);
+	}
+}
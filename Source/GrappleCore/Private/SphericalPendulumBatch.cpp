@@ -0,0 +1,524 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SphericalPendulumBatch.h"
+#include "GrappleSimd.h"
+
+namespace GrappleCore
+{
+	namespace
+	{
+		// Squared lengths below this are treated as zero, padding lanes have a zero offset and a zero rope length
+		const float TinySquared = 1.e-8f;
+
+		struct FStepConstants
+		{
+			Float4 Dt;
+			Float4 HalfDt;
+			Float4 InvDt;
+			Float4 KineticDamping;
+		};
+
+		struct FLanes3
+		{
+			Float4 X, Y, Z;
+		};
+
+		GRAPPLECORE_FORCEINLINE FLanes3 Load3(const float* X, const float* Y, const float* Z)
+		{
+			return FLanes3{ Load4(X), Load4(Y), Load4(Z) };
+		}
+
+		GRAPPLECORE_FORCEINLINE void Store3(const FLanes3& Value, float* X, float* Y, float* Z)
+		{
+			Store4(Value.X, X);
+			Store4(Value.Y, Y);
+			Store4(Value.Z, Z);
+		}
+
+		/** A * B + C per component, B is shared */
+		GRAPPLECORE_FORCEINLINE FLanes3 MultiplyAdd3(const FLanes3& A, const Float4& B, const FLanes3& C)
+		{
+			return FLanes3{ MultiplyAdd4(A.X, B, C.X), MultiplyAdd4(A.Y, B, C.Y), MultiplyAdd4(A.Z, B, C.Z) };
+		}
+
+		GRAPPLECORE_FORCEINLINE FLanes3 Multiply3(const FLanes3& A, const Float4& B)
+		{
+			return FLanes3{ Multiply4(A.X, B), Multiply4(A.Y, B), Multiply4(A.Z, B) };
+		}
+
+		GRAPPLECORE_FORCEINLINE FLanes3 Subtract3(const FLanes3& A, const FLanes3& B)
+		{
+			return FLanes3{ Subtract4(A.X, B.X), Subtract4(A.Y, B.Y), Subtract4(A.Z, B.Z) };
+		}
+
+		GRAPPLECORE_FORCEINLINE Float4 Dot3(const FLanes3& A, const FLanes3& B)
+		{
+			return MultiplyAdd4(A.X, B.X, MultiplyAdd4(A.Y, B.Y, Multiply4(A.Z, B.Z)));
+		}
+
+		/** Scales Offset back onto the sphere of radius Length */
+		GRAPPLECORE_FORCEINLINE FLanes3 ProjectOnSphere(const FLanes3& Offset, const Float4& Length)
+		{
+			const Float4 Size = Sqrt4(Max4(Dot3(Offset, Offset), Set4(TinySquared)));
+			return Multiply3(Offset, Divide4(Length, Size));
+		}
+
+		/** Streams a fixed step reads and writes, the batch's own or the scratch lanes of a single swinger */
+		struct FStepStreams
+		{
+			float* OffsetX;
+			float* OffsetY;
+			float* OffsetZ;
+			float* VelocityX;
+			float* VelocityY;
+			float* VelocityZ;
+			float* Energy;
+			const float* SteerX;
+			const float* SteerY;
+			const float* SteerZ;
+			const float* Length;
+			const float* Gravity;
+		};
+
+		FStepConstants MakeStepConstants(float StepTime, float Damping)
+		{
+			FStepConstants Step;
+			Step.Dt = Set4(StepTime);
+			Step.HalfDt = Set4(0.5f * StepTime);
+			Step.InvDt = Set4(1.f / StepTime);
+			// Speed is damped, kinetic energy goes with its square
+			Step.KineticDamping = Set4(std::pow(Damping, 2.f * StepTime));
+			return Step;
+		}
+
+		/** One fixed step of the lane group starting at Index */
+		GRAPPLECORE_FORCEINLINE void StepLaneGroup(const FStepStreams& Streams, int32_t Index, const FStepConstants& Step)
+		{
+			const Float4 Zero = Set4(0.f);
+			const Float4 One = Set4(1.f);
+			const Float4 Two = Set4(2.f);
+			const Float4 Tiny = Set4(TinySquared);
+
+			FLanes3 P = Load3(Streams.OffsetX + Index, Streams.OffsetY + Index, Streams.OffsetZ + Index);
+			FLanes3 V = Load3(Streams.VelocityX + Index, Streams.VelocityY + Index, Streams.VelocityZ + Index);
+			const FLanes3 S = Load3(Streams.SteerX + Index, Streams.SteerY + Index, Streams.SteerZ + Index);
+			const Float4 L = Load4(Streams.Length + Index);
+			const Float4 G = Load4(Streams.Gravity + Index);
+			Float4 E = Load4(Streams.Energy + Index);
+
+			const FLanes3 A{ S.X, S.Y, Add4(S.Z, G) };
+
+			// RATTLE: half kick, drift, project the position on the sphere and take the velocity from the projected move
+			V = MultiplyAdd3(A, Step.HalfDt, V);
+			const FLanes3 Start = P;
+			P = ProjectOnSphere(MultiplyAdd3(V, Step.Dt, P), L);
+			const FLanes3 Move = Subtract3(P, Start);
+			V = MultiplyAdd3(A, Step.HalfDt, Multiply3(Move, Step.InvDt));
+
+			// Second projection, the velocity has no component along the rope
+			const Float4 Radial = Divide4(Dot3(V, P), Max4(Multiply4(L, L), Tiny));
+			V = Subtract3(V, Multiply3(P, Radial));
+
+			// Steering does work along the move, damping takes a fraction of the kinetic energy
+			E = Add4(E, Dot3(S, Move));
+			const Float4 Potential = Multiply4(Subtract4(Zero, G), P.Z);
+			const Float4 Kinetic = Multiply4(Max4(Subtract4(E, Potential), Zero), Step.KineticDamping);
+			E = Add4(Kinetic, Potential);
+
+			// Give the velocity the speed that energy allows, a swinger at rest keeps its zero velocity
+			const Float4 SpeedSquared = Dot3(V, V);
+			const Float4 Moving = CompareLessEqual4(Tiny, SpeedSquared);
+			const Float4 SpeedScale = Select4(Moving, Sqrt4(Divide4(Multiply4(Two, Kinetic), Max4(SpeedSquared, Tiny))), One);
+			V = Multiply3(V, SpeedScale);
+
+			Store3(P, Streams.OffsetX + Index, Streams.OffsetY + Index, Streams.OffsetZ + Index);
+			Store3(V, Streams.VelocityX + Index, Streams.VelocityY + Index, Streams.VelocityZ + Index);
+			Store4(E, Streams.Energy + Index);
+		}
+	}
+
+	const SphericalPendulumBatch::FHandle SphericalPendulumBatch::InvalidHandle;
+
+	const LaneStorage<SphericalPendulumBatch>::FStream SphericalPendulumBatch::Streams[] =
+	{
+		&SphericalPendulumBatch::OffsetX,
+		&SphericalPendulumBatch::OffsetY,
+		&SphericalPendulumBatch::OffsetZ,
+		&SphericalPendulumBatch::PreviousOffsetX,
+		&SphericalPendulumBatch::PreviousOffsetY,
+		&SphericalPendulumBatch::PreviousOffsetZ,
+		&SphericalPendulumBatch::VelocityX,
+		&SphericalPendulumBatch::VelocityY,
+		&SphericalPendulumBatch::VelocityZ,
+		&SphericalPendulumBatch::SteerX,
+		&SphericalPendulumBatch::SteerY,
+		&SphericalPendulumBatch::SteerZ,
+		&SphericalPendulumBatch::Energy,
+		&SphericalPendulumBatch::Length,
+		&SphericalPendulumBatch::Gravity,
+		&SphericalPendulumBatch::AnchorX,
+		&SphericalPendulumBatch::AnchorY,
+		&SphericalPendulumBatch::AnchorZ,
+		&SphericalPendulumBatch::PositionX,
+		&SphericalPendulumBatch::PositionY,
+		&SphericalPendulumBatch::PositionZ,
+	};
+
+	SphericalPendulumBatch::SphericalPendulumBatch()
+		: Storage(Streams, sizeof(Streams) / sizeof(Streams[0]))
+	{
+		FixedTimeStep = 1.f / 60.f;
+		MaxSubsteps = 8;
+		Damping = 1.f;
+		Accumulator = 0.f;
+		PendingSteps = 0;
+		PendingAlpha = 1.f;
+	}
+
+	SphericalPendulumBatch::FHandle SphericalPendulumBatch::Allocate()
+	{
+		const FHandle Handle = Storage.Allocate(*this);
+		Bases.emplace_back();
+		return Handle;
+	}
+
+	SphericalPendulumBatch::FHandle SphericalPendulumBatch::Add(const Vec3& Anchor, const Vec3& Offset, const Vec3& Velocity, const Vec3& Forward, float InGravity, float SteerAcceleration)
+	{
+		const FHandle Handle = Allocate();
+		const int32_t Dense = Storage.GetDense(Handle);
+
+		SteerX[Dense] = SteerY[Dense] = SteerZ[Dense] = 0.f;
+		Length[Dense] = Offset.Size();
+		Gravity[Dense] = InGravity;
+		AnchorX[Dense] = Anchor.X;
+		AnchorY[Dense] = Anchor.Y;
+		AnchorZ[Dense] = Anchor.Z;
+		SetDenseState(Dense, Offset, Velocity);
+
+		// The basis never changes during a swing, steering only has to combine its two axes
+		FSteeringBasis& Basis = Bases[Dense];
+		Basis.Forward = Vec3(Forward.X, Forward.Y, 0.f).GetSafeNormal();
+		if (Basis.Forward.SizeSquared() == 0.f)
+		{
+			Basis.Forward = Vec3(1.f, 0.f, 0.f);
+		}
+		Basis.Right = Cross(Vec3(0.f, 0.f, 1.f), Basis.Forward);
+		Basis.Acceleration = SteerAcceleration;
+
+		return Handle;
+	}
+
+	SphericalPendulumBatch::FHandle SphericalPendulumBatch::Add(const FSwingerState& State)
+	{
+		const FHandle Handle = Allocate();
+		SetSwingerState(Handle, State);
+		return Handle;
+	}
+
+	SphericalPendulumBatch::FHandle SphericalPendulumBatch::MoveTo(FHandle Handle, SphericalPendulumBatch& Target)
+	{
+		if (!IsValid(Handle))
+			return InvalidHandle;
+
+		const FHandle TargetHandle = Target.Allocate();
+		const int32_t TargetDense = Target.Storage.GetDense(TargetHandle);
+		const int32_t Dense = Storage.GetDense(Handle);
+
+		Storage.CopyLane(*this, Dense, Target, TargetDense);
+		Target.Bases[TargetDense] = Bases[Dense];
+
+		Remove(Handle);
+		return TargetHandle;
+	}
+
+	void SphericalPendulumBatch::Remove(FHandle Handle)
+	{
+		if (!IsValid(Handle))
+			return;
+
+		// The bases follow the streams, the last swinger moved into the freed lane
+		const int32_t Dense = Storage.Remove(*this, Handle);
+		Bases[Dense] = Bases.back();
+		Bases.pop_back();
+	}
+
+	bool SphericalPendulumBatch::IsValid(FHandle Handle) const
+	{
+		return Storage.IsValid(Handle);
+	}
+
+	void SphericalPendulumBatch::SetSteering(FHandle Handle, float Forward, float Right)
+	{
+		if (!IsValid(Handle))
+			return;
+
+		// Diagonal input is not faster than straight input
+		const float InputSizeSquared = Square(Forward) + Square(Right);
+		if (InputSizeSquared > 1.f)
+		{
+			const float InvInputSize = 1.f / std::sqrt(InputSizeSquared);
+			Forward *= InvInputSize;
+			Right *= InvInputSize;
+		}
+
+		const int32_t Dense = Storage.GetDense(Handle);
+		const FSteeringBasis& Basis = Bases[Dense];
+		const Vec3 Steer = (Basis.Forward * Forward + Basis.Right * Right) * Basis.Acceleration;
+		SteerX[Dense] = Steer.X;
+		SteerY[Dense] = Steer.Y;
+		SteerZ[Dense] = Steer.Z;
+	}
+
+	void SphericalPendulumBatch::GetSteeringBasis(FHandle Handle, Vec3& OutForward, Vec3& OutRight) const
+	{
+		if (!IsValid(Handle))
+			return;
+
+		const FSteeringBasis& Basis = Bases[Storage.GetDense(Handle)];
+		OutForward = Basis.Forward;
+		OutRight = Basis.Right;
+	}
+
+	void SphericalPendulumBatch::SetState(FHandle Handle, const Vec3& Offset, const Vec3& Velocity)
+	{
+		if (!IsValid(Handle))
+			return;
+
+		const int32_t Dense = Storage.GetDense(Handle);
+		SetDenseState(Dense, Offset.GetSafeNormal() * Length[Dense], Velocity);
+	}
+
+	void SphericalPendulumBatch::GetSwingerState(FHandle Handle, FSwingerState& OutState) const
+	{
+		if (!IsValid(Handle))
+			return;
+
+		const int32_t Dense = Storage.GetDense(Handle);
+		OutState.Anchor = Vec3(AnchorX[Dense], AnchorY[Dense], AnchorZ[Dense]);
+		OutState.Offset = Vec3(OffsetX[Dense], OffsetY[Dense], OffsetZ[Dense]);
+		OutState.PreviousOffset = Vec3(PreviousOffsetX[Dense], PreviousOffsetY[Dense], PreviousOffsetZ[Dense]);
+		OutState.Velocity = Vec3(VelocityX[Dense], VelocityY[Dense], VelocityZ[Dense]);
+		OutState.Steer = Vec3(SteerX[Dense], SteerY[Dense], SteerZ[Dense]);
+		OutState.Position = Vec3(PositionX[Dense], PositionY[Dense], PositionZ[Dense]);
+		OutState.SteerForward = Bases[Dense].Forward;
+		OutState.SteerRight = Bases[Dense].Right;
+		OutState.SteerAcceleration = Bases[Dense].Acceleration;
+		OutState.Energy = Energy[Dense];
+		OutState.Length = Length[Dense];
+		OutState.Gravity = Gravity[Dense];
+	}
+
+	void SphericalPendulumBatch::SetSwingerState(FHandle Handle, const FSwingerState& State)
+	{
+		if (!IsValid(Handle))
+			return;
+
+		const int32_t Dense = Storage.GetDense(Handle);
+		AnchorX[Dense] = State.Anchor.X;
+		AnchorY[Dense] = State.Anchor.Y;
+		AnchorZ[Dense] = State.Anchor.Z;
+		OffsetX[Dense] = State.Offset.X;
+		OffsetY[Dense] = State.Offset.Y;
+		OffsetZ[Dense] = State.Offset.Z;
+		PreviousOffsetX[Dense] = State.PreviousOffset.X;
+		PreviousOffsetY[Dense] = State.PreviousOffset.Y;
+		PreviousOffsetZ[Dense] = State.PreviousOffset.Z;
+		VelocityX[Dense] = State.Velocity.X;
+		VelocityY[Dense] = State.Velocity.Y;
+		VelocityZ[Dense] = State.Velocity.Z;
+		SteerX[Dense] = State.Steer.X;
+		SteerY[Dense] = State.Steer.Y;
+		SteerZ[Dense] = State.Steer.Z;
+		PositionX[Dense] = State.Position.X;
+		PositionY[Dense] = State.Position.Y;
+		PositionZ[Dense] = State.Position.Z;
+		Bases[Dense].Forward = State.SteerForward;
+		Bases[Dense].Right = State.SteerRight;
+		Bases[Dense].Acceleration = State.SteerAcceleration;
+		Energy[Dense] = State.Energy;
+		Length[Dense] = State.Length;
+		Gravity[Dense] = State.Gravity;
+	}
+
+	void SphericalPendulumBatch::SetDenseState(int32_t Dense, const Vec3& Offset, const Vec3& Velocity)
+	{
+		// Only the velocity around the anchor survives, the rope absorbs the rest
+		const Vec3 Direction = Offset.GetSafeNormal();
+		const Vec3 Tangential = Velocity - Direction * Dot(Velocity, Direction);
+
+		// No interpolation from the old state, it is gone
+		OffsetX[Dense] = PreviousOffsetX[Dense] = Offset.X;
+		OffsetY[Dense] = PreviousOffsetY[Dense] = Offset.Y;
+		OffsetZ[Dense] = PreviousOffsetZ[Dense] = Offset.Z;
+		VelocityX[Dense] = Tangential.X;
+		VelocityY[Dense] = Tangential.Y;
+		VelocityZ[Dense] = Tangential.Z;
+		Energy[Dense] = 0.5f * Tangential.SizeSquared() - Gravity[Dense] * Offset.Z;
+		PositionX[Dense] = AnchorX[Dense] + Offset.X;
+		PositionY[Dense] = AnchorY[Dense] + Offset.Y;
+		PositionZ[Dense] = AnchorZ[Dense] + Offset.Z;
+	}
+
+	void SphericalPendulumBatch::Update(float DeltaTime)
+	{
+		BeginUpdate(DeltaTime);
+		UpdateLaneGroups(0, GetLaneGroupCount());
+	}
+
+	void SphericalPendulumBatch::BeginUpdate(float DeltaTime)
+	{
+		Accumulator += DeltaTime;
+
+		int32_t Steps = static_cast<int32_t>(std::floor(Accumulator / FixedTimeStep));
+		Accumulator -= Steps * FixedTimeStep;
+
+		// Past the substep budget the simulation runs slower than real time instead of spiralling
+		if (Steps > MaxSubsteps)
+		{
+			Steps = MaxSubsteps;
+			Accumulator = 0.f;
+		}
+
+		PendingSteps = Steps;
+		PendingAlpha = Accumulator / FixedTimeStep;
+	}
+
+	void SphericalPendulumBatch::UpdateLaneGroups(int32_t FirstGroup, int32_t GroupCount)
+	{
+		const int32_t Begin = FirstGroup * BatchLanes;
+		const int32_t End = std::min((FirstGroup + GroupCount) * BatchLanes, Storage.GetPaddedCount());
+
+		// Each swinger takes all of its steps in one go, it never waits for the others
+		for (int32_t Step = 0; Step < PendingSteps; ++Step)
+		{
+			Integrate(FixedTimeStep, Begin, End);
+		}
+
+		UpdatePositions(PendingAlpha, Begin, End);
+	}
+
+	void SphericalPendulumBatch::Integrate(float StepTime, int32_t Begin, int32_t End)
+	{
+		std::copy(OffsetX.begin() + Begin, OffsetX.begin() + End, PreviousOffsetX.begin() + Begin);
+		std::copy(OffsetY.begin() + Begin, OffsetY.begin() + End, PreviousOffsetY.begin() + Begin);
+		std::copy(OffsetZ.begin() + Begin, OffsetZ.begin() + End, PreviousOffsetZ.begin() + Begin);
+
+		const FStepStreams Streams{ OffsetX.data(), OffsetY.data(), OffsetZ.data(), VelocityX.data(), VelocityY.data(), VelocityZ.data(),
+			Energy.data(), SteerX.data(), SteerY.data(), SteerZ.data(), Length.data(), Gravity.data() };
+		const FStepConstants Step = MakeStepConstants(StepTime, Damping);
+
+		for (int32_t Index = Begin; Index < End; Index += BatchLanes)
+		{
+			StepLaneGroup(Streams, Index, Step);
+		}
+	}
+
+	void SphericalPendulumBatch::StepSwinger(FHandle Handle, float DeltaTime)
+	{
+		if (!IsValid(Handle) || DeltaTime <= 0.f)
+			return;
+
+		// Equal steps no longer than the fixed step, within a hundredth, that add up to exactly DeltaTime
+		const int32_t Steps = Clamp(static_cast<int32_t>(std::ceil(DeltaTime / FixedTimeStep - 0.01f)), 1, MaxSubsteps);
+		const FStepConstants Step = MakeStepConstants(DeltaTime / Steps, Damping);
+
+		// The swinger takes the first lane of a group of its own, the padding lanes are zeroed like the batch's
+		struct FSwingerLanes
+		{
+			float OffsetX[BatchLanes], OffsetY[BatchLanes], OffsetZ[BatchLanes];
+			float VelocityX[BatchLanes], VelocityY[BatchLanes], VelocityZ[BatchLanes];
+			float Energy[BatchLanes];
+			float SteerX[BatchLanes], SteerY[BatchLanes], SteerZ[BatchLanes];
+			float Length[BatchLanes];
+			float Gravity[BatchLanes];
+		};
+		FSwingerLanes Lanes = {};
+
+		const int32_t Dense = Storage.GetDense(Handle);
+		Lanes.OffsetX[0] = OffsetX[Dense];
+		Lanes.OffsetY[0] = OffsetY[Dense];
+		Lanes.OffsetZ[0] = OffsetZ[Dense];
+		Lanes.VelocityX[0] = VelocityX[Dense];
+		Lanes.VelocityY[0] = VelocityY[Dense];
+		Lanes.VelocityZ[0] = VelocityZ[Dense];
+		Lanes.Energy[0] = Energy[Dense];
+		Lanes.SteerX[0] = SteerX[Dense];
+		Lanes.SteerY[0] = SteerY[Dense];
+		Lanes.SteerZ[0] = SteerZ[Dense];
+		Lanes.Length[0] = Length[Dense];
+		Lanes.Gravity[0] = Gravity[Dense];
+		const FStepStreams Streams{ Lanes.OffsetX, Lanes.OffsetY, Lanes.OffsetZ, Lanes.VelocityX, Lanes.VelocityY, Lanes.VelocityZ,
+			Lanes.Energy, Lanes.SteerX, Lanes.SteerY, Lanes.SteerZ, Lanes.Length, Lanes.Gravity };
+
+		for (int32_t StepIndex = 0; StepIndex < Steps; ++StepIndex)
+		{
+			StepLaneGroup(Streams, 0, Step);
+		}
+
+		// The swinger ends exactly where the time took it, there is nothing to interpolate
+		OffsetX[Dense] = PreviousOffsetX[Dense] = Lanes.OffsetX[0];
+		OffsetY[Dense] = PreviousOffsetY[Dense] = Lanes.OffsetY[0];
+		OffsetZ[Dense] = PreviousOffsetZ[Dense] = Lanes.OffsetZ[0];
+		VelocityX[Dense] = Lanes.VelocityX[0];
+		VelocityY[Dense] = Lanes.VelocityY[0];
+		VelocityZ[Dense] = Lanes.VelocityZ[0];
+		Energy[Dense] = Lanes.Energy[0];
+		PositionX[Dense] = AnchorX[Dense] + OffsetX[Dense];
+		PositionY[Dense] = AnchorY[Dense] + OffsetY[Dense];
+		PositionZ[Dense] = AnchorZ[Dense] + OffsetZ[Dense];
+	}
+
+	void SphericalPendulumBatch::UpdatePositions(float Alpha, int32_t Begin, int32_t End)
+	{
+		const Float4 VAlpha = Set4(Alpha);
+
+		for (int32_t Index = Begin; Index < End; Index += BatchLanes)
+		{
+			// Interpolate between the last two fixed steps and put the result back on the sphere
+			const FLanes3 Previous = Load3(PreviousOffsetX.data() + Index, PreviousOffsetY.data() + Index, PreviousOffsetZ.data() + Index);
+			const FLanes3 Current = Load3(OffsetX.data() + Index, OffsetY.data() + Index, OffsetZ.data() + Index);
+			const FLanes3 Offset = ProjectOnSphere(MultiplyAdd3(Subtract3(Current, Previous), VAlpha, Previous), Load4(Length.data() + Index));
+
+			Store4(Add4(Load4(AnchorX.data() + Index), Offset.X), PositionX.data() + Index);
+			Store4(Add4(Load4(AnchorY.data() + Index), Offset.Y), PositionY.data() + Index);
+			Store4(Add4(Load4(AnchorZ.data() + Index), Offset.Z), PositionZ.data() + Index);
+		}
+	}
+
+	Vec3 SphericalPendulumBatch::GetPosition(FHandle Handle) const
+	{
+		if (!IsValid(Handle))
+			return Vec3();
+
+		const int32_t Dense = Storage.GetDense(Handle);
+		return Vec3(PositionX[Dense], PositionY[Dense], PositionZ[Dense]);
+	}
+
+	Vec3 SphericalPendulumBatch::GetAnchor(FHandle Handle) const
+	{
+		if (!IsValid(Handle))
+			return Vec3();
+
+		const int32_t Dense = Storage.GetDense(Handle);
+		return Vec3(AnchorX[Dense], AnchorY[Dense], AnchorZ[Dense]);
+	}
+
+	Vec3 SphericalPendulumBatch::GetOffset(FHandle Handle) const
+	{
+		if (!IsValid(Handle))
+			return Vec3();
+
+		const int32_t Dense = Storage.GetDense(Handle);
+		return Vec3(OffsetX[Dense], OffsetY[Dense], OffsetZ[Dense]);
+	}
+
+	Vec3 SphericalPendulumBatch::GetVelocity(FHandle Handle) const
+	{
+		if (!IsValid(Handle))
+			return Vec3();
+
+		const int32_t Dense = Storage.GetDense(Handle);
+		return Vec3(VelocityX[Dense], VelocityY[Dense], VelocityZ[Dense]);
+	}
+}
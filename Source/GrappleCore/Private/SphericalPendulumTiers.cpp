@@ -0,0 +1,326 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SphericalPendulumTiers.h"
+
+namespace GrappleCore
+{
+	const SphericalPendulumTiers::FHandle SphericalPendulumTiers::InvalidHandle;
+
+	SphericalPendulumTiers::SphericalPendulumTiers()
+		: Tiers(1)
+		, StepMultipliers(1, 1)
+	{
+		FixedTimeStep = 1.f / 60.f;
+		MaxSubsteps = 8;
+		Damping = 1.f;
+		ApplySettings();
+	}
+
+	void SphericalPendulumTiers::SetTierCount(int32_t TierCount)
+	{
+		TierCount = std::max(TierCount, 1);
+		if (TierCount == GetTierCount())
+			return;
+
+		// New tiers start on the clock of the first one
+		const float AccumulatedTime = GetAccumulatedTime();
+		while (GetTierCount() < TierCount)
+		{
+			Tiers.emplace_back();
+			Tiers.back().SetAccumulatedTime(AccumulatedTime);
+			StepMultipliers.push_back(1);
+		}
+
+		const int32_t LastTier = TierCount - 1;
+		for (FSlot& Slot : Slots)
+		{
+			if (Slot.Tier > LastTier)
+			{
+				if (!Slot.bOwnerStepped)
+				{
+					Slot.Handle = Tiers[Slot.Tier].MoveTo(Slot.Handle, Tiers[LastTier]);
+				}
+				Slot.Tier = LastTier;
+			}
+		}
+		Tiers.resize(TierCount);
+		StepMultipliers.resize(TierCount);
+
+		ApplySettings();
+	}
+
+	void SphericalPendulumTiers::SetStepMultiplier(int32_t Tier, int32_t Multiplier)
+	{
+		Multiplier = std::max(Multiplier, 1);
+		if (Tier < 0 || Tier >= GetTierCount() || StepMultipliers[Tier] == Multiplier)
+			return;
+
+		StepMultipliers[Tier] = Multiplier;
+		ApplySettings();
+	}
+
+	SphericalPendulumTiers::FHandle SphericalPendulumTiers::Add(const Vec3& Anchor, const Vec3& Offset, const Vec3& Velocity, const Vec3& Forward, float Gravity, float SteerAcceleration, int32_t Tier)
+	{
+		FSlot Slot;
+		Slot.Tier = Clamp(Tier, 0, GetTierCount() - 1);
+		Slot.bOwnerStepped = false;
+		Slot.Handle = Tiers[Slot.Tier].Add(Anchor, Offset, Velocity, Forward, Gravity, SteerAcceleration);
+
+		if (!FreeHandles.empty())
+		{
+			const FHandle Handle = FreeHandles.back();
+			FreeHandles.pop_back();
+			Slots[Handle] = Slot;
+			return Handle;
+		}
+
+		Slots.push_back(Slot);
+		return static_cast<FHandle>(Slots.size()) - 1;
+	}
+
+	void SphericalPendulumTiers::Remove(FHandle Handle)
+	{
+		if (!IsValid(Handle))
+			return;
+
+		FSlot& Slot = Slots[Handle];
+		GetBatch(Slot).Remove(Slot.Handle);
+		Slot.Handle = SphericalPendulumBatch::InvalidHandle;
+		FreeHandles.push_back(Handle);
+	}
+
+	bool SphericalPendulumTiers::IsValid(FHandle Handle) const
+	{
+		return Handle >= 0 && Handle < static_cast<FHandle>(Slots.size()) && Slots[Handle].Handle != SphericalPendulumBatch::InvalidHandle;
+	}
+
+	void SphericalPendulumTiers::SetTier(FHandle Handle, int32_t Tier)
+	{
+		if (!IsValid(Handle))
+			return;
+
+		Tier = Clamp(Tier, 0, GetTierCount() - 1);
+		FSlot& Slot = Slots[Handle];
+		if (Slot.Tier == Tier)
+			return;
+
+		if (!Slot.bOwnerStepped)
+		{
+			Slot.Handle = Tiers[Slot.Tier].MoveTo(Slot.Handle, Tiers[Tier]);
+		}
+		Slot.Tier = Tier;
+	}
+
+	int32_t SphericalPendulumTiers::GetTier(FHandle Handle) const
+	{
+		return IsValid(Handle) ? Slots[Handle].Tier : 0;
+	}
+
+	void SphericalPendulumTiers::SetOwnerStepped(FHandle Handle, bool bOwnerStepped)
+	{
+		if (!IsValid(Handle) || Slots[Handle].bOwnerStepped == bOwnerStepped)
+			return;
+
+		FSlot& Slot = Slots[Handle];
+		Slot.Handle = GetBatch(Slot).MoveTo(Slot.Handle, bOwnerStepped ? OwnerStepped : Tiers[Slot.Tier]);
+		Slot.bOwnerStepped = bOwnerStepped;
+	}
+
+	bool SphericalPendulumTiers::IsOwnerStepped(FHandle Handle) const
+	{
+		return IsValid(Handle) && Slots[Handle].bOwnerStepped;
+	}
+
+	void SphericalPendulumTiers::StepSwinger(FHandle Handle, float DeltaTime)
+	{
+		if (IsOwnerStepped(Handle))
+		{
+			OwnerStepped.StepSwinger(Slots[Handle].Handle, DeltaTime);
+		}
+	}
+
+	void SphericalPendulumTiers::SetSteering(FHandle Handle, float Forward, float Right)
+	{
+		if (IsValid(Handle))
+		{
+			GetBatch(Slots[Handle]).SetSteering(Slots[Handle].Handle, Forward, Right);
+		}
+	}
+
+	void SphericalPendulumTiers::GetSteeringBasis(FHandle Handle, Vec3& OutForward, Vec3& OutRight) const
+	{
+		if (IsValid(Handle))
+		{
+			GetBatch(Slots[Handle]).GetSteeringBasis(Slots[Handle].Handle, OutForward, OutRight);
+		}
+	}
+
+	void SphericalPendulumTiers::SetState(FHandle Handle, const Vec3& Offset, const Vec3& Velocity)
+	{
+		if (IsValid(Handle))
+		{
+			GetBatch(Slots[Handle]).SetState(Slots[Handle].Handle, Offset, Velocity);
+		}
+	}
+
+	void SphericalPendulumTiers::GetSwingerState(FHandle Handle, SphericalPendulumBatch::FSwingerState& OutState) const
+	{
+		if (IsValid(Handle))
+		{
+			GetBatch(Slots[Handle]).GetSwingerState(Slots[Handle].Handle, OutState);
+		}
+	}
+
+	void SphericalPendulumTiers::SetSwingerState(FHandle Handle, const SphericalPendulumBatch::FSwingerState& State)
+	{
+		if (IsValid(Handle))
+		{
+			GetBatch(Slots[Handle]).SetSwingerState(Slots[Handle].Handle, State);
+		}
+	}
+
+	void SphericalPendulumTiers::Update(float DeltaTime)
+	{
+		BeginUpdate(DeltaTime);
+		UpdateLaneGroups(0, GetLaneGroupCount());
+	}
+
+	void SphericalPendulumTiers::BeginUpdate(float DeltaTime)
+	{
+		for (SphericalPendulumBatch& Tier : Tiers)
+		{
+			Tier.BeginUpdate(DeltaTime);
+		}
+	}
+
+	void SphericalPendulumTiers::UpdateLaneGroups(int32_t FirstGroup, int32_t GroupCount)
+	{
+		// Walk the tiers until the range is covered, a range may span several of them
+		for (SphericalPendulumBatch& Tier : Tiers)
+		{
+			if (GroupCount <= 0)
+				break;
+
+			const int32_t TierGroups = Tier.GetLaneGroupCount();
+			if (FirstGroup < TierGroups)
+			{
+				const int32_t Count = std::min(GroupCount, TierGroups - FirstGroup);
+				Tier.UpdateLaneGroups(FirstGroup, Count);
+				GroupCount -= Count;
+				FirstGroup = 0;
+			}
+			else
+			{
+				FirstGroup -= TierGroups;
+			}
+		}
+	}
+
+	int32_t SphericalPendulumTiers::GetLaneGroupCount() const
+	{
+		int32_t Count = 0;
+		for (const SphericalPendulumBatch& Tier : Tiers)
+		{
+			Count += Tier.GetLaneGroupCount();
+		}
+		return Count;
+	}
+
+	Vec3 SphericalPendulumTiers::GetPosition(FHandle Handle) const
+	{
+		return IsValid(Handle) ? GetBatch(Slots[Handle]).GetPosition(Slots[Handle].Handle) : Vec3();
+	}
+
+	Vec3 SphericalPendulumTiers::GetAnchor(FHandle Handle) const
+	{
+		return IsValid(Handle) ? GetBatch(Slots[Handle]).GetAnchor(Slots[Handle].Handle) : Vec3();
+	}
+
+	Vec3 SphericalPendulumTiers::GetOffset(FHandle Handle) const
+	{
+		return IsValid(Handle) ? GetBatch(Slots[Handle]).GetOffset(Slots[Handle].Handle) : Vec3();
+	}
+
+	Vec3 SphericalPendulumTiers::GetVelocity(FHandle Handle) const
+	{
+		return IsValid(Handle) ? GetBatch(Slots[Handle]).GetVelocity(Slots[Handle].Handle) : Vec3();
+	}
+
+	int32_t SphericalPendulumTiers::Num() const
+	{
+		int32_t Count = OwnerStepped.Num();
+		for (const SphericalPendulumBatch& Tier : Tiers)
+		{
+			Count += Tier.Num();
+		}
+		return Count;
+	}
+
+	void SphericalPendulumTiers::SetAccumulatedTime(float Time)
+	{
+		for (SphericalPendulumBatch& Tier : Tiers)
+		{
+			Tier.SetAccumulatedTime(Time);
+		}
+	}
+
+	float SphericalPendulumTiers::GetAccumulatedTime(FHandle Handle) const
+	{
+		if (!IsValid(Handle))
+			return GetAccumulatedTime();
+		if (Slots[Handle].bOwnerStepped)
+			return 0.f;
+
+		return Tiers[Slots[Handle].Tier].GetAccumulatedTime();
+	}
+
+	float SphericalPendulumTiers::GetFixedTimeStep(FHandle Handle) const
+	{
+		if (!IsValid(Handle) || Slots[Handle].bOwnerStepped)
+			return FixedTimeStep;
+
+		return FixedTimeStep * StepMultipliers[Slots[Handle].Tier];
+	}
+
+	void SphericalPendulumTiers::SetFixedTimeStep(float NewFixedTimeStep)
+	{
+		if (NewFixedTimeStep == FixedTimeStep)
+			return;
+
+		FixedTimeStep = NewFixedTimeStep;
+		ApplySettings();
+	}
+
+	void SphericalPendulumTiers::SetMaxSubsteps(int32_t NewMaxSubsteps)
+	{
+		if (NewMaxSubsteps == MaxSubsteps)
+			return;
+
+		MaxSubsteps = NewMaxSubsteps;
+		ApplySettings();
+	}
+
+	void SphericalPendulumTiers::SetDamping(float NewDamping)
+	{
+		if (NewDamping == Damping)
+			return;
+
+		Damping = NewDamping;
+		ApplySettings();
+	}
+
+	void SphericalPendulumTiers::ApplySettings()
+	{
+		for (int32_t Tier = 0; Tier < GetTierCount(); ++Tier)
+		{
+			Tiers[Tier].SetFixedTimeStep(FixedTimeStep * StepMultipliers[Tier]);
+			Tiers[Tier].SetMaxSubsteps(MaxSubsteps);
+			Tiers[Tier].SetDamping(Damping);
+		}
+
+		OwnerStepped.SetFixedTimeStep(FixedTimeStep);
+		OwnerStepped.SetMaxSubsteps(MaxSubsteps);
+		OwnerStepped.SetDamping(Damping);
+	}
+}
@@ -0,0 +1,265 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SwingPredictor.h"
+
+namespace GrappleCore
+{
+	namespace
+	{
+		const double HalfPi = 1.57079632679489661923;
+
+		/** Carlson's symmetric elliptic integral RF, by duplication */
+		double CarlsonRF(double X, double Y, double Z)
+		{
+			for (;;)
+			{
+				const double Mean = (X + Y + Z) / 3.0;
+				const double DeltaX = 1.0 - X / Mean;
+				const double DeltaY = 1.0 - Y / Mean;
+				const double DeltaZ = 1.0 - Z / Mean;
+				if (std::max(std::abs(DeltaX), std::max(std::abs(DeltaY), std::abs(DeltaZ))) < 1.e-4)
+				{
+					const double E2 = DeltaX * DeltaY - DeltaZ * DeltaZ;
+					const double E3 = DeltaX * DeltaY * DeltaZ;
+					return (1.0 - E2 / 10.0 + E3 / 14.0 + E2 * E2 / 24.0 - 3.0 * E2 * E3 / 44.0) / std::sqrt(Mean);
+				}
+
+				const double SqrtX = std::sqrt(X);
+				const double SqrtY = std::sqrt(Y);
+				const double SqrtZ = std::sqrt(Z);
+				const double Lambda = SqrtX * (SqrtY + SqrtZ) + SqrtY * SqrtZ;
+				X = (X + Lambda) * 0.25;
+				Y = (Y + Lambda) * 0.25;
+				Z = (Z + Lambda) * 0.25;
+			}
+		}
+
+		/** Complete elliptic integral of the first kind K(k), from the arithmetic-geometric mean of 1 and sqrt(1 - k^2) */
+		double EllipticK(double ComplementaryModulus)
+		{
+			double Arithmetic = 1.0;
+			double Geometric = ComplementaryModulus;
+			for (int32_t Iteration = 0; Iteration < 16 && std::abs(Arithmetic - Geometric) > 1.e-12 * Arithmetic; ++Iteration)
+			{
+				const double NextArithmetic = 0.5 * (Arithmetic + Geometric);
+				Geometric = std::sqrt(Arithmetic * Geometric);
+				Arithmetic = NextArithmetic;
+			}
+			return HalfPi / Arithmetic;
+		}
+
+		/** Incomplete elliptic integral of the first kind F(Phi, k), for Phi in [0, Pi / 2] */
+		double EllipticF(double Phi, double Modulus)
+		{
+			const double SinPhi = std::sin(Phi);
+			const double CosPhi = std::cos(Phi);
+			return SinPhi * CarlsonRF(CosPhi * CosPhi, 1.0 - Square(Modulus * SinPhi), 1.0);
+		}
+
+		/** Jacobi amplitude am(U, k), the Phi for which F(Phi, k) = U, for U in [0, K(k)] */
+		double JacobiAmplitude(double U, double Modulus, double QuarterPeriod)
+		{
+			// Newton on F, whose derivative is 1 / sqrt(1 - k^2 sin^2 Phi), kept inside a shrinking bracket
+			double Low = 0.0;
+			double High = HalfPi;
+			double Phi = U / QuarterPeriod * HalfPi;
+			for (int32_t Iteration = 0; Iteration < 64; ++Iteration)
+			{
+				const double Error = EllipticF(Phi, Modulus) - U;
+				if (std::abs(Error) < 1.e-12)
+					break;
+
+				(Error > 0.0 ? High : Low) = Phi;
+				Phi -= Error * std::sqrt(1.0 - Square(Modulus * std::sin(Phi)));
+				if (Phi <= Low || Phi >= High)
+				{
+					Phi = 0.5 * (Low + High);
+				}
+			}
+			return Phi;
+		}
+	}
+
+	constexpr float SwingPredictor::MaxPositionErrorBound;
+	constexpr float SwingPredictor::MaxTableErrorBound;
+
+	SwingPredictor::SwingPredictor(float InMaxAmplitude, int32_t InAmplitudeSamples, int32_t InPhaseSamples)
+		: MaxAmplitude(Clamp(InMaxAmplitude, SmallNumber, Pi - 0.01f))
+		, AmplitudeSamples(std::max(InAmplitudeSamples, 2))
+		, PhaseSamples(std::max(InPhaseSamples, 2))
+		, TableError(0.f)
+	{
+		AmplitudeToSample = (AmplitudeSamples - 1) / MaxAmplitude;
+		AmplitudeFractions.resize(AmplitudeSamples * PhaseSamples);
+		PhaseFractions.resize(AmplitudeSamples * PhaseSamples);
+
+		for (int32_t AmplitudeSample = 0; AmplitudeSample < AmplitudeSamples; ++AmplitudeSample)
+		{
+			const double Modulus = std::sin(0.5 * AmplitudeSample * MaxAmplitude / (AmplitudeSamples - 1));
+			const double QuarterPeriod = EllipticK(std::sqrt(1.0 - Modulus * Modulus));
+
+			for (int32_t PhaseSample = 0; PhaseSample < PhaseSamples; ++PhaseSample)
+			{
+				const double Fraction = static_cast<double>(PhaseSample) / (PhaseSamples - 1);
+				const int32_t Index = AmplitudeSample * PhaseSamples + PhaseSample;
+				AmplitudeFractions[Index] = static_cast<float>(JacobiAmplitude(Fraction * QuarterPeriod, Modulus, QuarterPeriod) / HalfPi);
+				PhaseFractions[Index] = static_cast<float>(EllipticF(Fraction * HalfPi, Modulus) / QuarterPeriod);
+			}
+		}
+
+		// Interpolation error halfway between samples, where it peaks, as an angle
+		for (int32_t AmplitudeSample = 0; AmplitudeSample + 1 < AmplitudeSamples; ++AmplitudeSample)
+		{
+			const float Amplitude = (AmplitudeSample + 0.5f) / AmplitudeToSample;
+			const double Modulus = std::sin(0.5 * Amplitude);
+			const double QuarterPeriod = EllipticK(std::cos(0.5 * Amplitude));
+
+			for (int32_t PhaseSample = 0; PhaseSample + 1 < PhaseSamples; ++PhaseSample)
+			{
+				const float Fraction = (PhaseSample + 0.5f) / (PhaseSamples - 1);
+				const double ExactPhi = JacobiAmplitude(Fraction * QuarterPeriod, Modulus, QuarterPeriod);
+				const double ExactAngle = 2.0 * std::asin(Modulus * std::sin(ExactPhi));
+				const double Angle = 2.0 * std::asin(Modulus * std::sin(LookupAmplitudeFraction(Amplitude, Fraction) * HalfPi));
+				TableError = std::max(TableError, static_cast<float>(std::abs(Angle - ExactAngle)));
+			}
+		}
+	}
+
+	const SwingPredictor& SwingPredictor::Get()
+	{
+		static const SwingPredictor DefaultPredictor;
+		return DefaultPredictor;
+	}
+
+	bool SwingPredictor::MakeSwing(float Angle, float AngularVelocity, float Length, float Gravity, FSwing& OutSwing) const
+	{
+		if (Length <= SmallNumber || Gravity >= 0.f)
+			return false;
+
+		// Energy per unit of mass gives the amplitude: cos(Amplitude) = cos(Angle) - AngularVelocity^2 / (2 Frequency^2)
+		Angle = std::remainder(Angle, 2.f * Pi);
+		const float FrequencySquared = -Gravity / Length;
+		const float CosAmplitude = std::cos(Angle) - Square(AngularVelocity) / (2.f * FrequencySquared);
+		if (CosAmplitude < std::cos(MaxAmplitude))
+			return false;
+
+		OutSwing.Amplitude = std::acos(std::min(CosAmplitude, 1.f));
+		OutSwing.Frequency = std::sqrt(FrequencySquared);
+
+		OutSwing.QuarterPeriod = static_cast<float>(EllipticK(std::cos(0.5 * OutSwing.Amplitude))) / OutSwing.Frequency;
+
+		// Fraction of the quarter period from the bottom to the current angle, then the quarter from the direction
+		const float Modulus = std::sin(0.5f * OutSwing.Amplitude);
+		float Fraction = 0.f;
+		if (Modulus > SmallNumber * SmallNumber)
+		{
+			const float AmplitudeFraction = std::asin(Clamp(std::sin(0.5f * std::abs(Angle)) / Modulus, 0.f, 1.f)) / (0.5f * Pi);
+			Fraction = LookupPhaseFraction(OutSwing.Amplitude, AmplitudeFraction);
+		}
+
+		if (Angle >= 0.f)
+		{
+			OutSwing.StartPhase = AngularVelocity >= 0.f ? Fraction : 2.f - Fraction;
+		}
+		else
+		{
+			OutSwing.StartPhase = AngularVelocity < 0.f ? 2.f + Fraction : 4.f - Fraction;
+		}
+		if (OutSwing.StartPhase >= 4.f)
+		{
+			OutSwing.StartPhase -= 4.f;
+		}
+		return true;
+	}
+
+	float SwingPredictor::GetAngle(const FSwing& Swing, float Time) const
+	{
+		int32_t Quarter;
+		float Fraction;
+		GetQuarterPhase(Swing, Time, Quarter, Fraction);
+
+		const float Phi = LookupAmplitudeFraction(Swing.Amplitude, Fraction) * (0.5f * Pi);
+		const float Angle = 2.f * std::asin(std::sin(0.5f * Swing.Amplitude) * std::sin(Phi));
+		return Quarter < 2 ? Angle : -Angle;
+	}
+
+	float SwingPredictor::GetAngularVelocity(const FSwing& Swing, float Time) const
+	{
+		int32_t Quarter;
+		float Fraction;
+		GetQuarterPhase(Swing, Time, Quarter, Fraction);
+
+		// d/dt of 2 asin(k sn) is 2 k Frequency cn, and cn is cos(am)
+		const float Phi = LookupAmplitudeFraction(Swing.Amplitude, Fraction) * (0.5f * Pi);
+		const float Speed = 2.f * std::sin(0.5f * Swing.Amplitude) * Swing.Frequency * std::cos(Phi);
+		return Quarter == 0 || Quarter == 3 ? Speed : -Speed;
+	}
+
+	float SwingPredictor::GetTimeToApex(const FSwing& Swing, float Time, float& OutApexAngle) const
+	{
+		if (Swing.QuarterPeriod <= 0.f)
+		{
+			OutApexAngle = 0.f;
+			return 0.f;
+		}
+
+		float Phase = std::fmod(Swing.StartPhase + Time / Swing.QuarterPeriod, 4.f);
+		if (Phase < 0.f)
+		{
+			Phase += 4.f;
+		}
+
+		// Apexes are at phases 1 and 3
+		const float ApexPhase = Phase < 1.f ? 1.f : (Phase < 3.f ? 3.f : 5.f);
+		OutApexAngle = ApexPhase == 3.f ? -Swing.Amplitude : Swing.Amplitude;
+		return (ApexPhase - Phase) * Swing.QuarterPeriod;
+	}
+
+	Vec3 SwingPredictor::GetPosition(const Vec3& Origin, float Length, float X, float Y, float Angle)
+	{
+		const float PlaneLength = std::sqrt(Square(X) + Square(Y));
+		const float Horizontal = Length * std::sin(Angle) / PlaneLength;
+		return Vec3(X * Horizontal, Y * Horizontal, -Length * std::cos(Angle)) + Origin;
+	}
+
+	void SwingPredictor::GetQuarterPhase(const FSwing& Swing, float Time, int32_t& OutQuarter, float& OutFraction) const
+	{
+		float Phase = Swing.QuarterPeriod > 0.f ? std::fmod(Swing.StartPhase + Time / Swing.QuarterPeriod, 4.f) : Swing.StartPhase;
+		if (Phase < 0.f)
+		{
+			Phase += 4.f;
+		}
+
+		OutQuarter = std::min(static_cast<int32_t>(Phase), 3);
+		const float QuarterFraction = Phase - OutQuarter;
+		// Odd quarters run from the apex back to the bottom
+		OutFraction = (OutQuarter & 1) != 0 ? 1.f - QuarterFraction : QuarterFraction;
+	}
+
+	float SwingPredictor::LookupAmplitudeFraction(float Amplitude, float Fraction) const
+	{
+		return Lookup(AmplitudeFractions, Amplitude, Fraction);
+	}
+
+	float SwingPredictor::LookupPhaseFraction(float Amplitude, float AmplitudeFraction) const
+	{
+		return Lookup(PhaseFractions, Amplitude, AmplitudeFraction);
+	}
+
+	float SwingPredictor::Lookup(const std::vector<float>& Table, float Amplitude, float Fraction) const
+	{
+		const float AmplitudeSample = Clamp(Amplitude * AmplitudeToSample, 0.f, static_cast<float>(AmplitudeSamples - 1));
+		const float PhaseSample = Clamp(Fraction, 0.f, 1.f) * (PhaseSamples - 1);
+		const int32_t Row = std::min(static_cast<int32_t>(AmplitudeSample), AmplitudeSamples - 2);
+		const int32_t Column = std::min(static_cast<int32_t>(PhaseSample), PhaseSamples - 2);
+		const float RowAlpha = AmplitudeSample - Row;
+		const float ColumnAlpha = PhaseSample - Column;
+
+		const float* const Low = &Table[Row * PhaseSamples + Column];
+		const float* const High = Low + PhaseSamples;
+		const float LowValue = Low[0] + (Low[1] - Low[0]) * ColumnAlpha;
+		const float HighValue = High[0] + (High[1] - High[0]) * ColumnAlpha;
+		return LowValue + (HighValue - LowValue) * RowAlpha;
+	}
+}
@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SwingQuantizer.h"
+
+namespace GrappleCore
+{
+	namespace
+	{
+		const float SignedScale = 32767.f;
+		const float UnsignedScale = 65535.f;
+
+		int16_t QuantizeSigned(float Value)
+		{
+			return static_cast<int16_t>(std::lround(Clamp(Value, -1.f, 1.f) * SignedScale));
+		}
+
+		float DequantizeSigned(int16_t Value)
+		{
+			return Clamp(Value / SignedScale, -1.f, 1.f);
+		}
+
+		float SignNotZero(float Value)
+		{
+			return Value < 0.f ? -1.f : 1.f;
+		}
+	}
+
+	SwingQuantizer::SwingQuantizer(float InMaxLength, float InMaxAngularVelocity)
+		: MaxLength(std::max(InMaxLength, SmallNumber))
+		, MaxAngularVelocity(std::max(InMaxAngularVelocity, SmallNumber))
+	{
+	}
+
+	SwingQuantizer::FQuantizedSwing SwingQuantizer::Quantize(const Vec3& Offset, const Vec3& Velocity) const
+	{
+		FQuantizedSwing Swing;
+
+		const float Length = Offset.Size();
+		Swing.Length = static_cast<uint16_t>(std::lround(Clamp(Length / MaxLength, 0.f, 1.f) * UnsignedScale));
+		if (Length < SmallNumber)
+			return Swing;
+
+		EncodeDirection(Offset / Length, Swing.DirectionX, Swing.DirectionY);
+
+		// The tangents come from the direction the other end will decode, not from the exact one
+		Vec3 TangentX, TangentY;
+		GetTangents(DecodeDirection(Swing.DirectionX, Swing.DirectionY), TangentX, TangentY);
+		const Vec3 AngularVelocity = Cross(Offset, Velocity) / (Length * Length);
+		Swing.AngularVelocityX = QuantizeSigned(Dot(AngularVelocity, TangentX) / MaxAngularVelocity);
+		Swing.AngularVelocityY = QuantizeSigned(Dot(AngularVelocity, TangentY) / MaxAngularVelocity);
+		return Swing;
+	}
+
+	void SwingQuantizer::Dequantize(const FQuantizedSwing& Swing, Vec3& OutOffset, Vec3& OutVelocity) const
+	{
+		const Vec3 Direction = DecodeDirection(Swing.DirectionX, Swing.DirectionY);
+		const float Length = Swing.Length / UnsignedScale * MaxLength;
+
+		Vec3 TangentX, TangentY;
+		GetTangents(Direction, TangentX, TangentY);
+		const Vec3 AngularVelocity = TangentX * (DequantizeSigned(Swing.AngularVelocityX) * MaxAngularVelocity)
+			+ TangentY * (DequantizeSigned(Swing.AngularVelocityY) * MaxAngularVelocity);
+
+		OutOffset = Direction * Length;
+		OutVelocity = Cross(AngularVelocity, OutOffset);
+	}
+
+	void SwingQuantizer::EncodeDirection(const Vec3& Direction, int16_t& OutX, int16_t& OutY)
+	{
+		// Project on the octahedron, then fold the upper half over the lower one's corners
+		const float Norm = std::abs(Direction.X) + std::abs(Direction.Y) + std::abs(Direction.Z);
+		float X = Direction.X / Norm;
+		float Y = Direction.Y / Norm;
+		if (Direction.Z > 0.f)
+		{
+			const float FoldedX = (1.f - std::abs(Y)) * SignNotZero(X);
+			Y = (1.f - std::abs(X)) * SignNotZero(Y);
+			X = FoldedX;
+		}
+		OutX = QuantizeSigned(X);
+		OutY = QuantizeSigned(Y);
+	}
+
+	Vec3 SwingQuantizer::DecodeDirection(int16_t QuantizedX, int16_t QuantizedY)
+	{
+		float X = DequantizeSigned(QuantizedX);
+		float Y = DequantizeSigned(QuantizedY);
+		const float Z = std::abs(X) + std::abs(Y) - 1.f;
+		if (Z > 0.f)
+		{
+			const float UnfoldedX = (1.f - std::abs(Y)) * SignNotZero(X);
+			Y = (1.f - std::abs(X)) * SignNotZero(Y);
+			X = UnfoldedX;
+		}
+
+		// Hanging down is the lower half, the unfolded corners are the upper one
+		const Vec3 Direction = Vec3(X, Y, Z).GetSafeNormal();
+		return Direction.SizeSquared() > 0.f ? Direction : Vec3(0.f, 0.f, -1.f);
+	}
+
+	void SwingQuantizer::GetTangents(const Vec3& Direction, Vec3& OutTangentX, Vec3& OutTangentY)
+	{
+		// Frisvad's basis around the lower pole, where ropes hang
+		const float Denominator = 1.f - Direction.Z;
+		if (Denominator < SmallNumber)
+		{
+			OutTangentX = Vec3(1.f, 0.f, 0.f);
+			OutTangentY = Vec3(0.f, -1.f, 0.f);
+			return;
+		}
+
+		const float A = 1.f / Denominator;
+		const float B = Direction.X * Direction.Y * A;
+		OutTangentX = Vec3(1.f - Direction.X * Direction.X * A, -B, Direction.X);
+		OutTangentY = Vec3(B, Direction.Y * Direction.Y * A - 1.f, -Direction.Y);
+	}
+}
@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GrappleCoreMath.h"
+#include <unordered_map>
+#include <vector>
+
+namespace GrappleCore
+{
+	/**
+	 * Hookable anchor points in a sparse uniform grid, for "what can I grapple from here" queries without scene traces.
+	 * Anchors have stable handles and can move, only the cells they leave and enter are touched.
+	 *
+	 * Every anchor is a sphere of AnchorRadius, the aim tolerance of raycasts, filed in each cell the sphere overlaps.
+	 * Radius and cone queries test the anchor points, only in the cell that contains them so each is reported once.
+	 * Raycasts walk the cells along the ray and stop in the first cell holding a hit.
+	 * Queries covering more cells than there are anchors test every anchor instead of walking empty cells.
+	 */
+	class GRAPPLECORE_API AnchorGrid
+	{
+	public:
+		typedef int32_t FHandle;
+		static const FHandle InvalidHandle = -1;
+
+		/** AnchorRadius is clamped to half a cell, so an anchor overlaps eight cells at most */
+		explicit AnchorGrid(float CellSize = 500.f, float AnchorRadius = 50.f);
+
+		/** Refiles every anchor, meant for setup rather than per frame */
+		void SetCellSize(float NewCellSize, float NewAnchorRadius);
+		float GetCellSize() const { return CellSize; }
+		float GetAnchorRadius() const { return AnchorRadius; }
+
+		FHandle Add(const Vec3& Position);
+		void Remove(FHandle Handle);
+		bool IsValid(FHandle Handle) const;
+		/** Only the cells the anchor leaves or enters are updated, small moves inside its cells cost a few compares */
+		void Move(FHandle Handle, const Vec3& Position);
+		void Reset();
+
+		Vec3 GetPosition(FHandle Handle) const { return Anchors[Handle].Position; }
+		int32_t Num() const { return static_cast<int32_t>(Anchors.size() - FreeHandles.size()); }
+
+		/** Appends the anchors within Radius of Center to OutHandles, in no particular order, returns how many */
+		int32_t QueryRadius(const Vec3& Center, float Radius, std::vector<FHandle>& OutHandles) const;
+
+		/**
+		 * Appends the anchors within MaxDistance of Origin and HalfAngle radians of Direction to OutHandles, in no
+		 * particular order, returns how many. Direction does not have to be normalized.
+		 */
+		int32_t QueryCone(const Vec3& Origin, const Vec3& Direction, float HalfAngle, float MaxDistance, std::vector<FHandle>& OutHandles) const;
+
+		/**
+		 * First anchor sphere along the ray within MaxDistance, false if none. OutDistance is where the ray enters it,
+		 * zero when Origin is inside. Direction does not have to be normalized.
+		 */
+		bool Raycast(const Vec3& Origin, const Vec3& Direction, float MaxDistance, FHandle& OutHandle, float& OutDistance) const;
+
+	private:
+		typedef uint64_t FCellKey;
+
+		/** An anchor in one of its cells, the position is copied so queries never leave the cell's array */
+		struct FCellEntry
+		{
+			Vec3 Position;
+			FHandle Handle;
+			/** The cell contains the anchor point, point queries only report the anchor there */
+			bool bHome;
+		};
+
+		struct FAnchor
+		{
+			Vec3 Position;
+			FCellKey Cells[8];
+			int32_t CellCount = 0;
+			bool bValid = false;
+		};
+
+		void GetCellCoords(const Vec3& Position, int32_t& OutX, int32_t& OutY, int32_t& OutZ) const;
+		static FCellKey MakeKey(int32_t X, int32_t Y, int32_t Z);
+		/** Cells the anchor sphere at Position overlaps, the home cell first */
+		int32_t GetAnchorCells(const Vec3& Position, FCellKey* OutCells) const;
+		void Insert(FHandle Handle);
+		void Erase(FHandle Handle);
+
+		/** Calls Function on every anchor point in the cells of the box, or on every anchor when that is cheaper */
+		template <typename FunctionType>
+		void ForEachPointInBox(const Vec3& Min, const Vec3& Max, FunctionType Function) const;
+
+		std::unordered_map<FCellKey, std::vector<FCellEntry>> Cells;
+		std::vector<FAnchor> Anchors;
+		std::vector<FHandle> FreeHandles;
+
+		float CellSize;
+		float InvCellSize;
+		float AnchorRadius;
+	};
+}
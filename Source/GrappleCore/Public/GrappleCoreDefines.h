@@ -0,0 +1,18 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstdint>
+
+// Unreal Build Tool defines the export macro of the GrappleCore module, standalone builds link statically
+#ifndef GRAPPLECORE_API
+#define GRAPPLECORE_API
+#endif
+
+#if defined(_MSC_VER)
+#define GRAPPLECORE_FORCEINLINE __forceinline
+#define GRAPPLECORE_RESTRICT __restrict
+#else
+#define GRAPPLECORE_FORCEINLINE inline __attribute__((always_inline))
+#define GRAPPLECORE_RESTRICT __restrict__
+#endif
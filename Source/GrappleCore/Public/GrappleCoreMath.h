@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GrappleCoreDefines.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+/**
+ * Math types of the grapple core, which does not depend on the engine.
+ * Vec3 has the layout of FVector, the game module converts between them with GrappleCoreConversions.h.
+ */
+namespace GrappleCore
+{
+	const float Pi = 3.14159265358979323846f;
+	/** Same tolerance as the engine's KINDA_SMALL_NUMBER */
+	const float SmallNumber = 1.e-4f;
+	const float MaxFloat = FLT_MAX;
+
+	template <typename T>
+	GRAPPLECORE_FORCEINLINE T Clamp(T Value, T Min, T Max) { return Value < Min ? Min : (Value > Max ? Max : Value); }
+
+	template <typename T>
+	GRAPPLECORE_FORCEINLINE T Square(T Value) { return Value * Value; }
+
+	struct Vec3
+	{
+		float X, Y, Z;
+
+		Vec3() : X(0.f), Y(0.f), Z(0.f) {}
+		Vec3(float InX, float InY, float InZ) : X(InX), Y(InY), Z(InZ) {}
+
+		Vec3 operator+(const Vec3& Other) const { return Vec3(X + Other.X, Y + Other.Y, Z + Other.Z); }
+		Vec3 operator-(const Vec3& Other) const { return Vec3(X - Other.X, Y - Other.Y, Z - Other.Z); }
+		Vec3 operator-() const { return Vec3(-X, -Y, -Z); }
+		Vec3 operator*(float Scale) const { return Vec3(X * Scale, Y * Scale, Z * Scale); }
+		Vec3 operator/(float Scale) const { const float InvScale = 1.f / Scale; return Vec3(X * InvScale, Y * InvScale, Z * InvScale); }
+
+		Vec3& operator+=(const Vec3& Other) { X += Other.X; Y += Other.Y; Z += Other.Z; return *this; }
+		Vec3& operator-=(const Vec3& Other) { X -= Other.X; Y -= Other.Y; Z -= Other.Z; return *this; }
+		Vec3& operator*=(float Scale) { X *= Scale; Y *= Scale; Z *= Scale; return *this; }
+
+		bool operator==(const Vec3& Other) const { return X == Other.X && Y == Other.Y && Z == Other.Z; }
+		bool operator!=(const Vec3& Other) const { return !(*this == Other); }
+
+		float SizeSquared() const { return X * X + Y * Y + Z * Z; }
+		float Size() const { return std::sqrt(SizeSquared()); }
+
+		/** Unit vector in the same direction, zero if the vector is too short to have one */
+		Vec3 GetSafeNormal() const
+		{
+			const float LengthSquared = SizeSquared();
+			return LengthSquared > SmallNumber * SmallNumber ? *this * (1.f / std::sqrt(LengthSquared)) : Vec3();
+		}
+	};
+
+	GRAPPLECORE_FORCEINLINE Vec3 operator*(float Scale, const Vec3& Vector) { return Vector * Scale; }
+
+	GRAPPLECORE_FORCEINLINE float Dot(const Vec3& A, const Vec3& B) { return A.X * B.X + A.Y * B.Y + A.Z * B.Z; }
+	GRAPPLECORE_FORCEINLINE Vec3 Cross(const Vec3& A, const Vec3& B) { return Vec3(A.Y * B.Z - A.Z * B.Y, A.Z * B.X - A.X * B.Z, A.X * B.Y - A.Y * B.X); }
+	GRAPPLECORE_FORCEINLINE float DistSquared(const Vec3& A, const Vec3& B) { return (B - A).SizeSquared(); }
+	GRAPPLECORE_FORCEINLINE float Dist(const Vec3& A, const Vec3& B) { return (B - A).Size(); }
+	GRAPPLECORE_FORCEINLINE Vec3 Lerp(const Vec3& A, const Vec3& B, float Alpha) { return A + (B - A) * Alpha; }
+}
@@ -0,0 +1,179 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GrappleCoreMath.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GRAPPLECORE_SIMD_SSE 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define GRAPPLECORE_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+/**
+ * Four-wide float vectors for the structure-of-arrays solvers, SSE2 and NEON with a scalar fallback.
+ * Loads and stores are unaligned, streams only need to be padded to a multiple of four floats.
+ */
+namespace GrappleCore
+{
+#if defined(GRAPPLECORE_SIMD_SSE)
+
+	typedef __m128 Float4;
+
+	GRAPPLECORE_FORCEINLINE Float4 Load4(const float* Data) { return _mm_loadu_ps(Data); }
+	GRAPPLECORE_FORCEINLINE void Store4(const Float4& Value, float* Data) { _mm_storeu_ps(Data, Value); }
+	GRAPPLECORE_FORCEINLINE Float4 Set4(float Value) { return _mm_set1_ps(Value); }
+	GRAPPLECORE_FORCEINLINE Float4 Add4(const Float4& A, const Float4& B) { return _mm_add_ps(A, B); }
+	GRAPPLECORE_FORCEINLINE Float4 Subtract4(const Float4& A, const Float4& B) { return _mm_sub_ps(A, B); }
+	GRAPPLECORE_FORCEINLINE Float4 Multiply4(const Float4& A, const Float4& B) { return _mm_mul_ps(A, B); }
+	/** A * B + C */
+	GRAPPLECORE_FORCEINLINE Float4 MultiplyAdd4(const Float4& A, const Float4& B, const Float4& C) { return _mm_add_ps(_mm_mul_ps(A, B), C); }
+	GRAPPLECORE_FORCEINLINE Float4 Divide4(const Float4& A, const Float4& B) { return _mm_div_ps(A, B); }
+	GRAPPLECORE_FORCEINLINE Float4 Sqrt4(const Float4& A) { return _mm_sqrt_ps(A); }
+	GRAPPLECORE_FORCEINLINE Float4 Min4(const Float4& A, const Float4& B) { return _mm_min_ps(A, B); }
+	GRAPPLECORE_FORCEINLINE Float4 Max4(const Float4& A, const Float4& B) { return _mm_max_ps(A, B); }
+	GRAPPLECORE_FORCEINLINE Float4 Abs4(const Float4& A) { return _mm_andnot_ps(_mm_set1_ps(-0.f), A); }
+	/** Magnitude of A with the sign of B */
+	GRAPPLECORE_FORCEINLINE Float4 CopySign4(const Float4& A, const Float4& B) { const __m128 SignMask = _mm_set1_ps(-0.f); return _mm_or_ps(_mm_andnot_ps(SignMask, A), _mm_and_ps(SignMask, B)); }
+	/** Lanes of A where A <= B are all ones */
+	GRAPPLECORE_FORCEINLINE Float4 CompareLessEqual4(const Float4& A, const Float4& B) { return _mm_cmple_ps(A, B); }
+	/** Mask ? A : B, per lane */
+	GRAPPLECORE_FORCEINLINE Float4 Select4(const Float4& Mask, const Float4& A, const Float4& B) { return _mm_or_ps(_mm_and_ps(Mask, A), _mm_andnot_ps(Mask, B)); }
+	/** Rounds to the nearest integer, for values that fit in an int32 */
+	GRAPPLECORE_FORCEINLINE Float4 Round4(const Float4& A) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(A)); }
+
+#elif defined(GRAPPLECORE_SIMD_NEON)
+
+	typedef float32x4_t Float4;
+
+	GRAPPLECORE_FORCEINLINE Float4 Load4(const float* Data) { return vld1q_f32(Data); }
+	GRAPPLECORE_FORCEINLINE void Store4(const Float4& Value, float* Data) { vst1q_f32(Data, Value); }
+	GRAPPLECORE_FORCEINLINE Float4 Set4(float Value) { return vdupq_n_f32(Value); }
+	GRAPPLECORE_FORCEINLINE Float4 Add4(const Float4& A, const Float4& B) { return vaddq_f32(A, B); }
+	GRAPPLECORE_FORCEINLINE Float4 Subtract4(const Float4& A, const Float4& B) { return vsubq_f32(A, B); }
+	GRAPPLECORE_FORCEINLINE Float4 Multiply4(const Float4& A, const Float4& B) { return vmulq_f32(A, B); }
+	GRAPPLECORE_FORCEINLINE Float4 MultiplyAdd4(const Float4& A, const Float4& B, const Float4& C) { return vmlaq_f32(C, A, B); }
+#if defined(__aarch64__) || defined(_M_ARM64)
+	GRAPPLECORE_FORCEINLINE Float4 Divide4(const Float4& A, const Float4& B) { return vdivq_f32(A, B); }
+	GRAPPLECORE_FORCEINLINE Float4 Sqrt4(const Float4& A) { return vsqrtq_f32(A); }
+#else
+	// 32-bit NEON has no division or square root, refine the estimates twice to get close to full precision
+	GRAPPLECORE_FORCEINLINE Float4 Divide4(const Float4& A, const Float4& B)
+	{
+		float32x4_t Reciprocal = vrecpeq_f32(B);
+		Reciprocal = vmulq_f32(vrecpsq_f32(B, Reciprocal), Reciprocal);
+		Reciprocal = vmulq_f32(vrecpsq_f32(B, Reciprocal), Reciprocal);
+		return vmulq_f32(A, Reciprocal);
+	}
+	GRAPPLECORE_FORCEINLINE Float4 Sqrt4(const Float4& A)
+	{
+		float32x4_t InvSqrt = vrsqrteq_f32(A);
+		InvSqrt = vmulq_f32(vrsqrtsq_f32(vmulq_f32(A, InvSqrt), InvSqrt), InvSqrt);
+		InvSqrt = vmulq_f32(vrsqrtsq_f32(vmulq_f32(A, InvSqrt), InvSqrt), InvSqrt);
+		// The estimate of zero is infinite, keep zero
+		return vbslq_f32(vceqq_f32(A, vdupq_n_f32(0.f)), A, vmulq_f32(A, InvSqrt));
+	}
+#endif
+	GRAPPLECORE_FORCEINLINE Float4 Min4(const Float4& A, const Float4& B) { return vminq_f32(A, B); }
+	GRAPPLECORE_FORCEINLINE Float4 Max4(const Float4& A, const Float4& B) { return vmaxq_f32(A, B); }
+	GRAPPLECORE_FORCEINLINE Float4 Abs4(const Float4& A) { return vabsq_f32(A); }
+	GRAPPLECORE_FORCEINLINE Float4 CopySign4(const Float4& A, const Float4& B) { return vbslq_f32(vdupq_n_u32(0x80000000u), B, A); }
+	GRAPPLECORE_FORCEINLINE Float4 CompareLessEqual4(const Float4& A, const Float4& B) { return vreinterpretq_f32_u32(vcleq_f32(A, B)); }
+	GRAPPLECORE_FORCEINLINE Float4 Select4(const Float4& Mask, const Float4& A, const Float4& B) { return vbslq_f32(vreinterpretq_u32_f32(Mask), A, B); }
+	GRAPPLECORE_FORCEINLINE Float4 Round4(const Float4& A)
+	{
+		// The conversion truncates, add a half away from zero first
+		return vcvtq_f32_s32(vcvtq_s32_f32(vaddq_f32(A, CopySign4(vdupq_n_f32(0.5f), A))));
+	}
+
+#else
+
+	struct Float4 { float V[4]; };
+
+	template <typename FunctionType>
+	GRAPPLECORE_FORCEINLINE Float4 Map4(const Float4& A, const Float4& B, FunctionType Function)
+	{
+		Float4 Result;
+		for (int32_t Lane = 0; Lane < 4; ++Lane)
+		{
+			Result.V[Lane] = Function(A.V[Lane], B.V[Lane]);
+		}
+		return Result;
+	}
+
+	GRAPPLECORE_FORCEINLINE Float4 Load4(const float* Data) { return Float4{ { Data[0], Data[1], Data[2], Data[3] } }; }
+	GRAPPLECORE_FORCEINLINE void Store4(const Float4& Value, float* Data) { for (int32_t Lane = 0; Lane < 4; ++Lane) Data[Lane] = Value.V[Lane]; }
+	GRAPPLECORE_FORCEINLINE Float4 Set4(float Value) { return Float4{ { Value, Value, Value, Value } }; }
+	GRAPPLECORE_FORCEINLINE Float4 Add4(const Float4& A, const Float4& B) { return Map4(A, B, [](float X, float Y) { return X + Y; }); }
+	GRAPPLECORE_FORCEINLINE Float4 Subtract4(const Float4& A, const Float4& B) { return Map4(A, B, [](float X, float Y) { return X - Y; }); }
+	GRAPPLECORE_FORCEINLINE Float4 Multiply4(const Float4& A, const Float4& B) { return Map4(A, B, [](float X, float Y) { return X * Y; }); }
+	GRAPPLECORE_FORCEINLINE Float4 MultiplyAdd4(const Float4& A, const Float4& B, const Float4& C) { return Add4(Multiply4(A, B), C); }
+	GRAPPLECORE_FORCEINLINE Float4 Divide4(const Float4& A, const Float4& B) { return Map4(A, B, [](float X, float Y) { return X / Y; }); }
+	GRAPPLECORE_FORCEINLINE Float4 Sqrt4(const Float4& A) { return Map4(A, A, [](float X, float) { return std::sqrt(X); }); }
+	GRAPPLECORE_FORCEINLINE Float4 Min4(const Float4& A, const Float4& B) { return Map4(A, B, [](float X, float Y) { return X < Y ? X : Y; }); }
+	GRAPPLECORE_FORCEINLINE Float4 Max4(const Float4& A, const Float4& B) { return Map4(A, B, [](float X, float Y) { return X > Y ? X : Y; }); }
+	GRAPPLECORE_FORCEINLINE Float4 Abs4(const Float4& A) { return Map4(A, A, [](float X, float) { return X < 0.f ? -X : X; }); }
+	GRAPPLECORE_FORCEINLINE Float4 CopySign4(const Float4& A, const Float4& B) { return Map4(A, B, [](float X, float Y) { return std::copysign(X, Y); }); }
+	GRAPPLECORE_FORCEINLINE Float4 CompareLessEqual4(const Float4& A, const Float4& B) { return Map4(A, B, [](float X, float Y) { return X <= Y ? 1.f : 0.f; }); }
+	GRAPPLECORE_FORCEINLINE Float4 Select4(const Float4& Mask, const Float4& A, const Float4& B)
+	{
+		Float4 Result;
+		for (int32_t Lane = 0; Lane < 4; ++Lane)
+		{
+			Result.V[Lane] = Mask.V[Lane] != 0.f ? A.V[Lane] : B.V[Lane];
+		}
+		return Result;
+	}
+	GRAPPLECORE_FORCEINLINE Float4 Round4(const Float4& A) { return Map4(A, A, [](float X, float) { return static_cast<float>(static_cast<int32_t>(X < 0.f ? X - 0.5f : X + 0.5f)); }); }
+
+#endif
+
+	/**
+	 * Sine and cosine of four angles at once.
+	 * The angles are wrapped to [-pi, pi] and folded to [-pi/2, pi/2], then evaluated with an 11th degree minimax
+	 * polynomial for the sine and a 10th degree one for the cosine, the same approximation the engine uses.
+	 */
+	GRAPPLECORE_FORCEINLINE void SinCos4(Float4& OutSin, Float4& OutCos, const Float4& Angles)
+	{
+		const Float4 TwoPi = Set4(2.f * Pi);
+		const Float4 InvTwoPi = Set4(0.5f / Pi);
+		const Float4 HalfPi = Set4(0.5f * Pi);
+		const Float4 One = Set4(1.f);
+
+		// Wrap to [-pi, pi]
+		Float4 X = Subtract4(Angles, Multiply4(Round4(Multiply4(Angles, InvTwoPi)), TwoPi));
+
+		// sin(x) = sin(pi - x) = sin(-pi - x) folds to [-pi/2, pi/2], the cosine changes sign
+		const Float4 InRange = CompareLessEqual4(Abs4(X), HalfPi);
+		const Float4 Reflected = Subtract4(CopySign4(Set4(Pi), X), X);
+		X = Select4(InRange, X, Reflected);
+		const Float4 CosSign = Select4(InRange, One, Set4(-1.f));
+
+		const Float4 X2 = Multiply4(X, X);
+
+		Float4 Sin = Set4(-2.3889859e-08f);
+		Sin = MultiplyAdd4(Sin, X2, Set4(2.7525562e-06f));
+		Sin = MultiplyAdd4(Sin, X2, Set4(-0.00019840874f));
+		Sin = MultiplyAdd4(Sin, X2, Set4(0.0083333310f));
+		Sin = MultiplyAdd4(Sin, X2, Set4(-0.16666667f));
+		Sin = MultiplyAdd4(Sin, X2, One);
+		OutSin = Multiply4(Sin, X);
+
+		Float4 Cos = Set4(-2.6051615e-07f);
+		Cos = MultiplyAdd4(Cos, X2, Set4(2.4760495e-05f));
+		Cos = MultiplyAdd4(Cos, X2, Set4(-0.0013888378f));
+		Cos = MultiplyAdd4(Cos, X2, Set4(0.041666638f));
+		Cos = MultiplyAdd4(Cos, X2, Set4(-0.5f));
+		Cos = MultiplyAdd4(Cos, X2, One);
+		OutCos = Multiply4(Cos, CosSign);
+	}
+
+	GRAPPLECORE_FORCEINLINE Float4 Sin4(const Float4& Angles)
+	{
+		Float4 Sin, Cos;
+		SinCos4(Sin, Cos, Angles);
+		return Sin;
+	}
+}
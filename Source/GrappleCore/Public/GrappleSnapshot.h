@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "SnapshotRing.h"
+#include "SphericalPendulumBatch.h"
+
+namespace GrappleCore
+{
+	/** Most hooks a character can own, every one of them is replicated and saved in snapshots */
+	const int32_t MaxHooksPerCharacter = 8;
+
+	/** One hook at the end of a frame */
+	struct FHookSnapshot
+	{
+		Vec3 Location;
+		Vec3 FlightVelocity;
+		float RopeRestLength;
+		/** ProjectileState of the game module */
+		uint8_t State;
+	};
+
+	/**
+	 * Everything that drives a character's grapple at the end of a frame, as plain data: its hooks, its swing with
+	 * the pendulum's whole state, and the inputs and delta time of the frame so it can be simulated again.
+	 * Ropes are left out, they are cosmetic and settle again within a few frames.
+	 */
+	struct FCharacterSnapshot
+	{
+		static const int32_t MaxHooks = MaxHooksPerCharacter;
+
+		Vec3 Location;
+		Vec3 Velocity;
+		/** Length of the frame that ended with this snapshot */
+		float DeltaTime;
+		/** Steering input of the frame */
+		float SwingForward;
+		float SwingRight;
+		/** Time the swinger's tier, or the first tier without a swing, had accumulated towards its next fixed step. 0 when the movement steps the swing. */
+		float PendulumTime;
+		/** Fixed step of the swinger, its tier's or the full detail one */
+		float PendulumStep;
+		/** Hook the character swings from, -1 when it does not swing and Swing is not valid */
+		int8_t SwingHook;
+		uint8_t HookCount;
+		SphericalPendulumBatch::FSwingerState Swing;
+		FHookSnapshot Hooks[MaxHooks];
+	};
+
+	static_assert(std::is_trivially_copyable<FCharacterSnapshot>::value, "Snapshots are saved and restored as plain copies");
+}
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GrappleCoreMath.h"
+
+namespace GrappleCore
+{
+	/**
+	 * Flight and retraction math of a grappling hook.
+	 * Step follows the projectile movement component: constant acceleration over the step, speed clamped after it.
+	 */
+	namespace HookBallistics
+	{
+		/** Position after Time seconds of free flight, without speed clamping */
+		GRAPPLECORE_FORCEINLINE Vec3 PredictPosition(const Vec3& Position, const Vec3& Velocity, const Vec3& Gravity, float Time)
+		{
+			return Position + Velocity * Time + Gravity * (0.5f * Time * Time);
+		}
+
+		/** Advances a flying hook by DeltaTime. A MaxSpeed of zero leaves the speed unclamped. */
+		GRAPPLECORE_FORCEINLINE void Step(Vec3& Position, Vec3& Velocity, const Vec3& Gravity, float DeltaTime, float MaxSpeed)
+		{
+			Position = PredictPosition(Position, Velocity, Gravity, DeltaTime);
+			Velocity += Gravity * DeltaTime;
+
+			if (MaxSpeed > 0.f && Velocity.SizeSquared() > Square(MaxSpeed))
+			{
+				Velocity = Velocity.GetSafeNormal() * MaxSpeed;
+			}
+		}
+
+		/**
+		 * Fills OutPositions with SampleCount points of the flight, the first at the launch position and the last after
+		 * Duration seconds, for swept collision or a trajectory preview.
+		 */
+		GRAPPLECORE_API void SamplePath(const Vec3& Position, const Vec3& Velocity, const Vec3& Gravity, float Duration, int32_t SampleCount, Vec3* OutPositions);
+
+		/** Moves a retracting hook towards its dock at Speed, without overshooting it */
+		GRAPPLECORE_FORCEINLINE Vec3 Retract(const Vec3& HookPosition, const Vec3& DockPosition, float Speed, float DeltaTime)
+		{
+			const Vec3 ToDock = DockPosition - HookPosition;
+			const float Distance = ToDock.Size();
+			const float Step = Speed * DeltaTime;
+			return Step >= Distance ? DockPosition : HookPosition + ToDock * (Step / Distance);
+		}
+	}
+}
@@ -0,0 +1,141 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GrappleCoreDefines.h"
+#include <vector>
+
+namespace GrappleCore
+{
+	/** Swingers a batch steps per iteration. Streams are padded to a multiple of this so there is no scalar remainder loop. */
+	const int32_t BatchLanes = 4;
+
+	/**
+	 * Lane bookkeeping of the structure-of-arrays batches: stable handles over lanes densely packed at the front of
+	 * every stream, the streams padded with zeroed lanes to whole groups of BatchLanes.
+	 *
+	 * The owner lists its float streams once as pointers to members, and hands itself to every call that adds, moves
+	 * or drops lanes so all of them follow. Lane data kept outside the float streams is the owner's to move along.
+	 */
+	template <typename OwnerType>
+	class LaneStorage
+	{
+	public:
+		typedef int32_t FHandle;
+		typedef std::vector<float> OwnerType::* FStream;
+		static constexpr FHandle InvalidHandle = -1;
+
+		LaneStorage(const FStream* InStreams, int32_t InStreamCount)
+			: Streams(InStreams)
+			, StreamCount(InStreamCount)
+		{
+		}
+
+		/** Appends a lane for a new swinger and returns its handle, the owner fills the lane */
+		FHandle Allocate(OwnerType& Owner)
+		{
+			FHandle Handle;
+			if (!FreeHandles.empty())
+			{
+				Handle = FreeHandles.back();
+				FreeHandles.pop_back();
+			}
+			else
+			{
+				Handle = static_cast<FHandle>(HandleToDense.size());
+				HandleToDense.push_back(InvalidHandle);
+			}
+
+			const int32_t Dense = Num();
+			DenseToHandle.push_back(Handle);
+			HandleToDense[Handle] = Dense;
+
+			// Grow every stream by a whole lane group, padding lanes stay zeroed and never move
+			if (Dense >= PaddedCount)
+			{
+				PaddedCount += BatchLanes;
+				ResizeStreams(Owner);
+			}
+			return Handle;
+		}
+
+		/**
+		 * Frees the lane of Handle and returns it. The last swinger moves into the hole so the streams stay packed,
+		 * owner data outside the streams has to move from lane Num() to the returned one.
+		 */
+		int32_t Remove(OwnerType& Owner, FHandle Handle)
+		{
+			const int32_t Dense = HandleToDense[Handle];
+			const int32_t Last = Num() - 1;
+
+			// Move the last swinger into the hole and clear the lane it left
+			for (int32_t StreamIndex = 0; StreamIndex < StreamCount; ++StreamIndex)
+			{
+				std::vector<float>& Stream = Owner.*Streams[StreamIndex];
+				Stream[Dense] = Stream[Last];
+				Stream[Last] = 0.f;
+			}
+			DenseToHandle[Dense] = DenseToHandle[Last];
+			DenseToHandle.pop_back();
+
+			if (Dense != Last)
+			{
+				HandleToDense[DenseToHandle[Dense]] = Dense;
+			}
+
+			HandleToDense[Handle] = InvalidHandle;
+			FreeHandles.push_back(Handle);
+
+			// Drop a lane group once it only holds padding
+			const int32_t NewPaddedCount = (Num() + BatchLanes - 1) / BatchLanes * BatchLanes;
+			if (NewPaddedCount < PaddedCount)
+			{
+				PaddedCount = NewPaddedCount;
+				ResizeStreams(Owner);
+			}
+			return Dense;
+		}
+
+		/** Copies lane SourceDense of every stream of Source to lane TargetDense of Target, another owner of the same type */
+		void CopyLane(const OwnerType& Source, int32_t SourceDense, OwnerType& Target, int32_t TargetDense) const
+		{
+			for (int32_t StreamIndex = 0; StreamIndex < StreamCount; ++StreamIndex)
+			{
+				(Target.*Streams[StreamIndex])[TargetDense] = (Source.*Streams[StreamIndex])[SourceDense];
+			}
+		}
+
+		bool IsValid(FHandle Handle) const
+		{
+			return Handle >= 0 && Handle < static_cast<FHandle>(HandleToDense.size()) && HandleToDense[Handle] != InvalidHandle;
+		}
+
+		/** Lane of a valid handle */
+		int32_t GetDense(FHandle Handle) const { return HandleToDense[Handle]; }
+		int32_t Num() const { return static_cast<int32_t>(DenseToHandle.size()); }
+		/** Lanes of every stream, padding included */
+		int32_t GetPaddedCount() const { return PaddedCount; }
+		int32_t GetLaneGroupCount() const { return PaddedCount / BatchLanes; }
+
+	private:
+		void ResizeStreams(OwnerType& Owner) const
+		{
+			for (int32_t StreamIndex = 0; StreamIndex < StreamCount; ++StreamIndex)
+			{
+				(Owner.*Streams[StreamIndex]).resize(PaddedCount, 0.f);
+			}
+		}
+
+		const FStream* Streams;
+		int32_t StreamCount;
+		int32_t PaddedCount = 0;
+
+		// Handle <-> dense index indirection
+		std::vector<FHandle> DenseToHandle;
+		std::vector<int32_t> HandleToDense;
+		std::vector<FHandle> FreeHandles;
+	};
+
+	template <typename OwnerType>
+	constexpr typename LaneStorage<OwnerType>::FHandle LaneStorage<OwnerType>::InvalidHandle;
+}
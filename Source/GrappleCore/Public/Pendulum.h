@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GrappleCoreMath.h"
+
+namespace GrappleCore
+{
+	/**
+	 * Single planar pendulum, stepped with semi-implicit Euler.
+	 * Reference implementation for PendulumBatch, which steps many of them at once.
+	 */
+	class GRAPPLECORE_API Pendulum
+	{
+		Vec3 position;       // position of pendulum ball
+		Vec3 origin;         // position of arm origin
+		float r;             // Length of arm
+		float angle;         // Pendulum arm angle
+		float aVelocity;     // Angle velocity
+		float aAcceleration; // Angle acceleration
+
+		float damping;       // Fraction of angular velocity kept after one second
+
+		float gravity;
+
+		float x, y;
+
+	public:
+		// This constructor could be improved to allow a greater variety of pendulums
+		Pendulum();
+		Pendulum(const Vec3& origin_, float velocity_, float angle_, float r_, float gravity_, float x_, float y_);
+
+		void update(float deltaTime);
+
+		const Vec3& GetPosition() const { return position; }
+		float GetAngle() const { return angle; }
+	};
+}
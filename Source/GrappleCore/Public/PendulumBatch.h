@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GrappleCoreMath.h"
+#include "LaneStorage.h"
+#include <vector>
+
+namespace GrappleCore
+{
+	enum class PendulumIntegrator : uint8_t { SEMI_IMPLICIT_EULER, VERLET, RK4 };
+
+	/**
+	 * Structure-of-arrays version of Pendulum that steps every registered swinger in one pass.
+	 * Swingers are addressed through stable handles; the simulation arrays stay densely packed.
+	 *
+	 * The simulation advances in fixed steps of FixedTimeStep seconds, so trajectories do not depend on the frame rate.
+	 * Positions are interpolated between the last two fixed steps.
+	 */
+	class GRAPPLECORE_API PendulumBatch
+	{
+	public:
+		typedef int32_t FHandle;
+		static const FHandle InvalidHandle = -1;
+
+		PendulumBatch();
+
+		/**
+		 * Registers a swinger.
+		 * @param Velocity	Angular velocity in rad/s
+		 * @param Gravity	Vertical gravity in cm/s^2, negative pulls down
+		 * @param X, Y		Horizontal direction of the swing plane, normalized once here
+		 */
+		FHandle Add(const Vec3& Origin, float Velocity, float StartAngle, float ArmLength, float Gravity, float X, float Y);
+		void Remove(FHandle Handle);
+		bool IsValid(FHandle Handle) const;
+
+		void Update(float DeltaTime);
+
+		Vec3 GetPosition(FHandle Handle) const;
+		/** Angle and angular velocity at the last fixed step, not interpolated */
+		float GetAngle(FHandle Handle) const { return IsValid(Handle) ? Angle[Storage.GetDense(Handle)] : 0.f; }
+		float GetAngularVelocity(FHandle Handle) const { return IsValid(Handle) ? AngularVelocity[Storage.GetDense(Handle)] : 0.f; }
+		int32_t Num() const { return Storage.Num(); }
+
+		/** Time not consumed by a fixed step yet, restored to replay a recording from the same step phase */
+		float GetAccumulatedTime() const { return Accumulator; }
+		void SetAccumulatedTime(float Time) { Accumulator = Clamp(Time, 0.f, FixedTimeStep); }
+
+		void SetIntegrator(PendulumIntegrator NewIntegrator) { Integrator = NewIntegrator; }
+		void SetFixedTimeStep(float NewFixedTimeStep) { FixedTimeStep = std::max(NewFixedTimeStep, SmallNumber); }
+		void SetMaxSubsteps(int32_t NewMaxSubsteps) { MaxSubsteps = std::max(NewMaxSubsteps, 1); }
+		/** Fraction of angular velocity kept after one second, 1 disables damping */
+		void SetDamping(float NewDamping) { Damping = Clamp(NewDamping, 0.f, 1.f); }
+
+	private:
+		/** Every float stream below, one lane per swinger */
+		static const LaneStorage<PendulumBatch>::FStream Streams[];
+
+		void Integrate(float StepTime);
+		void UpdatePositions(float Alpha);
+
+		// Simulation state, one lane per active swinger, padded with zeroed lanes to a multiple of four
+		std::vector<float> Angle;            // Pendulum arm angle
+		std::vector<float> PreviousAngle;    // Angle before the last fixed step, for interpolation
+		std::vector<float> AngularVelocity;  // Angle velocity
+		std::vector<float> GravityOverLength;// gravity / arm length, constant while swinging
+		std::vector<float> Length;           // Length of arm
+		std::vector<float> OriginX, OriginY, OriginZ;
+		std::vector<float> PlaneX, PlaneY;   // Normalized horizontal swing direction
+
+		// Output of the last Update
+		std::vector<float> PositionX, PositionY, PositionZ;
+
+		LaneStorage<PendulumBatch> Storage;
+
+		PendulumIntegrator Integrator;
+		float FixedTimeStep;
+		int32_t MaxSubsteps;
+		float Damping;
+		float Accumulator;
+	};
+}
@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GrappleCoreMath.h"
+#include <vector>
+
+namespace GrappleCore
+{
+	/**
+	 * Verlet rope pinned between two moving end points.
+	 * Particles live in contiguous arrays and the distance constraints are relaxed a fixed number of times per update.
+	 */
+	class GRAPPLECORE_API RopeSimulation
+	{
+	public:
+		RopeSimulation();
+
+		/** Collapses the rope onto a straight line between Start and End */
+		void Reset(const Vec3& Start, const Vec3& End, int32_t SegmentCount);
+
+		/** Changes the level of detail, the current shape is resampled so the rope does not pop */
+		void SetSegmentCount(int32_t SegmentCount);
+
+		void SetRestLength(float NewRestLength) { RestLength = std::max(NewRestLength, 0.f); }
+		float GetRestLength() const { return RestLength; }
+		void SetIterations(int32_t NewIterations) { Iterations = std::max(NewIterations, 1); }
+		/** Fraction of particle velocity kept from one update to the next */
+		void SetDamping(float NewDamping) { Damping = Clamp(NewDamping, 0.f, 1.f); }
+
+		void Update(float DeltaTime, const Vec3& Start, const Vec3& End, const Vec3& Gravity);
+
+		int32_t GetSegmentCount() const { return std::max(static_cast<int32_t>(Positions.size()) - 1, 0); }
+		/** Largest distance a free particle moved during the last update, the rope is at rest when it gets close to zero */
+		float GetLastMaxStep() const { return LastMaxStep; }
+		const std::vector<Vec3>& GetPositions() const { return Positions; }
+
+	private:
+		static void Resample(std::vector<Vec3>& Points, int32_t SegmentCount);
+
+		std::vector<Vec3> Positions;          // Particle positions, first is pinned to Start and last to End
+		std::vector<Vec3> PreviousPositions;  // Positions at the previous update, velocity is implicit
+
+		float RestLength;
+		float LastMaxStep;
+		float Damping;
+		int32_t Iterations;
+	};
+}
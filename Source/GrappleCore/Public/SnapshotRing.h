@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GrappleCoreDefines.h"
+#include <algorithm>
+#include <type_traits>
+
+namespace GrappleCore
+{
+	/**
+	 * The last Capacity frames of a trivially copyable state, for rollback and rewind.
+	 * Storage is inline and never reallocates, saving and finding a frame are a mask and a copy.
+	 *
+	 * Frames are saved in increasing order. Saving a frame again overwrites it and keeps the ones after it, a
+	 * re-simulation reads each frame's inputs before saving over it. Frames older than every held one arrive out of
+	 * order and are rejected. Skipping frames forward drops everything older, the ring only holds consecutive frames.
+	 */
+	template <typename StateType, int32_t Capacity>
+	class SnapshotRing
+	{
+		static_assert(std::is_trivially_copyable<StateType>::value, "Snapshots are saved and restored as plain copies");
+		static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	public:
+		/** Slot of Frame, to fill in place, null when Frame is older than every held frame */
+		StateType* Save(uint32_t Frame)
+		{
+			if (!Contains(Frame))
+			{
+				if (Count > 0 && Frame < NewestFrame)
+					return nullptr;
+
+				Count = Count > 0 && Frame == NewestFrame + 1 ? std::min(Count + 1, Capacity) : 1;
+				NewestFrame = Frame;
+			}
+			return &Snapshots[Frame & (Capacity - 1)];
+		}
+
+		/** False when Frame is older than every held frame */
+		bool Save(uint32_t Frame, const StateType& State)
+		{
+			StateType* Slot = Save(Frame);
+			if (Slot != nullptr)
+			{
+				*Slot = State;
+			}
+			return Slot != nullptr;
+		}
+
+		/** Snapshot of Frame, null when it was never saved or already overwritten */
+		const StateType* Find(uint32_t Frame) const
+		{
+			return Contains(Frame) ? &Snapshots[Frame & (Capacity - 1)] : nullptr;
+		}
+
+		bool Contains(uint32_t Frame) const
+		{
+			return Count > 0 && Frame <= NewestFrame && NewestFrame - Frame < static_cast<uint32_t>(Count);
+		}
+
+		uint32_t GetNewestFrame() const { return NewestFrame; }
+		uint32_t GetOldestFrame() const { return NewestFrame - static_cast<uint32_t>(Count > 0 ? Count - 1 : 0); }
+		int32_t Num() const { return Count; }
+		static int32_t GetCapacity() { return Capacity; }
+
+		void Reset() { Count = 0; }
+
+	private:
+		StateType Snapshots[Capacity];
+		uint32_t NewestFrame = 0;
+		int32_t Count = 0;
+	};
+}
@@ -0,0 +1,163 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GrappleCoreMath.h"
+#include "LaneStorage.h"
+#include <vector>
+
+namespace GrappleCore
+{
+	/**
+	 * Spherical pendulums: swingers on a rope of fixed length that can swing in any direction and orbit their anchor.
+	 * Same layout as PendulumBatch, stable handles over densely packed structure-of-arrays streams, see LaneStorage.
+	 *
+	 * The state is the cartesian offset from the anchor and the velocity. Each fixed step is a RATTLE step, velocity
+	 * Verlet projected back onto the sphere, then the speed is rescaled so the swinger keeps exactly the energy it
+	 * had plus the work of the steering and minus the damping. The swing neither gains nor bleeds energy whatever the
+	 * step length, so it stays stable at steps far larger than the planar integrators tolerate.
+	 */
+	class GRAPPLECORE_API SphericalPendulumBatch
+	{
+	public:
+		typedef int32_t FHandle;
+		static const FHandle InvalidHandle = -1;
+
+		/** Everything the batch keeps about one swinger, trivially copyable for rollback snapshots */
+		struct FSwingerState
+		{
+			Vec3 Anchor;
+			Vec3 Offset;
+			Vec3 PreviousOffset;
+			Vec3 Velocity;
+			Vec3 Steer;
+			Vec3 Position;
+			Vec3 SteerForward;
+			Vec3 SteerRight;
+			float SteerAcceleration;
+			float Energy;
+			float Length;
+			float Gravity;
+		};
+
+		SphericalPendulumBatch();
+
+		/**
+		 * Registers a swinger.
+		 * @param Offset			Position relative to the anchor, its length is the length of the rope
+		 * @param Velocity			Initial velocity, the part along the rope is dropped
+		 * @param Forward			Direction forward steering pushes to, flattened to the horizontal. The steering basis
+		 *							is built from it once here and kept for the whole swing.
+		 * @param Gravity			Vertical gravity in cm/s^2, negative pulls down
+		 * @param SteerAcceleration	Acceleration of full steering input in cm/s^2
+		 */
+		FHandle Add(const Vec3& Anchor, const Vec3& Offset, const Vec3& Velocity, const Vec3& Forward, float Gravity, float SteerAcceleration);
+		/** Registers a swinger saved by GetSwingerState */
+		FHandle Add(const FSwingerState& State);
+		void Remove(FHandle Handle);
+		bool IsValid(FHandle Handle) const;
+
+		/**
+		 * Moves a swinger to another batch with its whole state, steering included, and returns its handle there.
+		 * Handle is invalid afterwards. The swinger continues from its last fixed step in Target.
+		 */
+		FHandle MoveTo(FHandle Handle, SphericalPendulumBatch& Target);
+
+		/** Steering input along the swing basis, kept until it changes. The input is clamped to the unit circle. */
+		void SetSteering(FHandle Handle, float Forward, float Right);
+		/** Horizontal unit axes forward and right steering push along, fixed for the whole swing */
+		void GetSteeringBasis(FHandle Handle, Vec3& OutForward, Vec3& OutRight) const;
+
+		/**
+		 * Moves a swinger somewhere else on its sphere, when something blocked it. Offset is projected back on the
+		 * sphere, only the velocity around the anchor is kept and the energy follows the new state.
+		 */
+		void SetState(FHandle Handle, const Vec3& Offset, const Vec3& Velocity);
+
+		/**
+		 * Copies the whole state of a swinger, steering and interpolation included. SetSwingerState puts it back bit
+		 * for bit, the swinger then takes exactly the same steps again.
+		 */
+		void GetSwingerState(FHandle Handle, FSwingerState& OutState) const;
+		void SetSwingerState(FHandle Handle, const FSwingerState& State);
+
+		void Update(float DeltaTime);
+
+		/**
+		 * Update split for running on several threads: BeginUpdate advances the clock, then every lane group has to be
+		 * stepped exactly once with UpdateLaneGroups. Swingers are independent, disjoint ranges can run concurrently.
+		 * Nothing else may touch the batch until every range is done.
+		 */
+		void BeginUpdate(float DeltaTime);
+		void UpdateLaneGroups(int32_t FirstGroup, int32_t GroupCount);
+		/**
+		 * Steps a single swinger by exactly DeltaTime, in equal steps no longer than the fixed step unless that takes
+		 * more than MaxSubsteps, and leaves the others and the clock alone. Its position is where the steps end. Same
+		 * arithmetic as Update, the same swinger stepped by the same times always ends in the same state.
+		 */
+		void StepSwinger(FHandle Handle, float DeltaTime);
+
+		/** Groups of four swingers, the unit UpdateLaneGroups works on */
+		int32_t GetLaneGroupCount() const { return Storage.GetLaneGroupCount(); }
+
+		Vec3 GetPosition(FHandle Handle) const;
+		Vec3 GetAnchor(FHandle Handle) const;
+		/** Offset from the anchor and velocity at the last fixed step, not interpolated */
+		Vec3 GetOffset(FHandle Handle) const;
+		Vec3 GetVelocity(FHandle Handle) const;
+		int32_t Num() const { return Storage.Num(); }
+
+		/** Time not consumed by a fixed step yet, restored to replay a recording from the same step phase */
+		float GetAccumulatedTime() const { return Accumulator; }
+		void SetAccumulatedTime(float Time) { Accumulator = Clamp(Time, 0.f, FixedTimeStep); }
+
+		void SetFixedTimeStep(float NewFixedTimeStep) { FixedTimeStep = std::max(NewFixedTimeStep, SmallNumber); }
+		void SetMaxSubsteps(int32_t NewMaxSubsteps) { MaxSubsteps = std::max(NewMaxSubsteps, 1); }
+		/** Fraction of speed kept after one second, 1 disables damping */
+		void SetDamping(float NewDamping) { Damping = Clamp(NewDamping, 0.f, 1.f); }
+
+	private:
+		/** Steering frame of one swinger, only read when its input changes */
+		struct FSteeringBasis
+		{
+			Vec3 Forward;
+			Vec3 Right;
+			float Acceleration;
+		};
+
+		/** Every float stream below, one lane per swinger */
+		static const LaneStorage<SphericalPendulumBatch>::FStream Streams[];
+
+		/** Appends a lane for a new swinger and returns its handle, the caller fills the lane */
+		FHandle Allocate();
+		void SetDenseState(int32_t Dense, const Vec3& Offset, const Vec3& Velocity);
+		void Integrate(float StepTime, int32_t Begin, int32_t End);
+		void UpdatePositions(float Alpha, int32_t Begin, int32_t End);
+
+		// Simulation state, one lane per active swinger, padded with zeroed lanes to a multiple of four
+		std::vector<float> OffsetX, OffsetY, OffsetZ;                  // Position relative to the anchor
+		std::vector<float> PreviousOffsetX, PreviousOffsetY, PreviousOffsetZ; // Offset before the last fixed step, for interpolation
+		std::vector<float> VelocityX, VelocityY, VelocityZ;
+		std::vector<float> SteerX, SteerY, SteerZ;                     // Steering acceleration in world space
+		std::vector<float> Energy;                                     // Kinetic plus potential energy per unit of mass
+		std::vector<float> Length;                                     // Length of the rope
+		std::vector<float> Gravity;
+		std::vector<float> AnchorX, AnchorY, AnchorZ;
+
+		// Output of the last Update
+		std::vector<float> PositionX, PositionY, PositionZ;
+
+		std::vector<FSteeringBasis> Bases;
+
+		LaneStorage<SphericalPendulumBatch> Storage;
+
+		float FixedTimeStep;
+		int32_t MaxSubsteps;
+		float Damping;
+		float Accumulator;
+
+		// Fixed steps and interpolation of the update in flight, set by BeginUpdate
+		int32_t PendingSteps;
+		float PendingAlpha;
+	};
+}
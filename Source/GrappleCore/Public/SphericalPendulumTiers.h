@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "SphericalPendulumBatch.h"
+
+namespace GrappleCore
+{
+	/**
+	 * Spherical pendulums split over tiers of detail, one SphericalPendulumBatch per tier.
+	 * Every tier steps at its own multiple of the fixed step, swingers nobody looks at closely can take steps several
+	 * times longer and cost that much less. Handles stay valid when a swinger changes tier.
+	 *
+	 * Swingers can also be stepped by their owner instead, move by move with StepSwinger. Those sit in a batch of their
+	 * own that Update leaves alone, and always step at the full detail fixed step whatever their tier.
+	 *
+	 * Mirrors the SphericalPendulumBatch interface, see there for the meaning of each call.
+	 */
+	class GRAPPLECORE_API SphericalPendulumTiers
+	{
+	public:
+		typedef int32_t FHandle;
+		static const FHandle InvalidHandle = -1;
+
+		SphericalPendulumTiers();
+
+		/** Swingers of removed tiers move to the last remaining one. The setters below do nothing when the value is unchanged. */
+		void SetTierCount(int32_t TierCount);
+		int32_t GetTierCount() const { return static_cast<int32_t>(Tiers.size()); }
+		/** Tier steps last Multiplier fixed steps */
+		void SetStepMultiplier(int32_t Tier, int32_t Multiplier);
+
+		FHandle Add(const Vec3& Anchor, const Vec3& Offset, const Vec3& Velocity, const Vec3& Forward, float Gravity, float SteerAcceleration, int32_t Tier = 0);
+		void Remove(FHandle Handle);
+		bool IsValid(FHandle Handle) const;
+
+		/** Changing tier restarts the swinger from its last fixed step, at most one step of the old tier is lost */
+		void SetTier(FHandle Handle, int32_t Tier);
+		int32_t GetTier(FHandle Handle) const;
+
+		/** An owner stepped swinger keeps its tier for when it goes back to Update, it restarts from its last step */
+		void SetOwnerStepped(FHandle Handle, bool bOwnerStepped);
+		bool IsOwnerStepped(FHandle Handle) const;
+		/** Steps an owner stepped swinger by exactly DeltaTime, see SphericalPendulumBatch::StepSwinger */
+		void StepSwinger(FHandle Handle, float DeltaTime);
+
+		void SetSteering(FHandle Handle, float Forward, float Right);
+		void GetSteeringBasis(FHandle Handle, Vec3& OutForward, Vec3& OutRight) const;
+		void SetState(FHandle Handle, const Vec3& Offset, const Vec3& Velocity);
+		void GetSwingerState(FHandle Handle, SphericalPendulumBatch::FSwingerState& OutState) const;
+		void SetSwingerState(FHandle Handle, const SphericalPendulumBatch::FSwingerState& State);
+
+		void Update(float DeltaTime);
+		/** Same split as SphericalPendulumBatch, lane groups are numbered across every tier */
+		void BeginUpdate(float DeltaTime);
+		void UpdateLaneGroups(int32_t FirstGroup, int32_t GroupCount);
+		int32_t GetLaneGroupCount() const;
+
+		Vec3 GetPosition(FHandle Handle) const;
+		Vec3 GetAnchor(FHandle Handle) const;
+		Vec3 GetOffset(FHandle Handle) const;
+		Vec3 GetVelocity(FHandle Handle) const;
+		/** Every swinger, owner stepped ones included */
+		int32_t Num() const;
+		/** Swingers Update steps in Tier */
+		int32_t Num(int32_t Tier) const { return Tiers[Tier].Num(); }
+
+		/** Clock of the first tier, the others only matter once swingers move to them */
+		float GetAccumulatedTime() const { return Tiers[0].GetAccumulatedTime(); }
+		void SetAccumulatedTime(float Time);
+		/** Clock of the tier a swinger steps in, 0 for owner stepped swingers that step by exact times, the first tier's without a swinger */
+		float GetAccumulatedTime(FHandle Handle) const;
+		/** Fixed step a swinger takes, its tier's or the full detail one when owner stepped */
+		float GetFixedTimeStep(FHandle Handle) const;
+
+		void SetFixedTimeStep(float NewFixedTimeStep);
+		void SetMaxSubsteps(int32_t NewMaxSubsteps);
+		void SetDamping(float NewDamping);
+
+	private:
+		struct FSlot
+		{
+			int32_t Tier;
+			bool bOwnerStepped;
+			SphericalPendulumBatch::FHandle Handle;
+		};
+
+		/** Batch the swinger of Slot lives in */
+		SphericalPendulumBatch& GetBatch(const FSlot& Slot) { return Slot.bOwnerStepped ? OwnerStepped : Tiers[Slot.Tier]; }
+		const SphericalPendulumBatch& GetBatch(const FSlot& Slot) const { return Slot.bOwnerStepped ? OwnerStepped : Tiers[Slot.Tier]; }
+
+		/** Pushes the shared settings to every tier, the fixed step scaled by the tier's multiplier */
+		void ApplySettings();
+
+		std::vector<SphericalPendulumBatch> Tiers;
+		std::vector<int32_t> StepMultipliers;
+		SphericalPendulumBatch OwnerStepped;
+
+		// Handle -> tier and handle in that tier
+		std::vector<FSlot> Slots;
+		std::vector<FHandle> FreeHandles;
+
+		float FixedTimeStep;
+		int32_t MaxSubsteps;
+		float Damping;
+	};
+}
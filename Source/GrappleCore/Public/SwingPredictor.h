@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GrappleCoreMath.h"
+#include <vector>
+
+namespace GrappleCore
+{
+	/**
+	 * Closed-form motion of the planar pendulum of Pendulum and PendulumBatch, for trajectory previews and bot planning.
+	 * Answers the period, the next apex and the angle at any time in constant time instead of stepping a solver there.
+	 *
+	 * The exact solution is sin(Angle / 2) = k sn(Frequency * t, k) with k = sin(Amplitude / 2). Rope length and gravity
+	 * only scale time through Frequency = sqrt(|Gravity| / Length), so the tables are indexed by amplitude and phase
+	 * alone and serve every rope length. They hold the Jacobi amplitude am and its inverse, the incomplete elliptic
+	 * integral F, over a quarter period. Both are smooth in those coordinates and are interpolated bilinearly.
+	 * The period is exact, MakeSwing gets K(k) from the arithmetic-geometric mean in a handful of iterations. A table of
+	 * K would drift too far near the top, where it grows steeply, and the phase error adds up every period.
+	 *
+	 * Damping and steering are ignored, the prediction is the free swing from the given state.
+	 * The SwingPredictorError test checks the error against the RK4 solver over five seconds of the game's swings, and
+	 * SwingPredictorTables the interpolation of the default tables, see Tests/GrappleCoreTests.cpp. The error comes from
+	 * the interpolation and does not grow with time, the period is exact.
+	 */
+	class GRAPPLECORE_API SwingPredictor
+	{
+	public:
+		/**
+		 * Largest distance between the predicted and the stepped swinger, in cm, with the default tables. Half the
+		 * hook's 5 cm collision radius, a planned hook point or apex stays within what the hook absorbs. Bounded as a
+		 * distance rather than an angle: the angle error is largest on the short, fast ropes, where it moves the
+		 * swinger least.
+		 */
+		static constexpr float MaxPositionErrorBound = 2.5f;
+		/**
+		 * Largest GetTableError of the default tables, in radians. Twice the error of the 128 x 64 tables, halving
+		 * either resolution makes it ten times larger and fails.
+		 */
+		static constexpr float MaxTableErrorBound = 2.5e-4f;
+
+		/** One free swing, made by MakeSwing */
+		struct FSwing
+		{
+			/** Largest angle reached, in radians */
+			float Amplitude = 0.f;
+			/** sqrt(|Gravity| / Length), the angular frequency of small swings */
+			float Frequency = 0.f;
+			/** Time from the bottom to an apex, a quarter of the period */
+			float QuarterPeriod = 0.f;
+			/**
+			 * Phase at time zero in quarter periods, in [0, 4): 0 is the bottom moving towards positive angles,
+			 * 1 the positive apex, 2 the bottom moving back and 3 the negative apex
+			 */
+			float StartPhase = 0.f;
+		};
+
+		/**
+		 * Builds the tables, which takes a few milliseconds. Swings wider than MaxAmplitude radians are not predicted,
+		 * the period grows without bound as the amplitude gets close to the top.
+		 */
+		explicit SwingPredictor(float MaxAmplitude = 170.f * Pi / 180.f, int32_t AmplitudeSamples = 128, int32_t PhaseSamples = 64);
+
+		/** Tables shared by every caller, built on first use */
+		static const SwingPredictor& Get();
+
+		/**
+		 * Swing through Angle at AngularVelocity, in the conventions of Pendulum: angles from the bottom, negative
+		 * gravity pulls down. False if it goes over the top or wider than MaxAmplitude, those have to be stepped.
+		 */
+		bool MakeSwing(float Angle, float AngularVelocity, float Length, float Gravity, FSwing& OutSwing) const;
+
+		float GetPeriod(const FSwing& Swing) const { return 4.f * Swing.QuarterPeriod; }
+		float GetAngle(const FSwing& Swing, float Time) const;
+		float GetAngularVelocity(const FSwing& Swing, float Time) const;
+		/** Time from Time until the next apex, and the angle there, +-Amplitude */
+		float GetTimeToApex(const FSwing& Swing, float Time, float& OutApexAngle) const;
+
+		/** Position of the swinger at Angle, the same polar to cartesian conversion as Pendulum */
+		static Vec3 GetPosition(const Vec3& Origin, float Length, float X, float Y, float Angle);
+
+		float GetMaxAmplitude() const { return MaxAmplitude; }
+		/** Largest angle error of the interpolation between table samples, measured when the tables were built */
+		float GetTableError() const { return TableError; }
+
+	private:
+		/** Phase in [0, 4) at Time, split into its quarter and a fraction running from the bottom to the apex */
+		void GetQuarterPhase(const FSwing& Swing, float Time, int32_t& OutQuarter, float& OutFraction) const;
+		/** am(Fraction * K) / (Pi / 2) for the amplitude */
+		float LookupAmplitudeFraction(float Amplitude, float Fraction) const;
+		/** F(AmplitudeFraction * Pi / 2) / K, the inverse of LookupAmplitudeFraction */
+		float LookupPhaseFraction(float Amplitude, float AmplitudeFraction) const;
+		float Lookup(const std::vector<float>& Table, float Amplitude, float Fraction) const;
+
+		float MaxAmplitude;
+		int32_t AmplitudeSamples;
+		int32_t PhaseSamples;
+		float AmplitudeToSample;
+		float TableError;
+
+		/** AmplitudeSamples rows of PhaseSamples values */
+		std::vector<float> AmplitudeFractions;
+		std::vector<float> PhaseFractions;
+	};
+}
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GrappleCoreMath.h"
+
+namespace GrappleCore
+{
+	/**
+	 * Swing state of a spherical pendulum packed in ten bytes, for replication.
+	 *
+	 * The rope direction is two octahedral angles, which have no pole to lose precision at, the swing passes the
+	 * bottom all the time. The angular velocity is split along two tangents built from the quantized direction, so
+	 * both ends of the connection derive the same basis. The velocity along the rope is dropped, SphericalPendulumBatch
+	 * drops it too. The rope length is a fraction of MaxLength.
+	 *
+	 * With the defaults the position is within 0.15 cm of the original on ropes up to 20 m, the velocity within 1 cm/s.
+	 * BM_SwingQuantizerError measures both.
+	 */
+	class GRAPPLECORE_API SwingQuantizer
+	{
+	public:
+		struct FQuantizedSwing
+		{
+			int16_t DirectionX = 0;
+			int16_t DirectionY = 0;
+			int16_t AngularVelocityX = 0;
+			int16_t AngularVelocityY = 0;
+			uint16_t Length = 0;
+
+			bool operator==(const FQuantizedSwing& Other) const
+			{
+				return DirectionX == Other.DirectionX && DirectionY == Other.DirectionY
+					&& AngularVelocityX == Other.AngularVelocityX && AngularVelocityY == Other.AngularVelocityY
+					&& Length == Other.Length;
+			}
+			bool operator!=(const FQuantizedSwing& Other) const { return !(*this == Other); }
+		};
+
+		/** Ropes longer than MaxLength cm and angular velocities above MaxAngularVelocity rad/s are clamped */
+		explicit SwingQuantizer(float MaxLength = 8000.f, float MaxAngularVelocity = 16.f);
+
+		/** Offset from the anchor and velocity of the swinger, as SphericalPendulumBatch::GetOffset and GetVelocity */
+		FQuantizedSwing Quantize(const Vec3& Offset, const Vec3& Velocity) const;
+		void Dequantize(const FQuantizedSwing& Swing, Vec3& OutOffset, Vec3& OutVelocity) const;
+
+		float GetMaxLength() const { return MaxLength; }
+		float GetMaxAngularVelocity() const { return MaxAngularVelocity; }
+
+	private:
+		static void EncodeDirection(const Vec3& Direction, int16_t& OutX, int16_t& OutY);
+		static Vec3 DecodeDirection(int16_t X, int16_t Y);
+		/** Orthonormal tangents of a unit direction, continuous everywhere but across the upper pole */
+		static void GetTangents(const Vec3& Direction, Vec3& OutTangentX, Vec3& OutTangentY);
+
+		float MaxLength;
+		float MaxAngularVelocity;
+	};
+}
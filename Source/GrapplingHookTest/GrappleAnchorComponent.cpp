@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrappleAnchorComponent.h"
+#include "GrappleAnchorSubsystem.h"
+#include "Engine/World.h"
+
+UGrappleAnchorComponent::UGrappleAnchorComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UGrappleAnchorComponent::OnRegister()
+{
+	Super::OnRegister();
+
+	UGrappleAnchorSubsystem* AnchorSubsystem = GetWorld() != nullptr ? GetWorld()->GetSubsystem<UGrappleAnchorSubsystem>() : nullptr;
+	if (AnchorSubsystem != nullptr)
+	{
+		AnchorSubsystem->RegisterAnchor(this);
+	}
+}
+
+void UGrappleAnchorComponent::OnUnregister()
+{
+	UGrappleAnchorSubsystem* AnchorSubsystem = GetWorld() != nullptr ? GetWorld()->GetSubsystem<UGrappleAnchorSubsystem>() : nullptr;
+	if (AnchorSubsystem != nullptr)
+	{
+		AnchorSubsystem->UnregisterAnchor(this);
+	}
+
+	Super::OnUnregister();
+}
+
+void UGrappleAnchorComponent::OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	Super::OnUpdateTransform(UpdateTransformFlags, Teleport);
+
+	// Static anchors never get here after registration, only the ones that actually move pay for it
+	if (AnchorHandle != GrappleCore::AnchorGrid::InvalidHandle)
+	{
+		GetWorld()->GetSubsystem<UGrappleAnchorSubsystem>()->MoveAnchor(this);
+	}
+}
@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "AnchorGrid.h"
+#include "GrappleAnchorComponent.generated.h"
+
+/**
+ * Marks a point hooks can grab, for the queries of UGrappleAnchorSubsystem. Place it on the surfaces bots and aim
+ * assist should consider. Anchors of a level are gathered when it loads, movable ones keep the index up to date.
+ */
+UCLASS(ClassGroup = (Grapple), meta = (BlueprintSpawnableComponent))
+class UGrappleAnchorComponent : public USceneComponent
+{
+	GENERATED_BODY()
+
+public:
+	UGrappleAnchorComponent();
+
+protected:
+	// UActorComponent interface
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
+	// End of UActorComponent interface
+
+	// USceneComponent interface
+	virtual void OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport) override;
+	// End of USceneComponent interface
+
+private:
+	// Owns the handle
+	friend class UGrappleAnchorSubsystem;
+
+	/** Handle in the world's anchor grid while registered */
+	GrappleCore::AnchorGrid::FHandle AnchorHandle = GrappleCore::AnchorGrid::InvalidHandle;
+};
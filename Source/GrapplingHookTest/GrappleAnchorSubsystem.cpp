@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrappleAnchorSubsystem.h"
+#include "GrappleAnchorComponent.h"
+#include "GrappleCoreConversions.h"
+#include "GrapplingHookTest.h"
+
+DECLARE_CYCLE_STAT(TEXT("Anchor Query"), STAT_GrappleAnchorQuery, STATGROUP_Grapple);
+DECLARE_CYCLE_STAT(TEXT("Anchor Move"), STAT_GrappleAnchorMove, STATGROUP_Grapple);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Anchors"), STAT_GrappleAnchors, STATGROUP_Grapple);
+
+void UGrappleAnchorSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Grid.SetCellSize(CellSize, AnchorRadius);
+}
+
+void UGrappleAnchorSubsystem::Deinitialize()
+{
+	for (UGrappleAnchorComponent* Anchor : Anchors)
+	{
+		if (Anchor != nullptr)
+		{
+			Anchor->AnchorHandle = GrappleCore::AnchorGrid::InvalidHandle;
+		}
+	}
+
+	DEC_DWORD_STAT_BY(STAT_GrappleAnchors, Grid.Num());
+	Anchors.Reset();
+	Grid.Reset();
+
+	Super::Deinitialize();
+}
+
+void UGrappleAnchorSubsystem::RegisterAnchor(UGrappleAnchorComponent* Anchor)
+{
+	if (Anchor->AnchorHandle != GrappleCore::AnchorGrid::InvalidHandle)
+		return;
+
+	const GrappleCore::AnchorGrid::FHandle Handle = Grid.Add(ToGrappleCore(Anchor->GetComponentLocation()));
+	if (Handle >= Anchors.Num())
+	{
+		Anchors.SetNumZeroed(Handle + 1);
+	}
+	Anchors[Handle] = Anchor;
+	Anchor->AnchorHandle = Handle;
+	INC_DWORD_STAT(STAT_GrappleAnchors);
+}
+
+void UGrappleAnchorSubsystem::UnregisterAnchor(UGrappleAnchorComponent* Anchor)
+{
+	const GrappleCore::AnchorGrid::FHandle Handle = Anchor->AnchorHandle;
+	if (!Grid.IsValid(Handle) || Anchors[Handle] != Anchor)
+		return;
+
+	Grid.Remove(Handle);
+	Anchors[Handle] = nullptr;
+	Anchor->AnchorHandle = GrappleCore::AnchorGrid::InvalidHandle;
+	DEC_DWORD_STAT(STAT_GrappleAnchors);
+}
+
+void UGrappleAnchorSubsystem::MoveAnchor(UGrappleAnchorComponent* Anchor)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GrappleAnchorMove);
+
+	if (Grid.IsValid(Anchor->AnchorHandle))
+	{
+		Grid.Move(Anchor->AnchorHandle, ToGrappleCore(Anchor->GetComponentLocation()));
+	}
+}
+
+int32 UGrappleAnchorSubsystem::FindAnchorsInRadius(const FVector& Center, float Radius, TArray<UGrappleAnchorComponent*>& OutAnchors) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_GrappleAnchorQuery);
+
+	QueryHandles.clear();
+	Grid.QueryRadius(ToGrappleCore(Center), Radius, QueryHandles);
+	return AppendQueryResults(OutAnchors);
+}
+
+int32 UGrappleAnchorSubsystem::FindAnchorsInCone(const FVector& Origin, const FVector& Direction, float HalfAngle, float MaxDistance, TArray<UGrappleAnchorComponent*>& OutAnchors) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_GrappleAnchorQuery);
+
+	QueryHandles.clear();
+	Grid.QueryCone(ToGrappleCore(Origin), ToGrappleCore(Direction), FMath::DegreesToRadians(HalfAngle), MaxDistance, QueryHandles);
+	return AppendQueryResults(OutAnchors);
+}
+
+UGrappleAnchorComponent* UGrappleAnchorSubsystem::RaycastAnchors(const FVector& Origin, const FVector& Direction, float MaxDistance, float* OutDistance) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_GrappleAnchorQuery);
+
+	GrappleCore::AnchorGrid::FHandle Handle;
+	float Distance;
+	if (!Grid.Raycast(ToGrappleCore(Origin), ToGrappleCore(Direction), MaxDistance, Handle, Distance))
+		return nullptr;
+
+	if (OutDistance != nullptr)
+	{
+		*OutDistance = Distance;
+	}
+	return Anchors[Handle];
+}
+
+int32 UGrappleAnchorSubsystem::AppendQueryResults(TArray<UGrappleAnchorComponent*>& OutAnchors) const
+{
+	OutAnchors.Reserve(OutAnchors.Num() + static_cast<int32>(QueryHandles.size()));
+	for (GrappleCore::AnchorGrid::FHandle Handle : QueryHandles)
+	{
+		OutAnchors.Add(Anchors[Handle]);
+	}
+	return static_cast<int32>(QueryHandles.size());
+}
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AnchorGrid.h"
+#include "GrappleAnchorSubsystem.generated.h"
+
+class UGrappleAnchorComponent;
+
+/**
+ * Per-world registry of the UGrappleAnchorComponents, indexed in a GrappleCore::AnchorGrid.
+ * Answers "what can I grapple from here" for bots and aim assist without scene queries: radius, cone and raycast
+ * queries only read the grid, they see anchors rather than collision, and take microseconds.
+ * The GrappleBenchmark commandlet's -Anchors mode compares them with the equivalent scene queries.
+ */
+UCLASS(config = Game)
+class UGrappleAnchorSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Edge of the grid cells in cm, around the radius of the usual queries */
+	UPROPERTY(Config)
+	float CellSize = 1000.f;
+
+	/** How close to an anchor a raycast has to pass to grab it, in cm. At most half a cell. */
+	UPROPERTY(Config)
+	float AnchorRadius = 50.f;
+
+	void RegisterAnchor(UGrappleAnchorComponent* Anchor);
+	void UnregisterAnchor(UGrappleAnchorComponent* Anchor);
+	/** Follows an anchor to its component's current location */
+	void MoveAnchor(UGrappleAnchorComponent* Anchor);
+
+	/** Appends the anchors within Radius of Center, in no particular order, and returns how many */
+	int32 FindAnchorsInRadius(const FVector& Center, float Radius, TArray<UGrappleAnchorComponent*>& OutAnchors) const;
+	/** Appends the anchors within MaxDistance and HalfAngle degrees of Direction, in no particular order, and returns how many */
+	int32 FindAnchorsInCone(const FVector& Origin, const FVector& Direction, float HalfAngle, float MaxDistance, TArray<UGrappleAnchorComponent*>& OutAnchors) const;
+	/** First anchor the ray passes within AnchorRadius of, nullptr if none is closer than MaxDistance */
+	UGrappleAnchorComponent* RaycastAnchors(const FVector& Origin, const FVector& Direction, float MaxDistance, float* OutDistance = nullptr) const;
+
+	int32 GetAnchorCount() const { return Grid.Num(); }
+
+	// USubsystem interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	// End of USubsystem interface
+
+private:
+	int32 AppendQueryResults(TArray<UGrappleAnchorComponent*>& OutAnchors) const;
+
+	GrappleCore::AnchorGrid Grid;
+
+	/** Indexed by grid handle */
+	UPROPERTY(Transient)
+	TArray<UGrappleAnchorComponent*> Anchors;
+
+	/** Handles of the last query, kept to not allocate per query */
+	mutable std::vector<GrappleCore::AnchorGrid::FHandle> QueryHandles;
+};
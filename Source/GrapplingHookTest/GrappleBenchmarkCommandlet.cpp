@@ -0,0 +1,696 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrappleBenchmarkCommandlet.h"
+#include "GrappleAnchorComponent.h"
+#include "GrappleAnchorSubsystem.h"
+#include "GrapplingHookTest.h"
+#include "GrapplingHookTestCharacter.h"
+#include "GrapplingHookTestGameMode.h"
+#include "GrapplingHookTestProjectile.h"
+#include "GrappleRecording.h"
+#include "GrappleRopeManager.h"
+#include "GrappleSubsystem.h"
+#include "Components/SphereComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/WorldSettings.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace GrappleBenchmark
+{
+	/** Bots stand on a grid with this spacing, in cm */
+	const float BotSpacing = 300.f;
+	/** Distance from the outer bots to the arena walls, and from the floor to the ceiling, in cm */
+	const float ArenaMargin = 1500.f;
+
+	// Timings of one fire -> hook -> swing -> retract cycle, in seconds
+	const float MaxIdleTime = 1.f;
+	const float HookTimeout = 2.f;
+	const float SwingTime = 1.5f;
+
+	// Anchor benchmark layout and query shapes, in cm and degrees
+	const float AnchorSpacing = 500.f;
+	const float AnchorQueryRadius = 2000.f;
+	const float AnchorConeHalfAngle = 20.f;
+	const float AnchorQueryDistance = 5000.f;
+
+	const TCHAR* const CsvHeader = TEXT("Bots,Significance,Frame,FrameMs,PendulumMs,SwingMs,ProjectileMs,RopeMs,RopeFlushMs,Flying,Swinging,Stripped\n");
+
+	enum class EBotPhase { Idle, Flying, Swinging, Retracting };
+
+	struct FBot
+	{
+		AGrapplingHookTestCharacter* Character = nullptr;
+		EBotPhase Phase = EBotPhase::Idle;
+		float PhaseTime = 0.f;
+		float IdleTime = 0.f;
+	};
+
+	struct FSweepResult
+	{
+		int32 CompletedCycles = 0;
+		TArray<double> FrameMilliseconds;
+		/** Growth of the process's used memory from before the bots spawned to the last frame */
+		int64 MemoryBytes = 0;
+		FGrappleLaunchStats Launches;
+		/** Rollbacks of swinging bots at the end of the sweep, and the game thread time they took */
+		int32 Rollbacks = 0;
+		int32 RollbackFrames = 0;
+		double RollbackMilliseconds = 0.0;
+	};
+
+	float GetArenaHalfWidth(int32 GridSize)
+	{
+		return GridSize * BotSpacing * 0.5f + ArenaMargin;
+	}
+
+	double CyclesToMilliseconds(uint64 Cycles)
+	{
+		return FPlatformTime::ToMilliseconds64(Cycles);
+	}
+
+	UWorld* CreateWorld()
+	{
+		UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("GrappleBenchmark"));
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.SetCurrentWorld(World);
+
+		World->InitializeActorsForPlay(FURL());
+		// There is no game mode to start play, begin play on the world settings directly
+		World->GetWorldSettings()->NotifyBeginPlay();
+		return World;
+	}
+
+	void DestroyWorld(UWorld* World)
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+
+	void SpawnBox(UWorld* World, UStaticMesh* Cube, const FVector& Center, const FVector& Size)
+	{
+		AStaticMeshActor* Box = World->SpawnActor<AStaticMeshActor>(Center, FRotator::ZeroRotator);
+		Box->SetMobility(EComponentMobility::Movable);
+		Box->GetStaticMeshComponent()->SetStaticMesh(Cube);
+		// The engine cube is 100cm wide
+		Box->SetActorScale3D(Size / 100.f);
+	}
+
+	/** Floor, ceiling and four walls around a GridSize x GridSize grid of bots, every hook hits something */
+	void SpawnArena(UWorld* World, int32 GridSize)
+	{
+		UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+		const float HalfWidth = GetArenaHalfWidth(GridSize);
+		const float Thickness = 100.f;
+
+		SpawnBox(World, Cube, FVector(0.f, 0.f, -Thickness * 0.5f), FVector(HalfWidth * 2.f, HalfWidth * 2.f, Thickness));
+		SpawnBox(World, Cube, FVector(0.f, 0.f, ArenaMargin + Thickness * 0.5f), FVector(HalfWidth * 2.f, HalfWidth * 2.f, Thickness));
+		SpawnBox(World, Cube, FVector(HalfWidth, 0.f, ArenaMargin * 0.5f), FVector(Thickness, HalfWidth * 2.f, ArenaMargin));
+		SpawnBox(World, Cube, FVector(-HalfWidth, 0.f, ArenaMargin * 0.5f), FVector(Thickness, HalfWidth * 2.f, ArenaMargin));
+		SpawnBox(World, Cube, FVector(0.f, HalfWidth, ArenaMargin * 0.5f), FVector(HalfWidth * 2.f, Thickness, ArenaMargin));
+		SpawnBox(World, Cube, FVector(0.f, -HalfWidth, ArenaMargin * 0.5f), FVector(HalfWidth * 2.f, Thickness, ArenaMargin));
+	}
+
+	void SpawnBots(UWorld* World, TSubclassOf<AGrapplingHookTestCharacter> CharacterClass, int32 BotCount, FRandomStream& Random, TArray<FBot>& Bots)
+	{
+		const int32 GridSize = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(BotCount)));
+		SpawnArena(World, GridSize);
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		const float GridOrigin = -(GridSize - 1) * BotSpacing * 0.5f;
+		for (int32 BotIndex = 0; BotIndex < BotCount; ++BotIndex)
+		{
+			// Random yaw so the hooks spread over the walls
+			const FVector Location(GridOrigin + (BotIndex % GridSize) * BotSpacing, GridOrigin + (BotIndex / GridSize) * BotSpacing, 200.f);
+			const FRotator Rotation(0.f, Random.FRandRange(0.f, 360.f), 0.f);
+
+			AGrapplingHookTestCharacter* Character = World->SpawnActor<AGrapplingHookTestCharacter>(CharacterClass, Location, Rotation, SpawnParams);
+			if (Character == nullptr)
+				continue;
+
+			// Bots have no controller, the movement component still has to run
+			Character->GetCharacterMovement()->bRunPhysicsWithNoController = true;
+
+			FBot& Bot = Bots.AddDefaulted_GetRef();
+			Bot.Character = Character;
+			Bot.IdleTime = Random.FRandRange(0.f, MaxIdleTime);
+		}
+	}
+
+	bool AreHooksDocked(const AGrapplingHookTestCharacter* Character)
+	{
+		for (const AGrapplingHookTestProjectile* Hook : Character->GetHooks())
+		{
+			if (Hook->GetProjectileState() != ProjectileState::DOCKED)
+				return false;
+		}
+		return true;
+	}
+
+	/** Moves every bot along fire -> hook -> swing -> retract, returns the number of cycles completed this frame */
+	int32 DriveBots(TArray<FBot>& Bots, float DeltaTime, FRandomStream& Random)
+	{
+		int32 CompletedCycles = 0;
+		for (FBot& Bot : Bots)
+		{
+			Bot.PhaseTime += DeltaTime;
+
+			switch (Bot.Phase)
+			{
+			case EBotPhase::Idle:
+				if (Bot.PhaseTime >= Bot.IdleTime)
+				{
+					// The shot fell inside the frame that just went by, the hook catches up from there
+					Bot.Character->FireInput(Bot.PhaseTime - Bot.IdleTime);
+					Bot.Phase = EBotPhase::Flying;
+					Bot.PhaseTime = 0.f;
+				}
+				break;
+			case EBotPhase::Flying:
+				if (Bot.Character->GetCharacterState() == CharacterState::SWINGING)
+				{
+					Bot.Phase = EBotPhase::Swinging;
+					Bot.PhaseTime = 0.f;
+				}
+				else if (Bot.PhaseTime >= HookTimeout)
+				{
+					Bot.Character->OnRetract();
+					Bot.Phase = EBotPhase::Retracting;
+					Bot.PhaseTime = 0.f;
+				}
+				break;
+			case EBotPhase::Swinging:
+				if (Bot.PhaseTime >= SwingTime)
+				{
+					Bot.Character->OnRetract();
+					Bot.Phase = EBotPhase::Retracting;
+					Bot.PhaseTime = 0.f;
+				}
+				break;
+			case EBotPhase::Retracting:
+				if (AreHooksDocked(Bot.Character))
+				{
+					++CompletedCycles;
+					Bot.Phase = EBotPhase::Idle;
+					Bot.PhaseTime = 0.f;
+					Bot.IdleTime = Random.FRandRange(0.f, MaxIdleTime);
+				}
+				break;
+			}
+		}
+		return CompletedCycles;
+	}
+
+	/** Ticks World by one fixed frame, returns the time the tick took in milliseconds */
+	double TickWorld(UWorld* World, float DeltaTime)
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		World->Tick(LEVELTICK_All, DeltaTime);
+		return CyclesToMilliseconds(FPlatformTime::Cycles64() - StartCycles);
+	}
+
+	void AdvanceFrame(float DeltaTime)
+	{
+		++GFrameCounter;
+		FApp::SetDeltaTime(DeltaTime);
+		FApp::SetCurrentTime(FApp::GetCurrentTime() + DeltaTime);
+	}
+
+	/** Appends the phase timings of the frame that was just ticked, LastFlushCycles carries the rope flush total over */
+	void AppendCsvRow(FString& Csv, UGrappleSubsystem* GrappleSubsystem, int32 BotCount, bool bSignificance, bool bStripped, int32 Frame, double FrameMilliseconds, uint64& LastFlushCycles, int32 Flying, int32 Swinging)
+	{
+		const FGrappleFrameTimings Timings = GrappleSubsystem->ConsumeFrameTimings();
+		const AGrappleRopeManager* RopeManager = GrappleSubsystem->FindRopeManager();
+		const uint64 FlushCycles = RopeManager != nullptr ? RopeManager->GetTotalFlushCycles() : 0;
+
+		// Hook updates include the rope simulation, the projectile phase is what remains
+		const uint64 ProjectileCycles = Timings.HookCycles > Timings.RopeCycles ? Timings.HookCycles - Timings.RopeCycles : 0;
+		Csv += FString::Printf(TEXT("%d,%d,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%d,%d,%d\n"),
+			BotCount, bSignificance ? 1 : 0, Frame, FrameMilliseconds,
+			CyclesToMilliseconds(Timings.PendulumCycles),
+			CyclesToMilliseconds(Timings.SwingCycles),
+			CyclesToMilliseconds(ProjectileCycles),
+			CyclesToMilliseconds(Timings.RopeCycles),
+			CyclesToMilliseconds(FlushCycles - LastFlushCycles),
+			Flying, Swinging, bStripped ? 1 : 0);
+		LastFlushCycles = FlushCycles;
+	}
+
+	/**
+	 * Rolls every swinging bot back RollbackFrames frames through UGrappleSubsystem::Resimulate, the path a server
+	 * correction takes, and adds the time it took to Result. Bots whose ring does not hold that frame are skipped.
+	 */
+	void RunRollbacks(UGrappleSubsystem* GrappleSubsystem, const TArray<FBot>& Bots, int32 RollbackFrames, FSweepResult& Result)
+	{
+		const uint32 NewestFrame = UGrappleSubsystem::GetSnapshotFrame();
+		for (const FBot& Bot : Bots)
+		{
+			if (Bot.Character->GetCharacterState() != CharacterState::SWINGING)
+				continue;
+
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			const int32 Frames = GrappleSubsystem->Resimulate(Bot.Character, NewestFrame - RollbackFrames, RollbackFrames);
+			const uint64 Cycles = FPlatformTime::Cycles64() - StartCycles;
+			if (Frames == 0)
+				continue;
+
+			Result.RollbackMilliseconds += CyclesToMilliseconds(Cycles);
+			Result.RollbackFrames += Frames;
+			++Result.Rollbacks;
+		}
+	}
+
+	/**
+	 * With bSignificance, the crowd is seen from a corner of the arena and far bots lose detail.
+	 * With bStripCosmetics, the world runs without the cosmetics a dedicated server strips.
+	 * With RollbackFrames above 0, the swinging bots are rolled back that many frames after the last one.
+	 */
+	FSweepResult RunSweep(TSubclassOf<AGrapplingHookTestCharacter> CharacterClass, int32 BotCount, int32 FrameCount, float DeltaTime, int32 Seed, bool bSignificance, bool bStripCosmetics, int32 RollbackFrames, FString& Csv)
+	{
+		FSweepResult Result;
+		FRandomStream Random(Seed);
+
+		// Back to the dedicated server default afterwards, the benchmark world is standalone and keeps its cosmetics
+		IConsoleVariable* CosmeticsVariable = IConsoleManager::Get().FindConsoleVariable(TEXT("grapple.Cosmetics"));
+		CosmeticsVariable->Set(bStripCosmetics ? 0 : -1, ECVF_SetByCode);
+
+		// The world never pumps async loading, the bots' assets are loaded up front and shared by every bot
+		const TSharedPtr<FStreamableHandle> BotAssets = CharacterClass->GetDefaultObject<AGrapplingHookTestCharacter>()->LoadStreamedAssets();
+
+		UWorld* World = CreateWorld();
+		const int64 StartUsedMemory = static_cast<int64>(FPlatformMemory::GetStats().UsedPhysical);
+		TArray<FBot> Bots;
+		SpawnBots(World, CharacterClass, BotCount, Random, Bots);
+
+		UGrappleSubsystem* GrappleSubsystem = World->GetSubsystem<UGrappleSubsystem>();
+		GrappleSubsystem->ConsumeFrameTimings();
+		GrappleSubsystem->ConsumeLaunchStats();
+
+		if (bSignificance)
+		{
+			const float HalfWidth = GetArenaHalfWidth(FMath::CeilToInt(FMath::Sqrt(static_cast<float>(BotCount))));
+			GrappleSubsystem->SetExtraViewLocations({ FVector(-HalfWidth, -HalfWidth, ArenaMargin * 0.5f) });
+		}
+
+		uint64 LastFlushCycles = 0;
+		Result.FrameMilliseconds.Reserve(FrameCount);
+		for (int32 Frame = 0; Frame < FrameCount; ++Frame)
+		{
+			AdvanceFrame(DeltaTime);
+			Result.CompletedCycles += DriveBots(Bots, DeltaTime, Random);
+
+			const double FrameMilliseconds = TickWorld(World, DeltaTime);
+			Result.FrameMilliseconds.Add(FrameMilliseconds);
+
+			int32 Flying = 0;
+			int32 Swinging = 0;
+			for (const FBot& Bot : Bots)
+			{
+				Flying += Bot.Phase == EBotPhase::Flying ? 1 : 0;
+				Swinging += Bot.Phase == EBotPhase::Swinging ? 1 : 0;
+			}
+
+			AppendCsvRow(Csv, GrappleSubsystem, BotCount, bSignificance, bStripCosmetics, Frame, FrameMilliseconds, LastFlushCycles, Flying, Swinging);
+		}
+		Result.MemoryBytes = static_cast<int64>(FPlatformMemory::GetStats().UsedPhysical) - StartUsedMemory;
+		Result.Launches = GrappleSubsystem->ConsumeLaunchStats();
+
+		if (RollbackFrames > 0)
+		{
+			RunRollbacks(GrappleSubsystem, Bots, RollbackFrames, Result);
+		}
+
+		DestroyWorld(World);
+		CosmeticsVariable->Set(-1, ECVF_SetByCode);
+		return Result;
+	}
+
+	/** Logs the frame times of a sweep and returns their average, in milliseconds */
+	double LogSweep(int32 BotCount, const TCHAR* Label, FSweepResult& Result)
+	{
+		Result.FrameMilliseconds.Sort();
+		double TotalMilliseconds = 0.0;
+		for (double FrameMilliseconds : Result.FrameMilliseconds)
+		{
+			TotalMilliseconds += FrameMilliseconds;
+		}
+		const double AverageMilliseconds = TotalMilliseconds / Result.FrameMilliseconds.Num();
+
+		UE_LOG(LogGrapple, Display, TEXT("%5d bots%s: %.3f ms average, %.3f ms p95, %d grapple cycles completed"),
+			BotCount, Label,
+			AverageMilliseconds,
+			Result.FrameMilliseconds[FMath::Min(FMath::FloorToInt(Result.FrameMilliseconds.Num() * 0.95f), Result.FrameMilliseconds.Num() - 1)],
+			Result.CompletedCycles);
+
+		// In simulation time, from the shot to the hook's flight, against the same shots launched at the frame start
+		const FGrappleLaunchStats& Launches = Result.Launches;
+		if (Launches.Launches > 0)
+		{
+			UE_LOG(LogGrapple, Display, TEXT("%5d bots%s: %d launches, input to flight %.2f ms average, %.2f ms max, %.2f ms average and %.2f ms max at the frame start, %.2f ms average lead"),
+				BotCount, Label, Launches.Launches,
+				Launches.TotalLatency * 1000.0 / Launches.Launches, Launches.MaxLatency * 1000.0,
+				Launches.TotalFrameStartLatency * 1000.0 / Launches.Launches, Launches.MaxFrameStartLatency * 1000.0,
+				Launches.TotalLeadTime * 1000.0 / Launches.Launches);
+		}
+
+		if (Result.Rollbacks > 0)
+		{
+			UE_LOG(LogGrapple, Display, TEXT("%5d bots%s: %d rollbacks of %.1f frames, %.2f us per rollback, %.2f us per frame simulated again"),
+				BotCount, Label, Result.Rollbacks, static_cast<double>(Result.RollbackFrames) / Result.Rollbacks,
+				Result.RollbackMilliseconds * 1000.0 / Result.Rollbacks,
+				Result.RollbackMilliseconds * 1000.0 / FMath::Max(Result.RollbackFrames, 1));
+		}
+		return AverageMilliseconds;
+	}
+
+	/** Anchors on a jittered cubic grid, each with a collision sphere of the anchor radius for the scene queries. Returns the half width. */
+	float SpawnAnchors(UWorld* World, int32 AnchorCount, float AnchorRadius, FRandomStream& Random)
+	{
+		const int32 GridSize = FMath::CeilToInt(FMath::Pow(static_cast<float>(AnchorCount), 1.f / 3.f));
+		const float HalfWidth = GridSize * AnchorSpacing * 0.5f;
+
+		for (int32 AnchorIndex = 0; AnchorIndex < AnchorCount; ++AnchorIndex)
+		{
+			const FVector Cell(AnchorIndex % GridSize, (AnchorIndex / GridSize) % GridSize, AnchorIndex / (GridSize * GridSize));
+			const FVector Location = Cell * AnchorSpacing - FVector(HalfWidth) + Random.GetUnitVector() * (AnchorSpacing * 0.4f);
+
+			AActor* Actor = World->SpawnActor<AActor>();
+			USphereComponent* Sphere = NewObject<USphereComponent>(Actor);
+			Sphere->InitSphereRadius(AnchorRadius);
+			Sphere->SetCollisionProfileName(UCollisionProfile::BlockAllDynamic_ProfileName);
+			Sphere->SetWorldLocation(Location);
+			Actor->SetRootComponent(Sphere);
+			Sphere->RegisterComponent();
+
+			UGrappleAnchorComponent* Anchor = NewObject<UGrappleAnchorComponent>(Actor);
+			Anchor->SetupAttachment(Sphere);
+			Anchor->RegisterComponent();
+		}
+		return HalfWidth;
+	}
+
+	/** Times QueryCount calls of Query, which returns how many anchors it found, and logs the cost of one */
+	template <typename QueryType>
+	double TimeAnchorQueries(const TCHAR* Label, int32 QueryCount, QueryType Query)
+	{
+		int64 Found = 0;
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int32 QueryIndex = 0; QueryIndex < QueryCount; ++QueryIndex)
+		{
+			Found += Query(QueryIndex);
+		}
+		const double Microseconds = CyclesToMilliseconds(FPlatformTime::Cycles64() - StartCycles) * 1000.0 / QueryCount;
+
+		UE_LOG(LogGrapple, Display, TEXT("    %-13s %9.3f us per query, %.2f found per query"), Label, Microseconds, static_cast<double>(Found) / QueryCount);
+		return Microseconds;
+	}
+
+	/** Answers the same random queries with the anchor grid and with the physics scene */
+	void RunAnchorBenchmark(int32 AnchorCount, int32 QueryCount, int32 Seed)
+	{
+		FRandomStream Random(Seed);
+		UWorld* World = CreateWorld();
+		UGrappleAnchorSubsystem* AnchorSubsystem = World->GetSubsystem<UGrappleAnchorSubsystem>();
+		const float HalfWidth = SpawnAnchors(World, AnchorCount, AnchorSubsystem->AnchorRadius, Random);
+		TickWorld(World, 1.f / 60.f);
+
+		TArray<FVector> Origins;
+		TArray<FVector> Directions;
+		for (int32 QueryIndex = 0; QueryIndex < QueryCount; ++QueryIndex)
+		{
+			Origins.Add(FVector(Random.FRandRange(-HalfWidth, HalfWidth), Random.FRandRange(-HalfWidth, HalfWidth), Random.FRandRange(-HalfWidth, HalfWidth)));
+			Directions.Add(Random.GetUnitVector());
+		}
+
+		const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(GrappleAnchorBenchmark));
+		const FCollisionObjectQueryParams ObjectParams(ECC_WorldDynamic);
+		const float CosHalfAngle = FMath::Cos(FMath::DegreesToRadians(AnchorConeHalfAngle));
+		TArray<UGrappleAnchorComponent*> Anchors;
+		TArray<FOverlapResult> Overlaps;
+
+		UE_LOG(LogGrapple, Display, TEXT("%7d anchors, %d in the grid"), AnchorCount, AnchorSubsystem->GetAnchorCount());
+
+		// Scene overlaps find the anchor spheres touching the query, up to the anchor radius further than the grid
+		const double GridRadius = TimeAnchorQueries(TEXT("Grid radius"), QueryCount, [&](int32 QueryIndex)
+		{
+			Anchors.Reset();
+			return AnchorSubsystem->FindAnchorsInRadius(Origins[QueryIndex], AnchorQueryRadius, Anchors);
+		});
+		const double SceneRadius = TimeAnchorQueries(TEXT("Scene radius"), QueryCount, [&](int32 QueryIndex)
+		{
+			Overlaps.Reset();
+			World->OverlapMultiByObjectType(Overlaps, Origins[QueryIndex], FQuat::Identity, ObjectParams, FCollisionShape::MakeSphere(AnchorQueryRadius), QueryParams);
+			return Overlaps.Num();
+		});
+
+		// Without a cone shape, the scene answers with an overlap of the whole sphere filtered by angle
+		const double GridCone = TimeAnchorQueries(TEXT("Grid cone"), QueryCount, [&](int32 QueryIndex)
+		{
+			Anchors.Reset();
+			return AnchorSubsystem->FindAnchorsInCone(Origins[QueryIndex], Directions[QueryIndex], AnchorConeHalfAngle, AnchorQueryDistance, Anchors);
+		});
+		const double SceneCone = TimeAnchorQueries(TEXT("Scene cone"), QueryCount, [&](int32 QueryIndex)
+		{
+			Overlaps.Reset();
+			World->OverlapMultiByObjectType(Overlaps, Origins[QueryIndex], FQuat::Identity, ObjectParams, FCollisionShape::MakeSphere(AnchorQueryDistance), QueryParams);
+
+			int32 Found = 0;
+			for (const FOverlapResult& Overlap : Overlaps)
+			{
+				const FVector ToAnchor = Overlap.GetComponent()->GetComponentLocation() - Origins[QueryIndex];
+				Found += FVector::DotProduct(ToAnchor, Directions[QueryIndex]) >= CosHalfAngle * ToAnchor.Size() ? 1 : 0;
+			}
+			return Found;
+		});
+
+		const double GridRay = TimeAnchorQueries(TEXT("Grid raycast"), QueryCount, [&](int32 QueryIndex)
+		{
+			return AnchorSubsystem->RaycastAnchors(Origins[QueryIndex], Directions[QueryIndex], AnchorQueryDistance) != nullptr ? 1 : 0;
+		});
+		const double SceneRay = TimeAnchorQueries(TEXT("Scene raycast"), QueryCount, [&](int32 QueryIndex)
+		{
+			FHitResult Hit;
+			return World->LineTraceSingleByObjectType(Hit, Origins[QueryIndex], Origins[QueryIndex] + Directions[QueryIndex] * AnchorQueryDistance, ObjectParams, QueryParams) ? 1 : 0;
+		});
+
+		UE_LOG(LogGrapple, Display, TEXT("%7d anchors: the grid is %.1fx faster on radius, %.1fx on cone and %.1fx on raycast queries"),
+			AnchorCount,
+			SceneRadius / FMath::Max(GridRadius, 1e-6),
+			SceneCone / FMath::Max(GridCone, 1e-6),
+			SceneRay / FMath::Max(GridRay, 1e-6));
+
+		DestroyWorld(World);
+	}
+
+	/** Plays a recorded session back as fast as the world ticks, the recorded delta times drive the simulation */
+	bool RunReplay(const FString& Path, int32 SessionIndex, FString& Csv)
+	{
+		UWorld* World = CreateWorld();
+		UGrappleSubsystem* GrappleSubsystem = World->GetSubsystem<UGrappleSubsystem>();
+
+		FGrappleReplay Replay(World);
+		if (!Replay.Load(Path, SessionIndex))
+		{
+			DestroyWorld(World);
+			return false;
+		}
+		GrappleSubsystem->ApplySessionSettings(Replay.GetHeader());
+		GrappleSubsystem->ConsumeFrameTimings();
+
+		int32 Frame = 0;
+		double RecordedSeconds = 0.0;
+		uint64 LastFlushCycles = 0;
+		const double StartSeconds = FPlatformTime::Seconds();
+
+		float DeltaTime;
+		while (Replay.BeginFrame(DeltaTime))
+		{
+			AdvanceFrame(DeltaTime);
+			const double FrameMilliseconds = TickWorld(World, DeltaTime);
+			Replay.EndFrame();
+
+			AppendCsvRow(Csv, GrappleSubsystem, Replay.GetCharacterCount(), false, false, Frame, FrameMilliseconds, LastFlushCycles,
+				GrappleSubsystem->GetHookCount(ProjectileState::LAUNCHING),
+				GrappleSubsystem->GetCharacterCount(CharacterState::SWINGING));
+
+			RecordedSeconds += DeltaTime;
+			++Frame;
+		}
+
+		const double WallSeconds = FMath::Max(FPlatformTime::Seconds() - StartSeconds, SMALL_NUMBER);
+		UE_LOG(LogGrapple, Display, TEXT("Replayed %d frames of %s with %d characters: %.2f s recorded in %.2f s (%.1fx real time)"),
+			Frame, *Replay.GetHeader().MapName, Replay.GetCharacterCount(), RecordedSeconds, WallSeconds, RecordedSeconds / WallSeconds);
+		UE_LOG(LogGrapple, Display, TEXT("Largest swing position error %g cm, %d swing state mismatches"),
+			Replay.GetMaxSwingError(), Replay.GetStateMismatches());
+
+		DestroyWorld(World);
+		return true;
+	}
+}
+
+UGrappleBenchmarkCommandlet::UGrappleBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UGrappleBenchmarkCommandlet::Main(const FString& Params)
+{
+	using namespace GrappleBenchmark;
+
+	FString BotCountsString = TEXT("1,10,100,1000,4000");
+	FParse::Value(*Params, TEXT("Bots="), BotCountsString, false);
+	TArray<FString> BotCountStrings;
+	BotCountsString.ParseIntoArray(BotCountStrings, TEXT(","));
+
+	int32 FrameCount = 600;
+	FParse::Value(*Params, TEXT("Frames="), FrameCount);
+	float FramesPerSecond = 60.f;
+	FParse::Value(*Params, TEXT("FPS="), FramesPerSecond);
+	int32 Seed = 0;
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / TEXT("GrappleBenchmark.csv");
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	// Runs the parallel phases on the game thread, for scaling comparisons
+	if (FParse::Param(*Params, TEXT("SingleThreaded")))
+	{
+		IConsoleManager::Get().FindConsoleVariable(TEXT("grapple.Parallel"))->Set(0, ECVF_SetByCommandline);
+	}
+
+	// Anchor queries need no characters
+	FString AnchorCountsString;
+	if (FParse::Value(*Params, TEXT("Anchors="), AnchorCountsString, false))
+	{
+		int32 QueryCount = 1000;
+		FParse::Value(*Params, TEXT("Queries="), QueryCount);
+		if (QueryCount <= 0)
+		{
+			UE_LOG(LogGrapple, Error, TEXT("-Queries must be positive"));
+			return 1;
+		}
+
+		TArray<FString> AnchorCountStrings;
+		AnchorCountsString.ParseIntoArray(AnchorCountStrings, TEXT(","));
+		for (const FString& AnchorCountString : AnchorCountStrings)
+		{
+			const int32 AnchorCount = FCString::Atoi(*AnchorCountString);
+			if (AnchorCount > 0)
+			{
+				RunAnchorBenchmark(AnchorCount, QueryCount, Seed);
+			}
+		}
+		return 0;
+	}
+
+	// Replays rebuild the characters from the recording
+	FString ReplayPath;
+	if (FParse::Value(*Params, TEXT("Replay="), ReplayPath))
+	{
+		int32 SessionIndex = 0;
+		FParse::Value(*Params, TEXT("Session="), SessionIndex);
+		if (!FParse::Value(*Params, TEXT("Output="), OutputPath))
+		{
+			OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / TEXT("GrappleReplay.csv");
+		}
+
+		FString Csv = CsvHeader;
+		if (!RunReplay(ReplayPath, SessionIndex, Csv))
+			return 1;
+
+		if (!FFileHelper::SaveStringToFile(Csv, *OutputPath))
+		{
+			UE_LOG(LogGrapple, Error, TEXT("Could not write %s"), *OutputPath);
+			return 1;
+		}
+
+		UE_LOG(LogGrapple, Display, TEXT("Per-frame timings written to %s"), *OutputPath);
+		return 0;
+	}
+
+	// The game mode's blueprinted character has the projectile class set up
+	TSubclassOf<AGrapplingHookTestCharacter> CharacterClass = *GetDefault<AGrapplingHookTestGameMode>()->DefaultPawnClass;
+	FString CharacterPath;
+	if (FParse::Value(*Params, TEXT("Character="), CharacterPath))
+	{
+		CharacterClass = LoadClass<AGrapplingHookTestCharacter>(nullptr, *CharacterPath);
+	}
+
+	if (CharacterClass == nullptr)
+	{
+		UE_LOG(LogGrapple, Error, TEXT("No grappling character class to benchmark, pass one with -Character="));
+		return 1;
+	}
+
+	if (FrameCount <= 0 || FramesPerSecond <= 0.f)
+	{
+		UE_LOG(LogGrapple, Error, TEXT("-Frames and -FPS must be positive"));
+		return 1;
+	}
+
+	const float DeltaTime = 1.f / FramesPerSecond;
+	const bool bSignificance = FParse::Param(*Params, TEXT("Significance"));
+	const bool bStripCosmetics = FParse::Param(*Params, TEXT("StripCosmetics"));
+	FString Csv = CsvHeader;
+
+	// Standalone worlds only save snapshots in mode 2, the rollbacks need them
+	int32 RollbackFrames = 0;
+	FParse::Value(*Params, TEXT("Rollback="), RollbackFrames);
+	RollbackFrames = FMath::Clamp(RollbackFrames, 0, 63);
+	if (RollbackFrames > 0)
+	{
+		IConsoleManager::Get().FindConsoleVariable(TEXT("grapple.Snapshots"))->Set(2, ECVF_SetByCommandline);
+	}
+
+	for (const FString& BotCountString : BotCountStrings)
+	{
+		const int32 BotCount = FCString::Atoi(*BotCountString);
+		if (BotCount <= 0)
+			continue;
+
+		FSweepResult Result = RunSweep(CharacterClass, BotCount, FrameCount, DeltaTime, Seed, false, false, RollbackFrames, Csv);
+		const double AverageMilliseconds = LogSweep(BotCount, TEXT(""), Result);
+
+		if (bSignificance)
+		{
+			FSweepResult SignificanceResult = RunSweep(CharacterClass, BotCount, FrameCount, DeltaTime, Seed, true, false, RollbackFrames, Csv);
+			const double SignificanceMilliseconds = LogSweep(BotCount, TEXT(" with significance"), SignificanceResult);
+			UE_LOG(LogGrapple, Display, TEXT("%5d bots: significance saves %.3f ms per frame (%.1f%%)"),
+				BotCount, AverageMilliseconds - SignificanceMilliseconds, 100.0 * (1.0 - SignificanceMilliseconds / FMath::Max(AverageMilliseconds, 1e-6)));
+		}
+
+		if (bStripCosmetics)
+		{
+			FSweepResult StrippedResult = RunSweep(CharacterClass, BotCount, FrameCount, DeltaTime, Seed, false, true, RollbackFrames, Csv);
+			const double StrippedMilliseconds = LogSweep(BotCount, TEXT(" stripped"), StrippedResult);
+			UE_LOG(LogGrapple, Display, TEXT("%5d bots: per bot %.2f us per frame and %.1f KB with cosmetics, %.2f us and %.1f KB stripped"),
+				BotCount,
+				AverageMilliseconds * 1000.0 / BotCount, Result.MemoryBytes / 1024.0 / BotCount,
+				StrippedMilliseconds * 1000.0 / BotCount, StrippedResult.MemoryBytes / 1024.0 / BotCount);
+		}
+	}
+
+	if (!FFileHelper::SaveStringToFile(Csv, *OutputPath))
+	{
+		UE_LOG(LogGrapple, Error, TEXT("Could not write %s"), *OutputPath);
+		return 1;
+	}
+
+	UE_LOG(LogGrapple, Display, TEXT("Per-frame timings written to %s"), *OutputPath);
+	return 0;
+}
@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "GrappleBenchmarkCommandlet.generated.h"
+
+/**
+ * Headless scaling benchmark of the grapple module.
+ * For every bot count of the sweep, spawns that many characters in a closed arena and drives them through
+ * fire, hook, swing and retract cycles for a fixed number of frames. Per-frame game thread time of the pendulum,
+ * swing, projectile and rope phases is written as CSV. The simulation time from the bots' shots to their hooks' first
+ * flight is logged, next to what a launch at the start of the frame would have taken.
+ *
+ * UE4Editor-Cmd GrapplingHookTest.uproject -run=GrappleBenchmark -nullrhi -unattended
+ *     [-Bots=1,10,100,1000,4000] [-Frames=600] [-FPS=60] [-Seed=0]
+ *     [-Character=/Game/FirstPersonCPP/Blueprints/FirstPersonCharacter.FirstPersonCharacter_C]
+ *     [-Output=Saved/Benchmarks/GrappleBenchmark.csv] [-SingleThreaded] [-Significance] [-StripCosmetics]
+ *     [-Rollback=8]
+ *
+ * -SingleThreaded sets grapple.Parallel to 0, the pendulum and rope phases then run on the game thread only.
+ * -Significance runs every bot count a second time seen from a corner of the arena, so far bots fall in the low
+ * significance buckets, and logs the per-frame saving. The CSV's Significance column tells the two runs apart.
+ * -StripCosmetics runs every bot count a second time as a dedicated server would, without ropes, fire sounds and
+ * animations, and logs what it saves per bot in frame time and used memory. The CSV's Stripped column marks that run.
+ * -Rollback rolls every bot still swinging after the last frame back that many frames through the subsystem's
+ * Resimulate, snapshots, hooks and all, and logs the cost of a rollback. It turns on the snapshots of grapple.Snapshots 2.
+ *
+ * With -Replay, plays a session recorded by grapple.Record.Start instead, as fast as the world ticks, and reports how
+ * far the replayed swings drift from the recorded ones. The same per-frame CSV is written.
+ *
+ * UE4Editor-Cmd GrapplingHookTest.uproject -run=GrappleBenchmark -nullrhi -unattended
+ *     -Replay=Saved/Recordings/Grapple.grpl [-Session=0] [-Output=Saved/Benchmarks/GrappleReplay.csv]
+ *
+ * With -Anchors, scatters that many grapple anchors, each with a collision sphere, and times the radius, cone and
+ * raycast queries of UGrappleAnchorSubsystem against the scene overlaps and traces that would answer them. Logs only.
+ *
+ * UE4Editor-Cmd GrapplingHookTest.uproject -run=GrappleBenchmark -nullrhi -unattended
+ *     -Anchors=1000,10000,100000 [-Queries=1000] [-Seed=0]
+ */
+UCLASS()
+class UGrappleBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UGrappleBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,162 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrappleCharacterMovementComponent.h"
+#include "GrappleSubsystem.h"
+#include "GrapplingHookTest.h"
+#include "GrapplingHookTestCharacter.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Swing Movement"), STAT_GrappleSwingMovement, STATGROUP_Grapple);
+
+void UGrappleCharacterMovementComponent::PhysCustom(float deltaTime, int32 Iterations)
+{
+	if (CustomMovementMode == static_cast<uint8>(EGrappleMovementMode::Swinging))
+	{
+		PhysSwinging(deltaTime, Iterations);
+		return;
+	}
+
+	Super::PhysCustom(deltaTime, Iterations);
+}
+
+void FSavedMove_Grapple::Clear()
+{
+	Super::Clear();
+
+	bStartSwinging = false;
+}
+
+void FSavedMove_Grapple::SetInitialPosition(ACharacter* Character)
+{
+	Super::SetInitialPosition(Character);
+
+	const UGrappleCharacterMovementComponent* Movement = Cast<UGrappleCharacterMovementComponent>(Character->GetCharacterMovement());
+	const AGrapplingHookTestCharacter* GrappleCharacter = Cast<AGrapplingHookTestCharacter>(Character);
+	bStartSwinging = Movement != nullptr && Movement->IsSwinging() && GrappleCharacter != nullptr
+		&& Character->GetWorld()->GetSubsystem<UGrappleSubsystem>()->SaveSwing(GrappleCharacter, StartSwing);
+}
+
+bool FSavedMove_Grapple::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	// Only moves of the same swing, the swing restored for the combined move has to be the one it steps
+	const FSavedMove_Grapple* NewGrappleMove = static_cast<const FSavedMove_Grapple*>(NewMove.Get());
+	if (bStartSwinging != NewGrappleMove->bStartSwinging)
+		return false;
+
+	if (bStartSwinging && !(StartSwing.Anchor == NewGrappleMove->StartSwing.Anchor && StartSwing.Length == NewGrappleMove->StartSwing.Length))
+		return false;
+
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_Grapple::CombineWith(const FSavedMove_Character* OldMove, ACharacter* InCharacter, APlayerController* PC, const FVector& OldStartLocation)
+{
+	Super::CombineWith(OldMove, InCharacter, PC, OldStartLocation);
+
+	// The character went back to where the old move started, its swing goes back with it
+	const FSavedMove_Grapple* OldGrappleMove = static_cast<const FSavedMove_Grapple*>(OldMove);
+	const AGrapplingHookTestCharacter* GrappleCharacter = Cast<AGrapplingHookTestCharacter>(InCharacter);
+	if (OldGrappleMove->bStartSwinging && GrappleCharacter != nullptr)
+	{
+		StartSwing = OldGrappleMove->StartSwing;
+		InCharacter->GetWorld()->GetSubsystem<UGrappleSubsystem>()->RestoreSwing(GrappleCharacter, StartSwing);
+	}
+}
+
+FVector UGrappleCharacterMovementComponent::ScaleInputAcceleration(const FVector& InputPulse) const
+{
+	// Steering is the input while swinging, the move takes it to the server and to its replays as its acceleration
+	const AGrapplingHookTestCharacter* GrappleCharacter = Cast<AGrapplingHookTestCharacter>(CharacterOwner);
+	if (IsSwinging() && GrappleCharacter != nullptr)
+		return GetWorld()->GetSubsystem<UGrappleSubsystem>()->GetSwingAcceleration(GrappleCharacter, GetMaxAcceleration());
+
+	return Super::ScaleInputAcceleration(InputPulse);
+}
+
+FNetworkPredictionData_Client* UGrappleCharacterMovementComponent::GetPredictionData_Client() const
+{
+	if (ClientPredictionData == nullptr)
+	{
+		UGrappleCharacterMovementComponent* MutableThis = const_cast<UGrappleCharacterMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_Grapple(*this);
+	}
+	return ClientPredictionData;
+}
+
+void UGrappleCharacterMovementComponent::OnClientCorrectionReceived(FNetworkPredictionData_Client_Character& ClientData, float TimeStamp, FVector NewLocation, FVector NewVelocity, UPrimitiveComponent* NewBase, FName NewBaseBoneName, bool bHasBase, bool bBaseRelativePosition, uint8 ServerMovementMode)
+{
+	Super::OnClientCorrectionReceived(ClientData, TimeStamp, NewLocation, NewVelocity, NewBase, NewBaseBoneName, bHasBase, bBaseRelativePosition, ServerMovementMode);
+
+	AGrapplingHookTestCharacter* GrappleCharacter = Cast<AGrapplingHookTestCharacter>(CharacterOwner);
+	if (GrappleCharacter == nullptr || !IsSwinging())
+		return;
+
+	// The moves the server has not run yet are replayed right after this, each one steps the pendulum again
+	GetWorld()->GetSubsystem<UGrappleSubsystem>()->ReconcileSwing(GrappleCharacter, NewLocation, NewVelocity);
+}
+
+void UGrappleCharacterMovementComponent::PhysSwinging(float deltaTime, int32 Iterations)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GrappleSwingMovement);
+	CSV_SCOPED_TIMING_STAT(Grapple, SwingMovement);
+
+	if (deltaTime < MIN_TICK_TIME)
+		return;
+
+	UGrappleSubsystem* GrappleSubsystem = GetWorld()->GetSubsystem<UGrappleSubsystem>();
+	FGrappleCycleScope SwingScope(GrappleSubsystem->GetFrameTimings().SwingCycles);
+
+	// The pendulum is stepped by exactly this move and steered by its acceleration, the server runs the same moves
+	AGrapplingHookTestCharacter* GrappleCharacter = Cast<AGrapplingHookTestCharacter>(CharacterOwner);
+	if (GrappleCharacter != nullptr)
+	{
+		GrappleSubsystem->StepSwing(GrappleCharacter, Acceleration, GetMaxAcceleration(), deltaTime);
+	}
+
+	FVector TargetLocation, TargetVelocity;
+	if (GrappleCharacter == nullptr || !GrappleSubsystem->GetSwingTarget(GrappleCharacter, TargetLocation, TargetVelocity))
+	{
+		// No rope to hang from, fall for the rest of the frame
+		SetMovementMode(MOVE_Falling);
+		StartNewPhysics(deltaTime, Iterations);
+		return;
+	}
+
+	const FVector StartLocation = UpdatedComponent->GetComponentLocation();
+	const FVector SwingDelta = TargetLocation - StartLocation;
+	float RemainingTime = deltaTime;
+	bool bBlocked = false;
+
+	while (RemainingTime >= MIN_TICK_TIME && Iterations < MaxSimulationIterations)
+	{
+		Iterations++;
+		const float TimeTick = GetSimulationTimeStep(RemainingTime, Iterations);
+		RemainingTime -= TimeTick;
+
+		// Each substep sweeps its share of the swing, from wherever the previous one stopped
+		const FVector SubstepTarget = StartLocation + SwingDelta * ((deltaTime - RemainingTime) / deltaTime);
+		const FVector Adjusted = SubstepTarget - UpdatedComponent->GetComponentLocation();
+
+		FHitResult Hit(1.f);
+		SafeMoveUpdatedComponent(Adjusted, UpdatedComponent->GetComponentQuat(), true, Hit);
+
+		if (Hit.IsValidBlockingHit())
+		{
+			bBlocked = true;
+			HandleImpact(Hit, TimeTick, Adjusted);
+			SlideAlongSurface(Adjusted, 1.f - Hit.Time, Hit.Normal, Hit, true);
+		}
+	}
+
+	if (!bBlocked)
+	{
+		Velocity = TargetVelocity;
+		return;
+	}
+
+	// Whatever blocked us stopped part of the swing, the pendulum continues from where the capsule ended up
+	const FVector EndLocation = UpdatedComponent->GetComponentLocation();
+	Velocity = (EndLocation - StartLocation) / deltaTime;
+	GrappleSubsystem->ConstrainSwing(GrappleCharacter, EndLocation, Velocity);
+}
@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "SphericalPendulumBatch.h"
+#include "GrappleCharacterMovementComponent.generated.h"
+
+/** Custom movement modes, the value of CustomMovementMode when the movement mode is MOVE_Custom */
+UENUM(BlueprintType)
+enum class EGrappleMovementMode : uint8
+{
+	Swinging
+};
+
+/**
+ * Saved move that remembers the swing it started from. A move combined into the next one steps the pendulum again
+ * with it, from there. Steering needs nothing more, it is the move's acceleration.
+ */
+class FSavedMove_Grapple : public FSavedMove_Character
+{
+public:
+	typedef FSavedMove_Character Super;
+
+	// FSavedMove_Character interface
+	virtual void Clear() override;
+	virtual void SetInitialPosition(ACharacter* Character) override;
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+	virtual void CombineWith(const FSavedMove_Character* OldMove, ACharacter* InCharacter, APlayerController* PC, const FVector& OldStartLocation) override;
+	// End of FSavedMove_Character interface
+
+	bool bStartSwinging = false;
+	GrappleCore::SphericalPendulumBatch::FSwingerState StartSwing;
+};
+
+class FNetworkPredictionData_Client_Grapple : public FNetworkPredictionData_Client_Character
+{
+public:
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_Grapple(const UCharacterMovementComponent& ClientMovement)
+		: Super(ClientMovement)
+	{
+	}
+
+	virtual FSavedMovePtr AllocateNewMove() override { return FSavedMovePtr(new FSavedMove_Grapple()); }
+};
+
+/**
+ * Character movement with a swinging mode.
+ * While swinging, each move steps the character's pendulum in the world's UGrappleSubsystem by the move's time and
+ * sweeps the capsule to where it ends, so it collides, replicates and gets predicted like any other movement mode.
+ * The steering input becomes the move's acceleration, so the server and the replayed moves steer with exactly what
+ * the owner did. Velocity is the swing velocity, letting go keeps it.
+ * An owning client corrected by the server restarts its pendulum from the correction, the pending moves it replays
+ * then step it again.
+ */
+UCLASS()
+class UGrappleCharacterMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	bool IsSwinging() const { return MovementMode == MOVE_Custom && CustomMovementMode == static_cast<uint8>(EGrappleMovementMode::Swinging); }
+
+protected:
+	// UCharacterMovementComponent interface
+	virtual void PhysCustom(float deltaTime, int32 Iterations) override;
+	virtual FVector ScaleInputAcceleration(const FVector& InputPulse) const override;
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+	virtual void OnClientCorrectionReceived(class FNetworkPredictionData_Client_Character& ClientData, float TimeStamp, FVector NewLocation, FVector NewVelocity, UPrimitiveComponent* NewBase, FName NewBaseBoneName, bool bHasBase, bool bBaseRelativePosition, uint8 ServerMovementMode) override;
+	// End of UCharacterMovementComponent interface
+
+private:
+	/**
+	 * Steps the pendulum by the move, then sweeps toward it once per substep. A blocked swing pushes the pendulum back
+	 * where the capsule stopped.
+	 */
+	void PhysSwinging(float deltaTime, int32 Iterations);
+};
@@ -0,0 +1,18 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GrappleCoreMath.h"
+
+/** Conversions between the engine math types and the engine-independent ones of the grapple core */
+
+FORCEINLINE GrappleCore::Vec3 ToGrappleCore(const FVector& Vector)
+{
+	return GrappleCore::Vec3(Vector.X, Vector.Y, Vector.Z);
+}
+
+FORCEINLINE FVector ToUnreal(const GrappleCore::Vec3& Vector)
+{
+	return FVector(Vector.X, Vector.Y, Vector.Z);
+}
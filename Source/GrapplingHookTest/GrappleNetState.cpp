@@ -0,0 +1,139 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrappleNetState.h"
+#include "GrappleCoreConversions.h"
+#include "GrapplingHookTest.h"
+#include "GrappleSubsystem.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/PackageMapClient.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Net State Bits Sent"), STAT_GrappleNetStateBits, STATGROUP_Grapple);
+
+namespace
+{
+	/** Both ends quantize with the same ranges */
+	const GrappleCore::SwingQuantizer Quantizer;
+
+	/** Bits a bit writer packs Value into with SerializeInt, it stops at the bits that cannot reach ValueMax */
+	int32 GetIntBits(uint32 Value, uint32 ValueMax)
+	{
+		Value = FMath::Min(Value, ValueMax - 1);
+		int32 Bits = 0;
+		uint32 Written = 0;
+		for (uint32 Mask = 1; Written + Mask < ValueMax && Mask; Mask *= 2, ++Bits)
+		{
+			Written |= Value & Mask;
+		}
+		return Bits;
+	}
+
+	/** Bits of a FVector_NetQuantize: the component size, then the three components at that size */
+	int32 GetQuantizedVectorBits(const FVector& Vector)
+	{
+		const int32 MaxBitsPerComponent = 20;
+		const int32 MaxComponent = FMath::RoundToInt(FMath::Min(Vector.GetAbsMax(), static_cast<float>(1 << MaxBitsPerComponent)));
+		const uint32 ComponentBits = FMath::Clamp<uint32>(FMath::CeilLogTwo(1 + MaxComponent), 1, MaxBitsPerComponent) - 1;
+		return GetIntBits(ComponentBits, MaxBitsPerComponent) + 3 * (ComponentBits + 2);
+	}
+
+	/** The subsystem of the world replicating through Map, null outside of a connection */
+	UGrappleSubsystem* GetSubsystem(UPackageMap* Map)
+	{
+		UPackageMapClient* PackageMap = Cast<UPackageMapClient>(Map);
+		UNetConnection* Connection = PackageMap != nullptr ? PackageMap->GetConnection() : nullptr;
+		UWorld* World = Connection != nullptr && Connection->Driver != nullptr ? Connection->Driver->GetWorld() : nullptr;
+		return World != nullptr ? World->GetSubsystem<UGrappleSubsystem>() : nullptr;
+	}
+}
+
+void FGrappleNetState::SetHookState(int32 Hook, ProjectileState State)
+{
+	check(Hook >= 0 && Hook < MaxHooks);
+	HookStates = static_cast<uint16>((HookStates & ~(3 << (2 * Hook))) | (static_cast<int32>(State) << (2 * Hook)));
+}
+
+void FGrappleNetState::SetHookCount(int32 Count)
+{
+	HookCount = static_cast<uint8>(FMath::Clamp(Count, 0, MaxHooks));
+
+	// Bits of dropped hooks would make equal states compare different
+	HookStates &= static_cast<uint16>((1 << (2 * HookCount)) - 1);
+}
+
+void FGrappleNetState::SetSwing(const FVector& Offset, const FVector& Velocity)
+{
+	Swing = Quantizer.Quantize(ToGrappleCore(Offset), ToGrappleCore(Velocity));
+}
+
+void FGrappleNetState::GetSwing(FVector& OutOffset, FVector& OutVelocity) const
+{
+	GrappleCore::Vec3 Offset, Velocity;
+	Quantizer.Dequantize(Swing, Offset, Velocity);
+	OutOffset = ToUnreal(Offset);
+	OutVelocity = ToUnreal(Velocity);
+}
+
+bool FGrappleNetState::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	uint32 Count = HookCount;
+	Ar.SerializeInt(Count, MaxHooks + 1);
+	if (Ar.IsLoading())
+	{
+		HookCount = static_cast<uint8>(Count);
+		HookStates = 0;
+	}
+	Ar.SerializeBits(&HookStates, 2 * HookCount);
+	Ar << InputId;
+
+	uint8 SwingingBit = bSwinging ? 1 : 0;
+	Ar.SerializeBits(&SwingingBit, 1);
+	bSwinging = SwingingBit != 0;
+
+	bOutSuccess = true;
+	if (bSwinging)
+	{
+		uint32 Hook = SwingHook;
+		Ar.SerializeInt(Hook, MaxHooks);
+		SwingHook = static_cast<uint8>(Hook);
+
+		Anchor.NetSerialize(Ar, Map, bOutSuccess);
+		Ar << Swing.DirectionX << Swing.DirectionY;
+		Ar << Swing.AngularVelocityX << Swing.AngularVelocityY;
+		Ar << Swing.Length;
+	}
+
+	if (Ar.IsSaving())
+	{
+		const int32 Bits = GetSerializedBits();
+		INC_DWORD_STAT_BY(STAT_GrappleNetStateBits, Bits);
+		if (UGrappleSubsystem* GrappleSubsystem = GetSubsystem(Map))
+		{
+			GrappleSubsystem->AddNetStateBits(Bits);
+		}
+	}
+	return true;
+}
+
+int32 FGrappleNetState::GetSerializedBits() const
+{
+	int32 Bits = GetIntBits(HookCount, MaxHooks + 1) + 2 * HookCount + 8 * sizeof(InputId) + 1;
+	if (bSwinging)
+	{
+		Bits += GetIntBits(SwingHook, MaxHooks) + GetQuantizedVectorBits(Anchor);
+		Bits += 8 * (sizeof(Swing.DirectionX) + sizeof(Swing.DirectionY) + sizeof(Swing.AngularVelocityX) + sizeof(Swing.AngularVelocityY) + sizeof(Swing.Length));
+	}
+	return Bits;
+}
+
+bool FGrappleNetState::operator==(const FGrappleNetState& Other) const
+{
+	if (HookCount != Other.HookCount || HookStates != Other.HookStates || InputId != Other.InputId || bSwinging != Other.bSwinging)
+		return false;
+
+	// Whatever is left in the swing fields when not swinging is never sent
+	return !bSwinging
+		|| (SwingHook == Other.SwingHook && Swing == Other.Swing
+			&& Anchor.Equals(Other.Anchor, 0.5f));
+}
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "SwingQuantizer.h"
+#include "GrapplingHookTestProjectile.h"
+#include "GrappleNetState.generated.h"
+
+/**
+ * Everything a client needs to rebuild a character's hooks, rope and swing, replicated instead of their transforms.
+ *
+ * Hook states take two bits each. The anchor and the swing only follow while the character swings: the anchor as a
+ * NetQuantize vector, the swing as a GrappleCore::SwingQuantizer state of ten bytes. Clients fly, retract and draw the
+ * hooks and step the pendulum themselves between updates.
+ *
+ * Comparison is on the quantized values, changes below the quantization step are never sent.
+ */
+USTRUCT()
+struct FGrappleNetState
+{
+	GENERATED_BODY()
+
+	/** Every hook a character can own, see GrappleCore::MaxHooksPerCharacter */
+	static const int32 MaxHooks = GrappleCore::MaxHooksPerCharacter;
+
+	ProjectileState GetHookState(int32 Hook) const { return static_cast<ProjectileState>((HookStates >> (2 * Hook)) & 3); }
+	void SetHookState(int32 Hook, ProjectileState State);
+	int32 GetHookCount() const { return HookCount; }
+	void SetHookCount(int32 Count);
+
+	/** Offset from the anchor and velocity of the swing, quantized on the way in */
+	void SetSwing(const FVector& Offset, const FVector& Velocity);
+	void GetSwing(FVector& OutOffset, FVector& OutVelocity) const;
+
+	/** Last fire or retract of the owning client the server applied, the owner keeps predicting the ones after it */
+	uint8 InputId = 0;
+
+	/** The anchor and the swing are valid */
+	bool bSwinging = false;
+	/** Index of the hook the character swings from */
+	uint8 SwingHook = 0;
+	FVector_NetQuantize Anchor = FVector::ZeroVector;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+	bool operator==(const FGrappleNetState& Other) const;
+
+	/** Bits NetSerialize writes for this state, counted from the fields so any archive can be written to */
+	int32 GetSerializedBits() const;
+
+private:
+	uint8 HookCount = 0;
+	uint16 HookStates = 0;
+	GrappleCore::SwingQuantizer::FQuantizedSwing Swing;
+};
+
+template<>
+struct TStructOpsTypeTraits<FGrappleNetState> : public TStructOpsTypeTraitsBase2<FGrappleNetState>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true,
+	};
+};
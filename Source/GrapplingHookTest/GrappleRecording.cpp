@@ -0,0 +1,663 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrappleRecording.h"
+#include "GrappleSubsystem.h"
+#include "GrapplingHookTest.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+using namespace GrappleRecording;
+
+namespace
+{
+	/** Buffered records are written once they reach this size, and when recording stops */
+	const int32 FlushThreshold = 64 * 1024;
+
+	/** LEB128: seven bits per byte, the high bit tells whether another byte follows */
+	void AppendVarUInt(TArray<uint8>& Bytes, uint32 Value)
+	{
+		while (Value >= 0x80)
+		{
+			Bytes.Add(static_cast<uint8>(Value | 0x80));
+			Value >>= 7;
+		}
+		Bytes.Add(static_cast<uint8>(Value));
+	}
+
+	bool IsSampleRecord(ERecordType Type)
+	{
+		return Type == ERecordType::CharacterSample || Type == ERecordType::HookSample || Type == ERecordType::PendulumSample;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FGrappleRecorder
+
+FGrappleRecorder::~FGrappleRecorder()
+{
+	Stop();
+}
+
+bool FGrappleRecorder::Start(const FString& Path, const FSessionHeader& Header)
+{
+	Stop();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Path));
+	FileHandle.Reset(PlatformFile.OpenWrite(*Path, true));
+	if (!FileHandle.IsValid())
+	{
+		UE_LOG(LogGrapple, Error, TEXT("Could not open %s for recording"), *Path);
+		return false;
+	}
+
+	// Channels start over with every session so each one can be read on its own
+	ActorIds.Reset();
+	Channels.Reset();
+	NextActorId = 1;
+	DeltaTimeChannel = 0;
+	BytesWritten = 0;
+
+	uint32 FixedTimeStepChannel = 0;
+	uint32 DampingChannel = 0;
+	uint32 PendulumTimeChannel = 0;
+	BeginRecord(ERecordType::SessionStart);
+	for (int32 Shift = 0; Shift < 32; Shift += 8)
+	{
+		WriteByte(static_cast<uint8>(Magic >> Shift));
+	}
+	WriteVarUInt(Version);
+	WriteString(Header.MapName);
+	WriteFloat(FixedTimeStepChannel, Header.FixedTimeStep);
+	WriteVarUInt(static_cast<uint32>(Header.MaxSubsteps));
+	WriteFloat(DampingChannel, Header.Damping);
+	WriteFloat(PendulumTimeChannel, Header.PendulumTime);
+	EndRecord();
+
+	Flush();
+	return true;
+}
+
+void FGrappleRecorder::Stop()
+{
+	if (!IsRecording())
+		return;
+
+	Flush();
+	FileHandle.Reset();
+}
+
+void FGrappleRecorder::RecordInput(const AGrapplingHookTestCharacter* Character, EInput Input)
+{
+	if (!IsRecording())
+		return;
+
+	const uint32 Id = GetActorId(Character);
+	BeginRecord(ERecordType::Input);
+	WriteVarUInt(Id);
+	WriteByte(static_cast<uint8>(Input));
+	EndRecord();
+}
+
+void FGrappleRecorder::RecordSwingInput(const AGrapplingHookTestCharacter* Character, float Forward, float Right)
+{
+	if (!IsRecording())
+		return;
+
+	const uint32 Id = GetActorId(Character);
+	FChannels& CharacterChannels = Channels.FindChecked(Id);
+	BeginRecord(ERecordType::SwingInput);
+	WriteVarUInt(Id);
+	WriteFloat(CharacterChannels.Bits[Channel_SwingInput], Forward);
+	WriteFloat(CharacterChannels.Bits[Channel_SwingInput + 1], Right);
+	EndRecord();
+}
+
+void FGrappleRecorder::RecordTransition(const AGrapplingHookTestCharacter* Character, CharacterState NewState)
+{
+	if (!IsRecording())
+		return;
+
+	const uint32 Id = GetActorId(Character);
+	BeginRecord(ERecordType::CharacterTransition);
+	WriteVarUInt(Id);
+	WriteByte(static_cast<uint8>(NewState));
+	EndRecord();
+}
+
+void FGrappleRecorder::RecordTransition(const AGrapplingHookTestProjectile* Hook, ProjectileState NewState)
+{
+	if (!IsRecording())
+		return;
+
+	const uint32 Id = GetActorId(Hook);
+	if (Id == 0)
+		return;
+
+	// Where the hook and its owner are decides the rope length and the swing a HOOKED transition starts
+	const AActor* Owner = Hook->GetOwner();
+	FChannels& HookChannels = Channels.FindChecked(Id);
+	BeginRecord(ERecordType::HookTransition);
+	WriteVarUInt(Id);
+	WriteByte(static_cast<uint8>(NewState));
+	WriteVector(HookChannels, Channel_Location, Hook->GetActorLocation());
+	WriteVector(HookChannels, Channel_OwnerLocation, Owner->GetActorLocation());
+	WriteVector(HookChannels, Channel_OwnerVelocity, Owner->GetVelocity());
+	EndRecord();
+}
+
+void FGrappleRecorder::RecordFrame(float DeltaTime)
+{
+	if (!IsRecording())
+		return;
+
+	BeginRecord(ERecordType::Frame);
+	WriteFloat(DeltaTimeChannel, DeltaTime);
+	EndRecord();
+
+	if (Buffer.Num() >= FlushThreshold)
+	{
+		Flush();
+	}
+}
+
+void FGrappleRecorder::RecordSample(const AGrapplingHookTestCharacter* Character)
+{
+	if (!IsRecording())
+		return;
+
+	const uint32 Id = GetActorId(Character);
+	FChannels& CharacterChannels = Channels.FindChecked(Id);
+	BeginRecord(ERecordType::CharacterSample);
+	WriteVarUInt(Id);
+	WriteVector(CharacterChannels, Channel_Location, Character->GetActorLocation());
+	WriteVector(CharacterChannels, Channel_Velocity, Character->GetVelocity());
+	WriteFloat(CharacterChannels.Bits[Channel_Yaw], Character->GetActorRotation().Yaw);
+	EndRecord();
+}
+
+void FGrappleRecorder::RecordSample(const AGrapplingHookTestProjectile* Hook)
+{
+	if (!IsRecording())
+		return;
+
+	const uint32 Id = GetActorId(Hook);
+	if (Id == 0)
+		return;
+
+	BeginRecord(ERecordType::HookSample);
+	WriteVarUInt(Id);
+	WriteVector(Channels.FindChecked(Id), Channel_Location, Hook->GetActorLocation());
+	EndRecord();
+}
+
+void FGrappleRecorder::RecordPendulumSample(const AGrapplingHookTestCharacter* Character, const FVector& Offset, const FVector& Velocity)
+{
+	if (!IsRecording())
+		return;
+
+	const uint32 Id = GetActorId(Character);
+	FChannels& CharacterChannels = Channels.FindChecked(Id);
+	BeginRecord(ERecordType::PendulumSample);
+	WriteVarUInt(Id);
+	WriteVector(CharacterChannels, Channel_SwingOffset, Offset);
+	WriteVector(CharacterChannels, Channel_SwingVelocity, Velocity);
+	EndRecord();
+}
+
+uint32 FGrappleRecorder::GetActorId(const AGrapplingHookTestCharacter* Character)
+{
+	// A destroyed character's address may be reused by a new one, the weak pointer tells them apart
+	const FActorEntry* Entry = ActorIds.Find(Character);
+	if (Entry != nullptr && Entry->Actor.Get() == Character)
+		return Entry->Id;
+
+	const uint32 Id = NextActorId++;
+	ActorIds.Add(Character, FActorEntry{ Id, Character, nullptr });
+	FChannels& CharacterChannels = Channels.Add(Id);
+
+	BeginRecord(ERecordType::CharacterAdded);
+	WriteVarUInt(Id);
+	WriteString(Character->GetClass()->GetPathName());
+	WriteVector(CharacterChannels, Channel_Location, Character->GetActorLocation());
+	WriteFloat(CharacterChannels.Bits[Channel_Yaw], Character->GetActorRotation().Yaw);
+	EndRecord();
+	return Id;
+}
+
+uint32 FGrappleRecorder::GetActorId(const AGrapplingHookTestProjectile* Hook)
+{
+	// Hooks are replayed through their owner, they are spawned by its BeginPlay
+	const AGrapplingHookTestCharacter* Owner = Cast<AGrapplingHookTestCharacter>(Hook->GetOwner());
+	if (Owner == nullptr)
+		return 0;
+
+	const FActorEntry* Entry = ActorIds.Find(Hook);
+	if (Entry != nullptr && Entry->Actor.Get() == Hook && Entry->Owner.Get() == Owner)
+		return Entry->Id;
+
+	const int32 HookIndex = Owner->GetHooks().IndexOfByKey(Hook);
+	if (HookIndex == INDEX_NONE)
+		return 0;
+
+	const uint32 OwnerId = GetActorId(Owner);
+	const uint32 Id = NextActorId++;
+	ActorIds.Add(Hook, FActorEntry{ Id, Hook, Owner });
+	Channels.Add(Id);
+
+	BeginRecord(ERecordType::HookAdded);
+	WriteVarUInt(Id);
+	WriteVarUInt(OwnerId);
+	WriteVarUInt(static_cast<uint32>(HookIndex));
+	EndRecord();
+	return Id;
+}
+
+void FGrappleRecorder::BeginRecord(ERecordType Type)
+{
+	PayloadType = Type;
+	Payload.Reset();
+}
+
+void FGrappleRecorder::EndRecord()
+{
+	Buffer.Add(static_cast<uint8>(PayloadType));
+	AppendVarUInt(Buffer, static_cast<uint32>(Payload.Num()));
+	Buffer.Append(Payload);
+}
+
+void FGrappleRecorder::WriteVarUInt(uint32 Value)
+{
+	AppendVarUInt(Payload, Value);
+}
+
+void FGrappleRecorder::WriteFloat(uint32& Channel, float Value)
+{
+	// Close floats share their sign, exponent and high mantissa bits, so the XOR is a small number
+	uint32 Bits;
+	FMemory::Memcpy(&Bits, &Value, sizeof(Bits));
+	WriteVarUInt(Bits ^ Channel);
+	Channel = Bits;
+}
+
+void FGrappleRecorder::WriteString(const FString& Value)
+{
+	FTCHARToUTF8 Utf8(*Value);
+	WriteVarUInt(static_cast<uint32>(Utf8.Length()));
+	Payload.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+}
+
+void FGrappleRecorder::WriteVector(FChannels& ActorChannels, int32 FirstChannel, const FVector& Value)
+{
+	WriteFloat(ActorChannels.Bits[FirstChannel], Value.X);
+	WriteFloat(ActorChannels.Bits[FirstChannel + 1], Value.Y);
+	WriteFloat(ActorChannels.Bits[FirstChannel + 2], Value.Z);
+}
+
+void FGrappleRecorder::Flush()
+{
+	if (Buffer.Num() == 0)
+		return;
+
+	if (!FileHandle->Write(Buffer.GetData(), Buffer.Num()))
+	{
+		UE_LOG(LogGrapple, Error, TEXT("Could not write the grapple recording, recording stopped"));
+		Buffer.Reset();
+		FileHandle.Reset();
+		return;
+	}
+	BytesWritten += Buffer.Num();
+	Buffer.Reset();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FGrappleReplay
+
+FGrappleReplay::FGrappleReplay(UWorld* InWorld)
+	: World(InWorld)
+{
+}
+
+bool FGrappleReplay::Load(const FString& Path, int32 SessionIndex)
+{
+	if (!FFileHelper::LoadFileToArray(Data, *Path))
+	{
+		UE_LOG(LogGrapple, Error, TEXT("Could not read %s"), *Path);
+		return false;
+	}
+
+	Offset = 0;
+	bError = false;
+	int32 Session = INDEX_NONE;
+	ERecordType Type;
+	int32 PayloadEnd;
+	while (ReadRecordHeader(Type, PayloadEnd))
+	{
+		if (Type == ERecordType::SessionStart && ++Session == SessionIndex)
+		{
+			uint32 FileMagic = 0;
+			for (int32 Shift = 0; Shift < 32; Shift += 8)
+			{
+				FileMagic |= static_cast<uint32>(ReadByte()) << Shift;
+			}
+			const uint32 FileVersion = ReadVarUInt();
+			if (bError || FileMagic != Magic || FileVersion != Version)
+			{
+				UE_LOG(LogGrapple, Error, TEXT("%s is not a grapple recording this build can read (version %u)"), *Path, FileVersion);
+				return false;
+			}
+
+			uint32 FixedTimeStepChannel = 0;
+			uint32 DampingChannel = 0;
+			uint32 PendulumTimeChannel = 0;
+			Header.MapName = ReadString();
+			Header.FixedTimeStep = ReadFloat(FixedTimeStepChannel);
+			Header.MaxSubsteps = static_cast<int32>(ReadVarUInt());
+			Header.Damping = ReadFloat(DampingChannel);
+			Header.PendulumTime = ReadFloat(PendulumTimeChannel);
+			Offset = PayloadEnd;
+			return !bError;
+		}
+		Offset = PayloadEnd;
+	}
+
+	UE_LOG(LogGrapple, Error, TEXT("%s has no session %d"), *Path, SessionIndex);
+	return false;
+}
+
+bool FGrappleReplay::BeginFrame(float& OutDeltaTime)
+{
+	ERecordType Type;
+	int32 PayloadEnd;
+	while (!bError && ReadRecordHeader(Type, PayloadEnd))
+	{
+		// The next session is not part of this one
+		if (Type == ERecordType::SessionStart)
+			return false;
+
+		if (Type == ERecordType::Frame)
+		{
+			OutDeltaTime = ReadFloat(DeltaTimeChannel);
+			Offset = PayloadEnd;
+			return !bError;
+		}
+
+		ApplyRecord(Type);
+		Offset = PayloadEnd;
+	}
+	return false;
+}
+
+void FGrappleReplay::EndFrame()
+{
+	ERecordType Type;
+	int32 PayloadEnd;
+	while (!bError && IsNextRecordSample() && ReadRecordHeader(Type, PayloadEnd))
+	{
+		ApplyRecord(Type);
+		Offset = PayloadEnd;
+	}
+}
+
+bool FGrappleReplay::ReadRecordHeader(ERecordType& OutType, int32& OutPayloadEnd)
+{
+	if (Offset >= Data.Num())
+		return false;
+
+	// Reads are bounded by the whole file until the payload size is known
+	RecordEnd = Data.Num();
+	OutType = static_cast<ERecordType>(ReadByte());
+	const uint32 PayloadSize = ReadVarUInt();
+
+	// A recording cut short by a crash ends with a partial record
+	if (bError || PayloadSize > static_cast<uint32>(Data.Num() - Offset))
+	{
+		UE_LOG(LogGrapple, Warning, TEXT("Grapple recording ends with a truncated record"));
+		bError = true;
+		return false;
+	}
+
+	RecordEnd = Offset + static_cast<int32>(PayloadSize);
+	OutPayloadEnd = RecordEnd;
+	return true;
+}
+
+bool FGrappleReplay::IsNextRecordSample() const
+{
+	return Offset < Data.Num() && IsSampleRecord(static_cast<ERecordType>(Data[Offset]));
+}
+
+void FGrappleReplay::ApplyRecord(ERecordType Type)
+{
+	UGrappleSubsystem* GrappleSubsystem = World->GetSubsystem<UGrappleSubsystem>();
+
+	switch (Type)
+	{
+	case ERecordType::CharacterAdded:
+	{
+		const uint32 Id = ReadVarUInt();
+		const FString ClassPath = ReadString();
+		FChannels& CharacterChannels = Channels.Add(Id);
+		const FVector Location = ReadVector(CharacterChannels, Channel_Location);
+		const float Yaw = ReadFloat(CharacterChannels.Bits[Channel_Yaw]);
+
+		UClass* CharacterClass = LoadClass<AGrapplingHookTestCharacter>(nullptr, *ClassPath);
+		if (CharacterClass == nullptr)
+		{
+			UE_LOG(LogGrapple, Warning, TEXT("Could not load recorded character class %s"), *ClassPath);
+			break;
+		}
+		if (!CharacterAssets.Contains(CharacterClass))
+		{
+			CharacterAssets.Add(CharacterClass, CharacterClass->GetDefaultObject<AGrapplingHookTestCharacter>()->LoadStreamedAssets());
+		}
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		AGrapplingHookTestCharacter* Character = World->SpawnActor<AGrapplingHookTestCharacter>(CharacterClass, Location, FRotator(0.f, Yaw, 0.f), SpawnParams);
+		if (Character != nullptr)
+		{
+			// Replayed characters have no controller, the movement component still has to run
+			Character->GetCharacterMovement()->bRunPhysicsWithNoController = true;
+			Characters.Add(Id, Character);
+			RecordedStates.Add(Id, Character->GetCharacterState());
+		}
+		break;
+	}
+	case ERecordType::HookAdded:
+	{
+		const uint32 Id = ReadVarUInt();
+		const uint32 OwnerId = ReadVarUInt();
+		const int32 HookIndex = static_cast<int32>(ReadVarUInt());
+		Channels.Add(Id);
+
+		const AGrapplingHookTestCharacter* Owner = Characters.FindRef(OwnerId);
+		if (Owner != nullptr && Owner->GetHooks().IsValidIndex(HookIndex))
+		{
+			Hooks.Add(Id, Owner->GetHooks()[HookIndex]);
+		}
+		break;
+	}
+	case ERecordType::Input:
+	{
+		AGrapplingHookTestCharacter* Character = Characters.FindRef(ReadVarUInt());
+		const EInput Input = static_cast<EInput>(ReadByte());
+		if (Character != nullptr)
+		{
+			if (Input == EInput::Fire)
+				Character->OnFire();
+			else if (Input == EInput::Retract)
+				Character->OnRetract();
+		}
+		break;
+	}
+	case ERecordType::SwingInput:
+	{
+		const uint32 Id = ReadVarUInt();
+		FChannels& CharacterChannels = Channels.FindOrAdd(Id);
+		const float Forward = ReadFloat(CharacterChannels.Bits[Channel_SwingInput]);
+		const float Right = ReadFloat(CharacterChannels.Bits[Channel_SwingInput + 1]);
+
+		AGrapplingHookTestCharacter* Character = Characters.FindRef(Id);
+		if (Character != nullptr)
+		{
+			Character->SetSwingInput(Forward, Right);
+		}
+		break;
+	}
+	case ERecordType::CharacterTransition:
+	{
+		// Characters follow their hooks and the movement component, the recorded state is only checked
+		const uint32 Id = ReadVarUInt();
+		RecordedStates.Add(Id, static_cast<CharacterState>(ReadByte()));
+		break;
+	}
+	case ERecordType::HookTransition:
+	{
+		const uint32 Id = ReadVarUInt();
+		const ProjectileState NewState = static_cast<ProjectileState>(ReadByte());
+		FChannels& HookChannels = Channels.FindOrAdd(Id);
+		const FVector Location = ReadVector(HookChannels, Channel_Location);
+		const FVector OwnerLocation = ReadVector(HookChannels, Channel_OwnerLocation);
+		const FVector OwnerVelocity = ReadVector(HookChannels, Channel_OwnerVelocity);
+
+		AGrapplingHookTestProjectile* Hook = Hooks.FindRef(Id);
+		if (Hook == nullptr)
+			break;
+
+		// A docked hook follows its dock
+		if (Hook->GetProjectileState() != ProjectileState::DOCKED)
+		{
+			Hook->SetActorLocation(Location);
+		}
+
+		AGrapplingHookTestCharacter* Owner = Cast<AGrapplingHookTestCharacter>(Hook->GetOwner());
+		if (Owner != nullptr && Owner->GetCharacterState() != CharacterState::SWINGING)
+		{
+			Owner->SetActorLocation(OwnerLocation);
+			Owner->GetCharacterMovement()->Velocity = OwnerVelocity;
+		}
+
+		Hook->ApplyReplayedState(NewState);
+		break;
+	}
+	case ERecordType::Frame:
+		ReadFloat(DeltaTimeChannel);
+		break;
+	case ERecordType::CharacterSample:
+	{
+		const uint32 Id = ReadVarUInt();
+		FChannels& CharacterChannels = Channels.FindOrAdd(Id);
+		const FVector Location = ReadVector(CharacterChannels, Channel_Location);
+		const FVector Velocity = ReadVector(CharacterChannels, Channel_Velocity);
+		const float Yaw = ReadFloat(CharacterChannels.Bits[Channel_Yaw]);
+
+		AGrapplingHookTestCharacter* Character = Characters.FindRef(Id);
+		if (Character == nullptr)
+			break;
+
+		// Without the level, grounded and jumping cannot be told apart, only swings are compared
+		const bool bRecordedSwinging = RecordedStates.FindRef(Id) == CharacterState::SWINGING;
+		const bool bSwinging = Character->GetCharacterState() == CharacterState::SWINGING;
+		if (bRecordedSwinging != bSwinging)
+		{
+			++StateMismatches;
+		}
+
+		if (!bSwinging)
+		{
+			Character->SetActorLocationAndRotation(Location, FRotator(0.f, Yaw, 0.f));
+			Character->GetCharacterMovement()->Velocity = Velocity;
+		}
+		break;
+	}
+	case ERecordType::HookSample:
+	{
+		const uint32 Id = ReadVarUInt();
+		const FVector Location = ReadVector(Channels.FindOrAdd(Id), Channel_Location);
+
+		AGrapplingHookTestProjectile* Hook = Hooks.FindRef(Id);
+		if (Hook != nullptr && (Hook->GetProjectileState() == ProjectileState::LAUNCHING || Hook->GetProjectileState() == ProjectileState::RETRACTING))
+		{
+			Hook->SetActorLocation(Location);
+		}
+		break;
+	}
+	case ERecordType::PendulumSample:
+	{
+		const uint32 Id = ReadVarUInt();
+		FChannels& CharacterChannels = Channels.FindOrAdd(Id);
+		const FVector RecordedOffset = ReadVector(CharacterChannels, Channel_SwingOffset);
+		ReadVector(CharacterChannels, Channel_SwingVelocity);
+
+		FVector SwingOffset, SwingVelocity;
+		const AGrapplingHookTestCharacter* Character = Characters.FindRef(Id);
+		if (Character != nullptr && GrappleSubsystem->GetSwingState(Character, SwingOffset, SwingVelocity))
+		{
+			MaxSwingError = FMath::Max(MaxSwingError, FVector::Dist(SwingOffset, RecordedOffset));
+		}
+		break;
+	}
+	default:
+		// Written by a newer build, the caller skips the payload
+		break;
+	}
+}
+
+uint8 FGrappleReplay::ReadByte()
+{
+	if (Offset >= RecordEnd)
+	{
+		bError = true;
+		return 0;
+	}
+	return Data[Offset++];
+}
+
+uint32 FGrappleReplay::ReadVarUInt()
+{
+	uint32 Value = 0;
+	for (int32 Shift = 0; Shift < 35; Shift += 7)
+	{
+		const uint8 Byte = ReadByte();
+		Value |= static_cast<uint32>(Byte & 0x7F) << Shift;
+		if ((Byte & 0x80) == 0)
+			break;
+	}
+	return Value;
+}
+
+float FGrappleReplay::ReadFloat(uint32& Channel)
+{
+	Channel ^= ReadVarUInt();
+	float Value;
+	FMemory::Memcpy(&Value, &Channel, sizeof(Value));
+	return Value;
+}
+
+FString FGrappleReplay::ReadString()
+{
+	const int32 Length = static_cast<int32>(ReadVarUInt());
+	if (bError || Length > RecordEnd - Offset)
+	{
+		bError = true;
+		return FString();
+	}
+
+	const FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Data.GetData() + Offset), Length);
+	Offset += Length;
+	return FString(Converted.Length(), Converted.Get());
+}
+
+FVector FGrappleReplay::ReadVector(FChannels& ActorChannels, int32 FirstChannel)
+{
+	FVector Value;
+	Value.X = ReadFloat(ActorChannels.Bits[FirstChannel]);
+	Value.Y = ReadFloat(ActorChannels.Bits[FirstChannel + 1]);
+	Value.Z = ReadFloat(ActorChannels.Bits[FirstChannel + 2]);
+	return Value;
+}
@@ -0,0 +1,200 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GrapplingHookTestCharacter.h"
+#include "GrapplingHookTestProjectile.h"
+
+class IFileHandle;
+class UWorld;
+
+/**
+ * Binary grapple session format.
+ *
+ * A file is an append-only sequence of records: a type byte, a varint payload size and the payload.
+ * Every session starts with a SessionStart record carrying the format version and the pendulum settings, several
+ * sessions can follow each other in one file. Readers skip the record types they do not know.
+ *
+ * Floats are delta encoded per channel: their bits are XORed with the previous value of the same channel and written
+ * as a varint. Unchanged values take one byte, slowly changing ones two or three, and nothing is lost.
+ *
+ * Records of one frame are the inputs and state transitions in the order they happened, then a Frame record with the
+ * delta time, then the samples taken once everything moved.
+ */
+namespace GrappleRecording
+{
+	const uint32 Magic = 0x4C505247; // "GRPL"
+	const uint32 Version = 2;
+
+	enum class ERecordType : uint8
+	{
+		SessionStart,
+		CharacterAdded,
+		HookAdded,
+		Input,
+		CharacterTransition,
+		HookTransition,
+		Frame,
+		CharacterSample,
+		HookSample,
+		PendulumSample,
+		SwingInput,
+	};
+
+	enum class EInput : uint8 { Fire, Retract };
+
+	/** Float channels of one actor, vectors take three consecutive channels */
+	enum EChannel
+	{
+		Channel_Location = 0,
+		Channel_Velocity = 3,
+		Channel_Yaw = 6,
+		Channel_SwingOffset = 7,
+		Channel_SwingVelocity = 10,
+		Channel_SwingInput = 13,
+		Channel_OwnerLocation = 15,
+		Channel_OwnerVelocity = 18,
+		NumChannels = 21
+	};
+
+	/** Last bits written or read on every channel of one actor */
+	struct FChannels
+	{
+		uint32 Bits[NumChannels] = {};
+	};
+
+	/** Everything the pendulums need to step the same way as when the session was recorded */
+	struct FSessionHeader
+	{
+		FString MapName;
+		float FixedTimeStep = 0.f;
+		int32 MaxSubsteps = 0;
+		float Damping = 1.f;
+		/** Time left over from the last fixed pendulum step */
+		float PendulumTime = 0.f;
+	};
+}
+
+/**
+ * Streams a grapple session to disk, fed by the grapple subsystem and the actors.
+ * Every call does nothing while not recording.
+ */
+class FGrappleRecorder
+{
+public:
+	~FGrappleRecorder();
+
+	/** Appends a new session to Path, creating the file if needed */
+	bool Start(const FString& Path, const GrappleRecording::FSessionHeader& Header);
+	void Stop();
+	bool IsRecording() const { return FileHandle.IsValid(); }
+
+	void RecordInput(const AGrapplingHookTestCharacter* Character, GrappleRecording::EInput Input);
+	/** Steering of a swinging character, call when it changes */
+	void RecordSwingInput(const AGrapplingHookTestCharacter* Character, float Forward, float Right);
+	/** Call before the transition runs, the state it starts from is recorded with it */
+	void RecordTransition(const AGrapplingHookTestCharacter* Character, CharacterState NewState);
+	void RecordTransition(const AGrapplingHookTestProjectile* Hook, ProjectileState NewState);
+
+	/** Ends the current frame, the samples recorded until the next frame belong to it */
+	void RecordFrame(float DeltaTime);
+	void RecordSample(const AGrapplingHookTestCharacter* Character);
+	void RecordSample(const AGrapplingHookTestProjectile* Hook);
+	/** Swing state relative to the anchor, at the last fixed pendulum step */
+	void RecordPendulumSample(const AGrapplingHookTestCharacter* Character, const FVector& Offset, const FVector& Velocity);
+
+	uint64 GetBytesWritten() const { return BytesWritten; }
+
+private:
+	struct FActorEntry
+	{
+		uint32 Id;
+		TWeakObjectPtr<const AActor> Actor;
+		/** A pooled hook gets a new id when another character acquires it */
+		TWeakObjectPtr<const AActor> Owner;
+	};
+
+	/** Returns 0 for hooks without an owning character, they cannot be replayed */
+	uint32 GetActorId(const AGrapplingHookTestCharacter* Character);
+	uint32 GetActorId(const AGrapplingHookTestProjectile* Hook);
+
+	void BeginRecord(GrappleRecording::ERecordType Type);
+	void EndRecord();
+	void WriteByte(uint8 Value) { Payload.Add(Value); }
+	void WriteVarUInt(uint32 Value);
+	void WriteFloat(uint32& Channel, float Value);
+	void WriteString(const FString& Value);
+	void WriteVector(GrappleRecording::FChannels& Channels, int32 FirstChannel, const FVector& Value);
+	void Flush();
+
+	TUniquePtr<IFileHandle> FileHandle;
+	/** Records waiting to be written */
+	TArray<uint8> Buffer;
+	/** Payload of the record being built */
+	TArray<uint8> Payload;
+	GrappleRecording::ERecordType PayloadType = GrappleRecording::ERecordType::SessionStart;
+
+	TMap<const AActor*, FActorEntry> ActorIds;
+	TMap<uint32, GrappleRecording::FChannels> Channels;
+	uint32 NextActorId = 1;
+	uint32 DeltaTimeChannel = 0;
+	uint64 BytesWritten = 0;
+};
+
+/**
+ * Plays a recorded session back into freshly spawned characters.
+ * Inputs go through the characters like player input did. Hook transitions are forced from the file, the replay world
+ * has no level for the hooks to hit, and the hook and its owner are put back where they were when it happened.
+ * Characters and flying hooks follow their recorded samples; swings are simulated again and compared with the
+ * recorded pendulums, which is the part that has to be deterministic.
+ */
+class FGrappleReplay
+{
+public:
+	explicit FGrappleReplay(UWorld* InWorld);
+
+	/** Reads the SessionIndex-th session of the file at Path */
+	bool Load(const FString& Path, int32 SessionIndex = 0);
+	const GrappleRecording::FSessionHeader& GetHeader() const { return Header; }
+
+	/** Applies the records of the next frame up to its Frame record. Returns false at the end of the session. */
+	bool BeginFrame(float& OutDeltaTime);
+	/** Applies the samples of that frame, call once the world ticked */
+	void EndFrame();
+
+	int32 GetCharacterCount() const { return Characters.Num(); }
+	/** Largest distance between a replayed and a recorded swinger, in cm */
+	float GetMaxSwingError() const { return MaxSwingError; }
+	/** Samples where a character was swinging in only one of the recording and the replay */
+	int32 GetStateMismatches() const { return StateMismatches; }
+
+private:
+	bool ReadRecordHeader(GrappleRecording::ERecordType& OutType, int32& OutPayloadEnd);
+	bool IsNextRecordSample() const;
+	void ApplyRecord(GrappleRecording::ERecordType Type);
+
+	uint8 ReadByte();
+	uint32 ReadVarUInt();
+	float ReadFloat(uint32& Channel);
+	FString ReadString();
+	FVector ReadVector(GrappleRecording::FChannels& Channels, int32 FirstChannel);
+
+	UWorld* World;
+	TArray<uint8> Data;
+	int32 Offset = 0;
+	int32 RecordEnd = 0;
+	bool bError = false;
+
+	GrappleRecording::FSessionHeader Header;
+	TMap<uint32, AGrapplingHookTestCharacter*> Characters;
+	/** Assets of the replayed character classes, loaded up front so recorded shots are not lost to streaming */
+	TMap<UClass*, TSharedPtr<FStreamableHandle>> CharacterAssets;
+	TMap<uint32, AGrapplingHookTestProjectile*> Hooks;
+	TMap<uint32, CharacterState> RecordedStates;
+	TMap<uint32, GrappleRecording::FChannels> Channels;
+	uint32 DeltaTimeChannel = 0;
+
+	float MaxSwingError = 0.f;
+	int32 StateMismatches = 0;
+};
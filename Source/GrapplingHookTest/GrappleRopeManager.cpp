@@ -0,0 +1,227 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrappleRopeManager.h"
+#include "GrapplingHookTest.h"
+#include "GrappleCoreConversions.h"
+#include "GrappleSubsystem.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "UObject/UObjectIterator.h"
+
+DECLARE_CYCLE_STAT(TEXT("Rope Instance Flush"), STAT_GrappleRopeFlush, STATGROUP_Grapple);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active Ropes"), STAT_GrappleActiveRopes, STATGROUP_Grapple);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Rope Instances"), STAT_GrappleRopeInstances, STATGROUP_Grapple);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Rope Updates Applied"), STAT_GrappleRopeUpdatesApplied, STATGROUP_Grapple);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Rope Updates Skipped"), STAT_GrappleRopeUpdatesSkipped, STATGROUP_Grapple);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Rope Instances Flushed"), STAT_GrappleRopeInstancesFlushed, STATGROUP_Grapple);
+
+namespace
+{
+	const FTransform CollapsedInstance(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+
+	void DumpRopeStats(UWorld* World)
+	{
+		int32 MeshComponents = 0;
+		for (TObjectIterator<UStaticMeshComponent> It; It; ++It)
+		{
+			if (It->GetWorld() == World && It->IsRegistered())
+				++MeshComponents;
+		}
+
+		const UGrappleSubsystem* GrappleSubsystem = World->GetSubsystem<UGrappleSubsystem>();
+		const AGrappleRopeManager* RopeManager = GrappleSubsystem != nullptr ? GrappleSubsystem->FindRopeManager() : nullptr;
+
+		UE_LOG(LogGrapple, Display, TEXT("Static mesh components: %d, active ropes: %d, average rope transform flush: %.4f ms, rope updates applied: %llu, skipped: %llu"),
+			MeshComponents,
+			RopeManager != nullptr ? RopeManager->GetActiveRopeCount() : 0,
+			RopeManager != nullptr ? RopeManager->GetAverageFlushMilliseconds() : 0.0,
+			RopeManager != nullptr ? RopeManager->GetAppliedUpdateCount() : 0ull,
+			RopeManager != nullptr ? RopeManager->GetSkippedUpdateCount() : 0ull);
+	}
+
+	FAutoConsoleCommandWithWorld GRopeStatsCommand(
+		TEXT("grapple.RopeStats"),
+		TEXT("Logs the number of registered static mesh components in the world and the rope manager's transform update cost."),
+		FConsoleCommandWithWorldDelegate::CreateStatic(&DumpRopeStats));
+}
+
+AGrappleRopeManager::AGrappleRopeManager()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	// Ropes that tick on their own wrote their segments by then, the subsystem flushes its batched ropes itself
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
+	RopeInstances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("RopeInstances"));
+	RopeInstances->SetMobility(EComponentMobility::Movable);
+	RopeInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	RootComponent = RopeInstances;
+}
+
+void AGrappleRopeManager::SetRopeMesh(UStaticMesh* RopeMesh)
+{
+	if (RopeMesh == nullptr)
+		return;
+
+	RopeInstances->SetStaticMesh(RopeMesh);
+
+	const FBox Bounds = RopeMesh->GetBoundingBox();
+	MeshExtent = Bounds.GetExtent();
+	MeshBottom = Bounds.Min.Z;
+}
+
+int32 AGrappleRopeManager::RegisterRope(UStaticMesh* RopeMesh)
+{
+	if (RopeInstances->GetStaticMesh() == nullptr)
+	{
+		SetRopeMesh(RopeMesh);
+	}
+
+	int32 RopeId;
+	if (FreeBlocks.Num() > 0)
+	{
+		RopeId = FreeBlocks.Pop(false);
+	}
+	else
+	{
+		RopeId = InstanceTransforms.Num() / MaxSegmentsPerRope;
+		for (int32 Segment = 0; Segment < MaxSegmentsPerRope; ++Segment)
+		{
+			InstanceTransforms.Add(CollapsedInstance);
+			RopeInstances->AddInstance(CollapsedInstance);
+		}
+		DirtyBlocks.Add(false);
+		INC_DWORD_STAT_BY(STAT_GrappleRopeInstances, MaxSegmentsPerRope);
+	}
+
+	++ActiveRopes;
+	INC_DWORD_STAT(STAT_GrappleActiveRopes);
+	return RopeId;
+}
+
+void AGrappleRopeManager::UnregisterRope(int32 RopeId)
+{
+	if (RopeId == INDEX_NONE)
+		return;
+
+	CollapseBlock(RopeId);
+	FreeBlocks.Add(RopeId);
+
+	--ActiveRopes;
+	DEC_DWORD_STAT(STAT_GrappleActiveRopes);
+}
+
+void AGrappleRopeManager::CollapseBlock(int32 RopeId)
+{
+	FTransform* Block = InstanceTransforms.GetData() + RopeId * MaxSegmentsPerRope;
+	for (int32 Segment = 0; Segment < MaxSegmentsPerRope; ++Segment)
+	{
+		Block[Segment] = CollapsedInstance;
+	}
+	MarkBlockDirty(RopeId);
+}
+
+void AGrappleRopeManager::MarkBlockDirty(int32 RopeId)
+{
+	DirtyBlocks[RopeId] = true;
+	bInstancesDirty = true;
+}
+
+void AGrappleRopeManager::UpdateRope(int32 RopeId, const GrappleCore::Vec3* RopePoints, int32 NumPoints, float RopeDiameter)
+{
+	const int32 BlockStart = RopeId * MaxSegmentsPerRope;
+	if (MeshExtent.Z <= KINDA_SMALL_NUMBER || !InstanceTransforms.IsValidIndex(BlockStart))
+		return;
+
+	FTransform* Block = InstanceTransforms.GetData() + BlockStart;
+	const int32 SegmentCount = FMath::Clamp(NumPoints - 1, 0, MaxSegmentsPerRope);
+	const float ScaleX = RopeDiameter / MeshExtent.X;
+	const float ScaleY = RopeDiameter / MeshExtent.Y;
+
+	// The mesh is stretched along its Z axis, one combined transform per segment
+	for (int32 Segment = 0; Segment < SegmentCount; ++Segment)
+	{
+		const FVector SegmentStart = ToUnreal(RopePoints[Segment]);
+		const FVector SegmentVector = ToUnreal(RopePoints[Segment + 1]) - SegmentStart;
+		const FQuat Rotation = FRotationMatrix::MakeFromZ(SegmentVector).ToQuat();
+		const float ScaleZ = (SegmentVector.Size() / 2) / MeshExtent.Z;
+
+		// Put the bottom of the mesh on the segment start, whatever the mesh pivot is
+		const FVector Location = SegmentStart - Rotation.RotateVector(FVector(0.f, 0.f, MeshBottom * ScaleZ));
+		Block[Segment] = FTransform(Rotation, Location, FVector(ScaleX, ScaleY, ScaleZ));
+	}
+
+	for (int32 Segment = SegmentCount; Segment < MaxSegmentsPerRope; ++Segment)
+	{
+		Block[Segment] = CollapsedInstance;
+	}
+
+	MarkBlockDirty(RopeId);
+	++AppliedUpdates;
+	INC_DWORD_STAT(STAT_GrappleRopeUpdatesApplied);
+	CSV_CUSTOM_STAT(Grapple, RopeUpdatesApplied, 1, ECsvCustomStatOp::Accumulate);
+}
+
+void AGrappleRopeManager::SkipRopeUpdate(int32 RopeId)
+{
+	++SkippedUpdates;
+	INC_DWORD_STAT(STAT_GrappleRopeUpdatesSkipped);
+	CSV_CUSTOM_STAT(Grapple, RopeUpdatesSkipped, 1, ECsvCustomStatOp::Accumulate);
+}
+
+void AGrappleRopeManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	FlushInstances();
+}
+
+void AGrappleRopeManager::FlushInstances()
+{
+	if (!bInstancesDirty)
+		return;
+
+	SCOPE_CYCLE_COUNTER(STAT_GrappleRopeFlush);
+	CSV_SCOPED_TIMING_STAT(Grapple, RopeFlush);
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	// Runs of consecutive dirty blocks go up together, the render state is rebuilt once for all of them
+	int32 RunStart = INDEX_NONE;
+	for (int32 RopeId = 0; RopeId <= DirtyBlocks.Num(); ++RopeId)
+	{
+		const bool bDirty = RopeId < DirtyBlocks.Num() && DirtyBlocks[RopeId];
+		if (bDirty && RunStart == INDEX_NONE)
+		{
+			RunStart = RopeId;
+		}
+		else if (!bDirty && RunStart != INDEX_NONE)
+		{
+			FlushBlocks(RunStart, RopeId - RunStart);
+			RunStart = INDEX_NONE;
+		}
+	}
+	RopeInstances->MarkRenderStateDirty();
+	DirtyBlocks.SetRange(0, DirtyBlocks.Num(), false);
+	bInstancesDirty = false;
+
+	FlushCycles += FPlatformTime::Cycles64() - StartCycles;
+	++FlushCount;
+}
+
+void AGrappleRopeManager::FlushBlocks(int32 FirstRopeId, int32 BlockCount)
+{
+	const int32 FirstInstance = FirstRopeId * MaxSegmentsPerRope;
+	const int32 InstanceCount = BlockCount * MaxSegmentsPerRope;
+	FlushTransforms.Reset(InstanceCount);
+	FlushTransforms.Append(InstanceTransforms.GetData() + FirstInstance, InstanceCount);
+	RopeInstances->BatchUpdateInstancesTransforms(FirstInstance, FlushTransforms, false, false, true);
+
+	INC_DWORD_STAT_BY(STAT_GrappleRopeInstancesFlushed, InstanceCount);
+	CSV_CUSTOM_STAT(Grapple, RopeInstancesFlushed, InstanceCount, ECsvCustomStatOp::Accumulate);
+}
+
+double AGrappleRopeManager::GetAverageFlushMilliseconds() const
+{
+	return FlushCount > 0 ? FPlatformTime::ToMilliseconds64(FlushCycles) / FlushCount : 0.0;
+}
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "GrappleCoreMath.h"
+#include "GrappleRopeManager.generated.h"
+
+/**
+ * Renders every active rope of a world as instances of a single instanced static mesh.
+ * Each rope owns a fixed block of MaxSegmentsPerRope instances, unused instances are collapsed to zero scale.
+ * Ropes write their segments during their own tick, or in the grapple subsystem's batch, and the instances are flushed
+ * to the component at the end of the frame: in the manager's tick for the former, after the batch for the latter.
+ * Only the blocks written since the last flush are pushed, ropes at rest cost nothing.
+ */
+UCLASS(config = Game, notplaceable, Transient)
+class AGrappleRopeManager : public AActor
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleDefaultsOnly, Category = Rope)
+	class UInstancedStaticMeshComponent* RopeInstances;
+
+public:
+	AGrappleRopeManager();
+
+	/** Upper bound of segments a single rope can draw */
+	UPROPERTY(Config)
+	int32 MaxSegmentsPerRope = 16;
+
+	/** Reserves a block of instances for a rope. The first registered mesh is used for every rope. */
+	int32 RegisterRope(class UStaticMesh* RopeMesh);
+	void UnregisterRope(int32 RopeId);
+
+	/** Writes one combined transform per segment of the polyline RopePoints into the rope's block */
+	void UpdateRope(int32 RopeId, const GrappleCore::Vec3* RopePoints, int32 NumPoints, float RopeDiameter);
+	/** Records that a rope did not move enough to be worth rewriting, its instances keep last frame's transforms */
+	void SkipRopeUpdate(int32 RopeId);
+
+	virtual void Tick(float DeltaTime) override;
+	/**
+	 * Pushes the blocks written since the last flush to the component, one batch per run of consecutive blocks. Called
+	 * by Tick for ropes that update in their own actor tick, and by the grapple subsystem once its batched ropes are written.
+	 */
+	void FlushInstances();
+
+	int32 GetActiveRopeCount() const { return ActiveRopes; }
+	/** Average time spent pushing instance transforms to the component, in milliseconds */
+	double GetAverageFlushMilliseconds() const;
+	uint64 GetTotalFlushCycles() const { return FlushCycles; }
+	uint64 GetAppliedUpdateCount() const { return AppliedUpdates; }
+	uint64 GetSkippedUpdateCount() const { return SkippedUpdates; }
+
+private:
+	void SetRopeMesh(class UStaticMesh* RopeMesh);
+	void CollapseBlock(int32 RopeId);
+	void MarkBlockDirty(int32 RopeId);
+	void FlushBlocks(int32 FirstRopeId, int32 BlockCount);
+
+	/** World space transforms of every instance */
+	TArray<FTransform> InstanceTransforms;
+	/** Blocks written since the last flush, one bit per rope block */
+	TBitArray<> DirtyBlocks;
+	/** Copy of one run of dirty blocks, the component takes whole arrays */
+	TArray<FTransform> FlushTransforms;
+	TArray<int32> FreeBlocks;
+	int32 ActiveRopes = 0;
+	bool bInstancesDirty = false;
+
+	// Cached once when the mesh is set
+	FVector MeshExtent = FVector::ZeroVector;
+	float MeshBottom = 0.f;
+
+	uint64 FlushCycles = 0;
+	uint32 FlushCount = 0;
+	uint64 AppliedUpdates = 0;
+	uint64 SkippedUpdates = 0;
+};
@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Where an actor sits in a TGrappleStateLists, kept on the actor so moves are O(1) */
+struct FGrappleListLink
+{
+	int32 State = INDEX_NONE;
+	int32 Index = INDEX_NONE;
+
+	bool IsLinked() const { return State != INDEX_NONE; }
+};
+
+/**
+ * Dense per-state lists of actors, so a batched update can run one tight loop per state.
+ * ActorType must expose an FGrappleListLink named GrappleListLink.
+ * Changes requested while a list is being iterated are deferred until EndIteration.
+ */
+template <typename ActorType, typename StateType, int32 NumStates>
+class TGrappleStateLists
+{
+public:
+	void Add(ActorType* Actor, StateType State) { Set(Actor, static_cast<int32>(State)); }
+	/** Moves a listed actor, or one whose add is still deferred, and ignores any other */
+	void Move(ActorType* Actor, StateType State) { if (IsListed(Actor)) Set(Actor, static_cast<int32>(State)); }
+	void Remove(ActorType* Actor) { Set(Actor, INDEX_NONE); }
+
+	const TArray<ActorType*>& Get(StateType State) const { return Lists[static_cast<int32>(State)]; }
+
+	int32 Num() const
+	{
+		int32 Count = 0;
+		for (const TArray<ActorType*>& List : Lists)
+		{
+			Count += List.Num();
+		}
+		return Count;
+	}
+
+	template <typename FunctionType>
+	void ForEach(FunctionType Function) const
+	{
+		for (const TArray<ActorType*>& List : Lists)
+		{
+			for (ActorType* Actor : List)
+			{
+				Function(Actor);
+			}
+		}
+	}
+
+	void BeginIteration() { bIterating = true; }
+
+	void EndIteration()
+	{
+		bIterating = false;
+		for (const FPendingChange& Change : PendingChanges)
+		{
+			Apply(Change.Actor, Change.State);
+		}
+		PendingChanges.Reset();
+	}
+
+private:
+	struct FPendingChange
+	{
+		ActorType* Actor;
+		int32 State;
+	};
+
+	/** Listed once the deferred changes are applied, the last deferred change of Actor wins over its link */
+	bool IsListed(const ActorType* Actor) const
+	{
+		const int32 ChangeIndex = PendingChanges.FindLastByPredicate([Actor](const FPendingChange& Change) { return Change.Actor == Actor; });
+		return ChangeIndex != INDEX_NONE ? PendingChanges[ChangeIndex].State != INDEX_NONE : Actor->GrappleListLink.IsLinked();
+	}
+
+	void Set(ActorType* Actor, int32 State)
+	{
+		if (bIterating)
+		{
+			PendingChanges.Add({ Actor, State });
+		}
+		else
+		{
+			Apply(Actor, State);
+		}
+	}
+
+	void Apply(ActorType* Actor, int32 State)
+	{
+		FGrappleListLink& Link = Actor->GrappleListLink;
+		if (Link.State == State)
+			return;
+
+		// Unlink, the last actor of the list takes the hole
+		if (Link.IsLinked())
+		{
+			TArray<ActorType*>& OldList = Lists[Link.State];
+			OldList.RemoveAtSwap(Link.Index, 1, false);
+			if (OldList.IsValidIndex(Link.Index))
+			{
+				OldList[Link.Index]->GrappleListLink.Index = Link.Index;
+			}
+			Link = FGrappleListLink();
+		}
+
+		if (State != INDEX_NONE)
+		{
+			Link.State = State;
+			Link.Index = Lists[State].Add(Actor);
+		}
+	}
+
+	TArray<ActorType*> Lists[NumStates];
+	TArray<FPendingChange> PendingChanges;
+	bool bIterating = false;
+};
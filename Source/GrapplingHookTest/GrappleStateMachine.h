@@ -0,0 +1,186 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Counters kept for every state of a TGrappleStateMachine */
+struct FGrappleStateTimings
+{
+	uint32 EnterCount = 0;
+	uint32 UpdateCount = 0;
+	/** Game time spent in the state, summed from the update delta times, in seconds */
+	float TimeInState = 0.f;
+	/** CPU cycles spent in the state's enter, update and exit handlers */
+	uint64 Cycles = 0;
+
+	double GetMilliseconds() const { return FPlatformTime::ToMilliseconds64(Cycles); }
+
+	FGrappleStateTimings& operator+=(const FGrappleStateTimings& Other)
+	{
+		EnterCount += Other.EnterCount;
+		UpdateCount += Other.UpdateCount;
+		TimeInState += Other.TimeInState;
+		Cycles += Other.Cycles;
+		return *this;
+	}
+};
+
+/**
+ * Binds the handlers of one state, any of them may be left out.
+ * The member functions are template arguments so every call is resolved at compile time.
+ */
+template <typename StateType, StateType InState, typename OwnerType,
+	void (OwnerType::*EnterFunction)() = nullptr,
+	void (OwnerType::*UpdateFunction)(float) = nullptr,
+	void (OwnerType::*ExitFunction)() = nullptr>
+struct TGrappleState
+{
+	static constexpr StateType GetState() { return InState; }
+	static constexpr bool HasUpdate() { return UpdateFunction != nullptr; }
+
+	static void Enter(OwnerType& Owner) { if (EnterFunction != nullptr) (Owner.*EnterFunction)(); }
+	static void Update(OwnerType& Owner, float DeltaTime) { if (UpdateFunction != nullptr) (Owner.*UpdateFunction)(DeltaTime); }
+	static void Exit(OwnerType& Owner) { if (ExitFunction != nullptr) (Owner.*ExitFunction)(); }
+};
+
+/**
+ * State machine whose dispatch tables are generated from a list of TGrappleState, one per value of StateType in enum order.
+ * Transitions run the exit and enter handlers right away, so a state entered during a frame is live in that same frame.
+ * Transitions requested from an enter or exit handler are chained within the same SetState call.
+ */
+template <typename OwnerType, typename StateType, typename... States>
+class TGrappleStateMachine
+{
+public:
+	static const int32 NumStates = sizeof...(States);
+
+	explicit TGrappleStateMachine(StateType InitialState)
+		: CurrentState(InitialState)
+	{
+		static_assert(AreStatesInOrder(), "States must be listed in the order of StateType, one per value");
+	}
+
+	StateType GetState() const { return CurrentState; }
+
+	/** Enters State without leaving the current state, for the first entry */
+	void Start(OwnerType& Owner, StateType State) { Transition(Owner, State, false); }
+
+	/** Leaves the current state and enters State */
+	void SetState(OwnerType& Owner, StateType State) { Transition(Owner, State, true); }
+
+	/** Switches to State without running any handler */
+	void Reset(StateType State) { CurrentState = State; }
+
+	/** Whether State has an update handler, owners do not need to tick in the other states */
+	static bool HasUpdate(StateType State)
+	{
+		static const bool UpdateTable[] = { States::HasUpdate()... };
+		return UpdateTable[static_cast<int32>(State)];
+	}
+
+	/** Runs the update handler of the current state */
+	void Update(OwnerType& Owner, float DeltaTime)
+	{
+		static const FUpdateFunction UpdateTable[] = { &States::Update... };
+
+		const int32 StateIndex = static_cast<int32>(CurrentState);
+		RunUpdate(UpdateTable[StateIndex], Owner, DeltaTime, Timings[StateIndex]);
+	}
+
+	/** Runs the update handler of State without a table lookup, does nothing if the owner is not in State */
+	template <StateType State>
+	void UpdateIn(OwnerType& Owner, float DeltaTime)
+	{
+		if (CurrentState != State)
+			return;
+
+		typedef typename TNthState<static_cast<int32>(State), States...>::Type FState;
+		RunUpdate(&FState::Update, Owner, DeltaTime, Timings[static_cast<int32>(State)]);
+	}
+
+	const FGrappleStateTimings& GetTimings(StateType State) const { return Timings[static_cast<int32>(State)]; }
+	void ResetTimings() { FMemory::Memzero(Timings); }
+
+private:
+	typedef void (*FEnterExitFunction)(OwnerType&);
+	typedef void (*FUpdateFunction)(OwnerType&, float);
+
+	template <int32 Index, typename First, typename... Rest>
+	struct TNthState { typedef typename TNthState<Index - 1, Rest...>::Type Type; };
+	template <typename First, typename... Rest>
+	struct TNthState<0, First, Rest...> { typedef First Type; };
+
+	static constexpr bool AreStatesInOrder()
+	{
+		constexpr StateType Order[] = { States::GetState()... };
+		for (int32 Index = 0; Index < NumStates; ++Index)
+		{
+			if (static_cast<int32>(Order[Index]) != Index)
+				return false;
+		}
+		return true;
+	}
+
+	/** Gives up on transition loops, two states entering each other forever */
+	static const int32 MaxChainedTransitions = 8;
+
+	void Transition(OwnerType& Owner, StateType State, bool bExitCurrent)
+	{
+		static const FEnterExitFunction EnterTable[] = { &States::Enter... };
+		static const FEnterExitFunction ExitTable[] = { &States::Exit... };
+
+		PendingState = State;
+		bPendingExit = bExitCurrent;
+		bHasPendingState = true;
+
+		// Requested from a handler, the loop below picks it up
+		if (bTransitioning)
+			return;
+
+		TGuardValue<bool> TransitionGuard(bTransitioning, true);
+		for (int32 Chain = 0; bHasPendingState; ++Chain)
+		{
+			if (!ensureMsgf(Chain < MaxChainedTransitions, TEXT("State machine transitioned %d times in a row, giving up"), Chain))
+			{
+				bHasPendingState = false;
+				break;
+			}
+			bHasPendingState = false;
+
+			if (bPendingExit)
+			{
+				RunEnterExit(ExitTable[static_cast<int32>(CurrentState)], Owner, Timings[static_cast<int32>(CurrentState)]);
+			}
+
+			CurrentState = PendingState;
+			FGrappleStateTimings& StateTimings = Timings[static_cast<int32>(CurrentState)];
+			++StateTimings.EnterCount;
+			RunEnterExit(EnterTable[static_cast<int32>(CurrentState)], Owner, StateTimings);
+		}
+	}
+
+	static void RunEnterExit(FEnterExitFunction Function, OwnerType& Owner, FGrappleStateTimings& StateTimings)
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		Function(Owner);
+		StateTimings.Cycles += FPlatformTime::Cycles64() - StartCycles;
+	}
+
+	static void RunUpdate(FUpdateFunction Function, OwnerType& Owner, float DeltaTime, FGrappleStateTimings& StateTimings)
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		Function(Owner, DeltaTime);
+		StateTimings.Cycles += FPlatformTime::Cycles64() - StartCycles;
+		StateTimings.TimeInState += DeltaTime;
+		++StateTimings.UpdateCount;
+	}
+
+	StateType CurrentState;
+	StateType PendingState = StateType();
+	bool bPendingExit = false;
+	bool bHasPendingState = false;
+	bool bTransitioning = false;
+
+	FGrappleStateTimings Timings[NumStates];
+};
@@ -0,0 +1,1109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrappleSubsystem.h"
+#include "GrappleRopeManager.h"
+#include "GrapplingHookTest.h"
+#include "Async/ParallelFor.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/Paths.h"
+
+DECLARE_CYCLE_STAT(TEXT("Subsystem Tick"), STAT_GrappleSubsystemTick, STATGROUP_Grapple);
+DECLARE_CYCLE_STAT(TEXT("Pendulum Step"), STAT_GrapplePendulumStep, STATGROUP_Grapple);
+DECLARE_CYCLE_STAT(TEXT("Hook Update"), STAT_GrappleHookUpdate, STATGROUP_Grapple);
+DECLARE_CYCLE_STAT(TEXT("Parallel Rope Simulation"), STAT_GrappleParallelRopes, STATGROUP_Grapple);
+DECLARE_CYCLE_STAT(TEXT("Rope Apply"), STAT_GrappleRopeApply, STATGROUP_Grapple);
+DECLARE_CYCLE_STAT(TEXT("Significance Update"), STAT_GrappleSignificanceUpdate, STATGROUP_Grapple);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Active Hooks"), STAT_GrappleActiveHooks, STATGROUP_Grapple);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Swingers"), STAT_GrappleSwingers, STATGROUP_Grapple);
+DECLARE_DWORD_COUNTER_STAT(TEXT("State Transitions"), STAT_GrappleStateTransitions, STATGROUP_Grapple);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Significance 0"), STAT_GrappleSignificance0, STATGROUP_Grapple);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Significance 1"), STAT_GrappleSignificance1, STATGROUP_Grapple);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Significance 2"), STAT_GrappleSignificance2, STATGROUP_Grapple);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Significance 3"), STAT_GrappleSignificance3, STATGROUP_Grapple);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Swing Reconciles"), STAT_GrappleSwingReconciles, STATGROUP_Grapple);
+DECLARE_CYCLE_STAT(TEXT("Snapshot Save"), STAT_GrappleSnapshotSave, STATGROUP_Grapple);
+DECLARE_CYCLE_STAT(TEXT("Snapshot Restore"), STAT_GrappleSnapshotRestore, STATGROUP_Grapple);
+DECLARE_CYCLE_STAT(TEXT("Resimulation"), STAT_GrappleResimulation, STATGROUP_Grapple);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Resimulated Frames"), STAT_GrappleResimulatedFrames, STATGROUP_Grapple);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hook Launches"), STAT_GrappleHookLaunches, STATGROUP_Grapple);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Hook Launch Latency (ms)"), STAT_GrappleHookLaunchLatency, STATGROUP_Grapple);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Hook Launch Latency At Frame Start (ms)"), STAT_GrappleHookFrameStartLatency, STATGROUP_Grapple);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Hook Launch Lead (ms)"), STAT_GrappleHookLaunchLead, STATGROUP_Grapple);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Net Bytes/s per Swinger"), STAT_GrappleNetBytesPerSwinger, STATGROUP_Grapple);
+
+static TAutoConsoleVariable<int32> CVarBatchedTick(
+	TEXT("grapple.BatchedTick"),
+	1,
+	TEXT("1: hooks are updated by the grapple subsystem in one loop per state.\n")
+	TEXT("0: every hook runs its own actor tick."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarParallel(
+	TEXT("grapple.Parallel"),
+	1,
+	TEXT("1: pendulums and batched ropes are integrated on the task graph.\n")
+	TEXT("0: everything runs on the game thread, results are identical."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarSignificance(
+	TEXT("grapple.Significance"),
+	1,
+	TEXT("1: far hooks, ropes and swingers lose detail according to the subsystem's SignificanceBuckets.\n")
+	TEXT("0: everything gets full detail."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarPendulumFixedTimeStep(
+	TEXT("grapple.Pendulum.FixedTimeStep"),
+	1.f / 60.f,
+	TEXT("Fixed simulation step for swinging pendulums, in seconds. The swing keeps its energy at any step, larger steps only lose detail."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarPendulumMaxSubsteps(
+	TEXT("grapple.Pendulum.MaxSubsteps"),
+	8,
+	TEXT("Maximum number of fixed pendulum steps per frame. Time beyond that is dropped."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarPendulumDamping(
+	TEXT("grapple.Pendulum.Damping"),
+	1.f,
+	TEXT("Fraction of swing speed kept after one second. 1 disables damping."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarCosmetics(
+	TEXT("grapple.Cosmetics"),
+	-1,
+	TEXT("-1: ropes, fire sounds and fire animations are skipped on dedicated servers.\n")
+	TEXT("0: skipped everywhere, to measure what a server saves.\n")
+	TEXT("1: kept everywhere. Server builds skip them regardless."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarSnapshots(
+	TEXT("grapple.Snapshots"),
+	1,
+	TEXT("0: no rollback snapshots are saved.\n")
+	TEXT("1: characters save a snapshot of their grapple state every frame in networked games.\n")
+	TEXT("2: in every game, standalone included."),
+	ECVF_Default);
+
+namespace
+{
+	// Work per task of the parallel phases, small enough to spread a few hundred swingers over the cores
+	const int32 PendulumGroupsPerTask = 16;
+	const int32 RopesPerTask = 4;
+
+	/** Full detail, used when no bucket is configured */
+	const FGrappleSignificanceBucket FullDetailBucket;
+
+	const TCHAR* const HookStateNames[] = { TEXT("Docked"), TEXT("Launching"), TEXT("Retracting"), TEXT("Hooked") };
+	const TCHAR* const CharacterStateNames[] = { TEXT("Grounded"), TEXT("Jumping"), TEXT("Swinging") };
+
+	/** Swinging or with a hook out, idle characters do not change until they fire */
+	bool IsGrappling(const AGrapplingHookTestCharacter* Character)
+	{
+		if (Character->GetCharacterState() == CharacterState::SWINGING)
+			return true;
+
+		for (const AGrapplingHookTestProjectile* Hook : Character->GetHooks())
+		{
+			if (Hook->GetProjectileState() != ProjectileState::DOCKED)
+				return true;
+		}
+		return false;
+	}
+
+	bool IsGrappling(const GrappleCore::FCharacterSnapshot& Snapshot)
+	{
+		if (Snapshot.SwingHook >= 0)
+			return true;
+
+		for (int32 HookIndex = 0; HookIndex < Snapshot.HookCount; ++HookIndex)
+		{
+			if (Snapshot.Hooks[HookIndex].State != static_cast<uint8>(ProjectileState::DOCKED))
+				return true;
+		}
+		return false;
+	}
+
+	void LogStateTimings(const TCHAR* StateName, const FGrappleStateTimings& Timings)
+	{
+		UE_LOG(LogGrapple, Display, TEXT("  %-10s entered %6u, updated %8u, %9.2f s in state, %8.3f ms in handlers"),
+			StateName, Timings.EnterCount, Timings.UpdateCount, Timings.TimeInState, Timings.GetMilliseconds());
+	}
+
+	void DumpStateTimings(UWorld* World)
+	{
+		const UGrappleSubsystem* GrappleSubsystem = World->GetSubsystem<UGrappleSubsystem>();
+		if (GrappleSubsystem == nullptr)
+			return;
+
+		UE_LOG(LogGrapple, Display, TEXT("Hook states:"));
+		for (int32 State = 0; State < UE_ARRAY_COUNT(HookStateNames); ++State)
+		{
+			LogStateTimings(HookStateNames[State], GrappleSubsystem->GetHookStateTimings(static_cast<ProjectileState>(State)));
+		}
+
+		UE_LOG(LogGrapple, Display, TEXT("Character states:"));
+		for (int32 State = 0; State < UE_ARRAY_COUNT(CharacterStateNames); ++State)
+		{
+			LogStateTimings(CharacterStateNames[State], GrappleSubsystem->GetCharacterStateTimings(static_cast<CharacterState>(State)));
+		}
+	}
+
+	FAutoConsoleCommandWithWorld GStateTimingsCommand(
+		TEXT("grapple.StateTimings"),
+		TEXT("Logs how often every hook and character state was entered and updated, and the time spent in it."),
+		FConsoleCommandWithWorldDelegate::CreateStatic(&DumpStateTimings));
+
+	void StartRecording(const TArray<FString>& Args, UWorld* World)
+	{
+		UGrappleSubsystem* GrappleSubsystem = World->GetSubsystem<UGrappleSubsystem>();
+		if (GrappleSubsystem == nullptr)
+			return;
+
+		const FString Path = Args.Num() > 0 ? Args[0] : FPaths::ProjectSavedDir() / TEXT("Recordings") / TEXT("Grapple.grpl");
+		GrappleSubsystem->StartRecording(Path);
+	}
+
+	void StopRecording(UWorld* World)
+	{
+		UGrappleSubsystem* GrappleSubsystem = World->GetSubsystem<UGrappleSubsystem>();
+		if (GrappleSubsystem != nullptr)
+		{
+			GrappleSubsystem->StopRecording();
+		}
+	}
+
+	FAutoConsoleCommandWithWorldAndArgs GRecordStartCommand(
+		TEXT("grapple.Record.Start"),
+		TEXT("Appends the grapple session to a recording, Saved/Recordings/Grapple.grpl unless a path is given."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&StartRecording));
+
+	FAutoConsoleCommandWithWorld GRecordStopCommand(
+		TEXT("grapple.Record.Stop"),
+		TEXT("Stops the grapple recording started by grapple.Record.Start."),
+		FConsoleCommandWithWorldDelegate::CreateStatic(&StopRecording));
+}
+
+const int32 UGrappleSubsystem::MaxSignificanceBuckets;
+
+GrappleCore::SphericalPendulumTiers::FHandle UGrappleSubsystem::AddPendulum(const FVector& Anchor, const FVector& Location, const FVector& Velocity, const FVector& Forward, float Gravity, float SteerAcceleration, bool bStepByMovement)
+{
+	const GrappleCore::SphericalPendulumTiers::FHandle Handle = Pendulums.Add(ToGrappleCore(Anchor), ToGrappleCore(Location - Anchor), ToGrappleCore(Velocity), ToGrappleCore(Forward), Gravity, SteerAcceleration);
+	Pendulums.SetOwnerStepped(Handle, bStepByMovement);
+	return Handle;
+}
+
+void UGrappleSubsystem::RemovePendulum(GrappleCore::SphericalPendulumTiers::FHandle Handle)
+{
+	Pendulums.Remove(Handle);
+}
+
+FVector UGrappleSubsystem::GetSwingAcceleration(const AGrapplingHookTestCharacter* Character, float MaxAcceleration) const
+{
+	GrappleCore::Vec3 Forward, Right;
+	Pendulums.GetSteeringBasis(Character->PendulumHandle, Forward, Right);
+	const FVector2D Input = Character->SwingInput.GetSafeNormal() * FMath::Min(Character->SwingInput.Size(), 1.f);
+	return ToUnreal(Forward * Input.X + Right * Input.Y) * MaxAcceleration;
+}
+
+void UGrappleSubsystem::StepSwing(AGrapplingHookTestCharacter* Character, const FVector& Acceleration, float MaxAcceleration, float DeltaTime)
+{
+	const GrappleCore::SphericalPendulumTiers::FHandle Handle = Character->PendulumHandle;
+	if (!Pendulums.IsOwnerStepped(Handle))
+		return;
+
+	// Back from the acceleration to the input along the swing basis
+	GrappleCore::Vec3 Forward, Right;
+	Pendulums.GetSteeringBasis(Handle, Forward, Right);
+	const GrappleCore::Vec3 Steering = MaxAcceleration > 0.f ? ToGrappleCore(Acceleration) / MaxAcceleration : GrappleCore::Vec3();
+	Character->SwingSteering = FVector2D(GrappleCore::Dot(Steering, Forward), GrappleCore::Dot(Steering, Right));
+
+	Pendulums.SetSteering(Handle, Character->SwingSteering.X, Character->SwingSteering.Y);
+	Pendulums.StepSwinger(Handle, DeltaTime);
+}
+
+bool UGrappleSubsystem::SaveSwing(const AGrapplingHookTestCharacter* Character, GrappleCore::SphericalPendulumBatch::FSwingerState& OutState) const
+{
+	if (!Pendulums.IsValid(Character->PendulumHandle))
+		return false;
+
+	Pendulums.GetSwingerState(Character->PendulumHandle, OutState);
+	return true;
+}
+
+void UGrappleSubsystem::RestoreSwing(const AGrapplingHookTestCharacter* Character, const GrappleCore::SphericalPendulumBatch::FSwingerState& State)
+{
+	Pendulums.SetSwingerState(Character->PendulumHandle, State);
+}
+
+bool UGrappleSubsystem::GetSwingTarget(const AGrapplingHookTestCharacter* Character, FVector& OutLocation, FVector& OutVelocity) const
+{
+	if (!Pendulums.IsValid(Character->PendulumHandle))
+		return false;
+
+	OutLocation = ToUnreal(Pendulums.GetPosition(Character->PendulumHandle));
+	OutVelocity = ToUnreal(Pendulums.GetVelocity(Character->PendulumHandle));
+	return true;
+}
+
+void UGrappleSubsystem::ConstrainSwing(const AGrapplingHookTestCharacter* Character, const FVector& Location, const FVector& Velocity)
+{
+	const GrappleCore::SphericalPendulumTiers::FHandle Handle = Character->PendulumHandle;
+	Pendulums.SetState(Handle, ToGrappleCore(Location) - Pendulums.GetAnchor(Handle), ToGrappleCore(Velocity));
+}
+
+void UGrappleSubsystem::SetSwingState(AGrapplingHookTestCharacter* Character, const FVector& Anchor, const FVector& Offset, const FVector& Velocity)
+{
+	const GrappleCore::SphericalPendulumTiers::FHandle Handle = Character->PendulumHandle;
+	if (!Pendulums.IsValid(Handle))
+		return;
+
+	// SetState keeps the sphere, anything else is a new pendulum in the same tier
+	const float Tolerance = 1.f;
+	if (ToUnreal(Pendulums.GetAnchor(Handle)).Equals(Anchor, Tolerance) && FMath::Abs(Pendulums.GetOffset(Handle).Size() - Offset.Size()) <= Tolerance)
+	{
+		Pendulums.SetState(Handle, ToGrappleCore(Offset), ToGrappleCore(Velocity));
+		return;
+	}
+
+	const int32 Tier = Pendulums.GetTier(Handle);
+	const bool bOwnerStepped = Pendulums.IsOwnerStepped(Handle);
+	Pendulums.Remove(Handle);
+	Character->PendulumHandle = Pendulums.Add(ToGrappleCore(Anchor), ToGrappleCore(Offset), ToGrappleCore(Velocity), ToGrappleCore(Character->SwingForward), GetWorld()->GetGravityZ(), Character->SwingSteerAcceleration, Tier);
+	Pendulums.SetOwnerStepped(Character->PendulumHandle, bOwnerStepped);
+	Pendulums.SetSteering(Character->PendulumHandle, Character->SwingSteering.X, Character->SwingSteering.Y);
+}
+
+void UGrappleSubsystem::ReconcileSwing(AGrapplingHookTestCharacter* Character, const FVector& Location, const FVector& Velocity)
+{
+	const GrappleCore::SphericalPendulumTiers::FHandle Handle = Character->PendulumHandle;
+	if (!Pendulums.IsValid(Handle))
+		return;
+
+	INC_DWORD_STAT(STAT_GrappleSwingReconciles);
+	CSV_CUSTOM_STAT(Grapple, SwingReconciles, 1, ECsvCustomStatOp::Accumulate);
+
+	Pendulums.SetState(Handle, ToGrappleCore(Location) - Pendulums.GetAnchor(Handle), ToGrappleCore(Velocity));
+}
+
+bool UGrappleSubsystem::RestoreSnapshot(AGrapplingHookTestCharacter* Character, uint32 Frame)
+{
+	const GrappleCore::FCharacterSnapshot* Snapshot = Character->Snapshots.Find(Frame);
+	if (Snapshot == nullptr)
+		return false;
+
+	SCOPE_CYCLE_COUNTER(STAT_GrappleSnapshotRestore);
+	ApplySnapshot(Character, *Snapshot);
+	return true;
+}
+
+int32 UGrappleSubsystem::Resimulate(AGrapplingHookTestCharacter* Character, uint32 Frame, int32 FrameCount)
+{
+	if (!RestoreSnapshot(Character, Frame))
+		return 0;
+
+	SCOPE_CYCLE_COUNTER(STAT_GrappleResimulation);
+	TGuardValue<bool> ResimulatingGuard(bResimulating, true);
+
+	// The character's swing is stepped again on a pendulum of its own, the others are not. It takes the fixed step and
+	// the clock it had then, and steps by frame like its tier or by exact times like its moves.
+	const GrappleCore::FCharacterSnapshot* Start = Character->Snapshots.Find(Frame);
+	GrappleCore::SphericalPendulumBatch& Replay = ResimulationPendulum;
+	Replay.SetFixedTimeStep(Start->PendulumStep);
+	Replay.SetMaxSubsteps(CVarPendulumMaxSubsteps.GetValueOnGameThread());
+	Replay.SetDamping(CVarPendulumDamping.GetValueOnGameThread());
+	Replay.SetAccumulatedTime(Start->PendulumTime);
+	GrappleCore::SphericalPendulumBatch::FHandle ReplayHandle = GrappleCore::SphericalPendulumBatch::InvalidHandle;
+	GrappleCore::SphericalPendulumBatch::FSwingerState SwingerState;
+
+	int32 FramesSimulated = 0;
+	for (; FramesSimulated < FrameCount; ++FramesSimulated)
+	{
+		const uint32 NextFrame = Frame + FramesSimulated + 1;
+		const GrappleCore::FCharacterSnapshot* Saved = Character->Snapshots.Find(NextFrame);
+		if (Saved == nullptr)
+			break;
+
+		// The frame is saved again below, over these inputs
+		const GrappleCore::FCharacterSnapshot Inputs = *Saved;
+
+		// Fire and retract are not saved, they show in the hook states they led to
+		const int32 HookCount = FMath::Min<int32>(Inputs.HookCount, Character->Projectiles.Num());
+		for (int32 HookIndex = 0; HookIndex < HookCount; ++HookIndex)
+		{
+			AGrapplingHookTestProjectile* Hook = Character->Projectiles[HookIndex];
+			const ProjectileState SavedState = static_cast<ProjectileState>(Inputs.Hooks[HookIndex].State);
+			if (SavedState == ProjectileState::LAUNCHING && Hook->GetProjectileState() == ProjectileState::DOCKED)
+			{
+				Hook->Fire();
+			}
+			else if (SavedState == ProjectileState::RETRACTING)
+			{
+				Hook->Retract();
+			}
+		}
+
+		// Pendulums step before the hooks, as in Tick
+		if (Character->GetCharacterState() == CharacterState::SWINGING && Pendulums.IsValid(Character->PendulumHandle))
+		{
+			Pendulums.GetSwingerState(Character->PendulumHandle, SwingerState);
+			if (ReplayHandle == GrappleCore::SphericalPendulumBatch::InvalidHandle)
+			{
+				ReplayHandle = Replay.Add(SwingerState);
+			}
+			else
+			{
+				Replay.SetSwingerState(ReplayHandle, SwingerState);
+			}
+
+			Character->SwingSteering = FVector2D(Inputs.SwingForward, Inputs.SwingRight);
+			Replay.SetSteering(ReplayHandle, Inputs.SwingForward, Inputs.SwingRight);
+			if (Pendulums.IsOwnerStepped(Character->PendulumHandle))
+			{
+				Replay.StepSwinger(ReplayHandle, Inputs.DeltaTime);
+			}
+			else
+			{
+				Replay.Update(Inputs.DeltaTime);
+			}
+
+			Replay.GetSwingerState(ReplayHandle, SwingerState);
+			Pendulums.SetSwingerState(Character->PendulumHandle, SwingerState);
+			Character->SetActorLocation(ToUnreal(SwingerState.Position));
+			Character->GetCharacterMovement()->Velocity = ToUnreal(Replay.GetVelocity(ReplayHandle));
+		}
+		else
+		{
+			// Walking and falling belong to the movement component, the saved result is kept
+			Replay.Update(Inputs.DeltaTime);
+			Character->SetActorLocation(ToUnreal(Inputs.Location));
+			Character->GetCharacterMovement()->Velocity = ToUnreal(Inputs.Velocity);
+		}
+
+		for (AGrapplingHookTestProjectile* Hook : Character->Projectiles)
+		{
+			Hook->StateMachine.Update(*Hook, Inputs.DeltaTime);
+		}
+
+		// The live clocks did not move, the frame ends on the replay's
+		GrappleCore::FCharacterSnapshot* Resaved = SaveSnapshot(Character, NextFrame, Inputs.DeltaTime);
+		if (Resaved != nullptr && !Pendulums.IsOwnerStepped(Character->PendulumHandle))
+		{
+			Resaved->PendulumTime = Replay.GetAccumulatedTime();
+		}
+	}
+
+	Replay.Remove(ReplayHandle);
+	INC_DWORD_STAT_BY(STAT_GrappleResimulatedFrames, FramesSimulated);
+	return FramesSimulated;
+}
+
+void UGrappleSubsystem::QueueRopeSimulation(AGrapplingHookTestProjectile* Hook, float DeltaTime, const GrappleCore::Vec3& RopeStart, const GrappleCore::Vec3& RopeEnd, const GrappleCore::Vec3& Gravity)
+{
+	FRopeJob& Job = RopeJobs.AddDefaulted_GetRef();
+	Job.Hook = Hook;
+	Job.Rope = &Hook->RopeSim;
+	Job.Start = RopeStart;
+	Job.End = RopeEnd;
+	Job.Gravity = Gravity;
+	Job.DeltaTime = DeltaTime;
+}
+
+bool UGrappleSubsystem::AreCosmeticsEnabled() const
+{
+#if UE_SERVER
+	return false;
+#else
+	const int32 Mode = CVarCosmetics.GetValueOnGameThread();
+	return Mode > 0 || (Mode < 0 && GetWorld()->GetNetMode() != NM_DedicatedServer);
+#endif
+}
+
+AGrappleRopeManager* UGrappleSubsystem::GetRopeManager()
+{
+	if (RopeManager == nullptr)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		RopeManager = GetWorld()->SpawnActor<AGrappleRopeManager>(SpawnParams);
+	}
+	return RopeManager;
+}
+
+AGrapplingHookTestProjectile* UGrappleSubsystem::AcquireHook(TSubclassOf<AGrapplingHookTestProjectile> HookClass, APawn* HookOwner, USceneComponent* DockPosition)
+{
+	if (HookClass == nullptr)
+		return nullptr;
+
+	if (!HookPools.Contains(HookClass))
+	{
+		PrewarmHooks(HookClass, HookPoolSize);
+	}
+
+	FGrappleHookPool& Pool = HookPools.FindChecked(HookClass);
+	AGrapplingHookTestProjectile* Hook = nullptr;
+	if (Pool.FreeHooks.Num() > 0)
+	{
+		Hook = Pool.FreeHooks.Pop(false);
+	}
+	else
+	{
+		UE_LOG(LogGrapple, Warning, TEXT("Hook pool of %s is exhausted, spawning a new hook. Consider raising HookPoolSize (%d)."), *HookClass->GetName(), HookPoolSize);
+		Hook = SpawnParkedHook(HookClass);
+	}
+
+	if (Hook != nullptr)
+	{
+		Hook->SetOwner(HookOwner);
+		Hook->SetInstigator(HookOwner);
+		Hook->Init(DockPosition);
+	}
+	return Hook;
+}
+
+void UGrappleSubsystem::ReleaseHook(AGrapplingHookTestProjectile* Hook)
+{
+	if (Hook == nullptr || Hook->IsPendingKill())
+		return;
+
+	Hook->Park();
+	Hook->SetOwner(nullptr);
+	Hook->SetInstigator(nullptr);
+	HookPools.FindOrAdd(Hook->GetClass()).FreeHooks.Add(Hook);
+}
+
+void UGrappleSubsystem::PrewarmHooks(TSubclassOf<AGrapplingHookTestProjectile> HookClass, int32 Count)
+{
+	FGrappleHookPool& Pool = HookPools.FindOrAdd(HookClass);
+	Pool.FreeHooks.Reserve(Pool.FreeHooks.Num() + Count);
+	for (int32 HookIndex = 0; HookIndex < Count; ++HookIndex)
+	{
+		if (AGrapplingHookTestProjectile* Hook = SpawnParkedHook(HookClass))
+		{
+			Pool.FreeHooks.Add(Hook);
+		}
+	}
+}
+
+AGrapplingHookTestProjectile* UGrappleSubsystem::SpawnParkedHook(TSubclassOf<AGrapplingHookTestProjectile> HookClass)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	AGrapplingHookTestProjectile* Hook = GetWorld()->SpawnActor<AGrapplingHookTestProjectile>(HookClass, FTransform::Identity, SpawnParams);
+	if (Hook != nullptr)
+	{
+		Hook->Park();
+	}
+	return Hook;
+}
+
+bool UGrappleSubsystem::GetSwingState(const AGrapplingHookTestCharacter* Character, FVector& OutOffset, FVector& OutVelocity) const
+{
+	if (Character->GetCharacterState() != CharacterState::SWINGING || !Pendulums.IsValid(Character->PendulumHandle))
+		return false;
+
+	OutOffset = ToUnreal(Pendulums.GetOffset(Character->PendulumHandle));
+	OutVelocity = ToUnreal(Pendulums.GetVelocity(Character->PendulumHandle));
+	return true;
+}
+
+bool UGrappleSubsystem::StartRecording(const FString& Path)
+{
+	GrappleRecording::FSessionHeader Header;
+	Header.MapName = GetWorld()->GetOutermost()->GetName();
+	Header.FixedTimeStep = CVarPendulumFixedTimeStep.GetValueOnGameThread();
+	Header.MaxSubsteps = CVarPendulumMaxSubsteps.GetValueOnGameThread();
+	Header.Damping = CVarPendulumDamping.GetValueOnGameThread();
+	Header.PendulumTime = Pendulums.GetAccumulatedTime();
+
+	if (!Recorder.Start(Path, Header))
+		return false;
+
+	UE_LOG(LogGrapple, Display, TEXT("Recording grapple session to %s"), *Path);
+	return true;
+}
+
+void UGrappleSubsystem::StopRecording()
+{
+	if (!Recorder.IsRecording())
+		return;
+
+	Recorder.Stop();
+	UE_LOG(LogGrapple, Display, TEXT("Grapple recording stopped, %llu bytes written"), Recorder.GetBytesWritten());
+}
+
+void UGrappleSubsystem::ApplySessionSettings(const GrappleRecording::FSessionHeader& Header)
+{
+	// The tick reads the console variables every frame
+	CVarPendulumFixedTimeStep->Set(Header.FixedTimeStep, ECVF_SetByCode);
+	CVarPendulumMaxSubsteps->Set(Header.MaxSubsteps, ECVF_SetByCode);
+	CVarPendulumDamping->Set(Header.Damping, ECVF_SetByCode);
+
+	Pendulums.SetFixedTimeStep(Header.FixedTimeStep);
+	Pendulums.SetAccumulatedTime(Header.PendulumTime);
+}
+
+void UGrappleSubsystem::Deinitialize()
+{
+	StopRecording();
+
+	Super::Deinitialize();
+}
+
+void UGrappleSubsystem::RegisterHook(AGrapplingHookTestProjectile* Hook)
+{
+	Hooks.Add(Hook, Hook->GetProjectileState());
+	UpdateTickEnabled(Hook);
+}
+
+void UGrappleSubsystem::UnregisterHook(AGrapplingHookTestProjectile* Hook)
+{
+	Hooks.Remove(Hook);
+}
+
+void UGrappleSubsystem::OnHookStateChanged(AGrapplingHookTestProjectile* Hook, ProjectileState NewState)
+{
+	Hooks.Move(Hook, NewState);
+	UpdateTickEnabled(Hook);
+
+	// Clients rebuild the hook from its owner's replicated state
+	if (AGrapplingHookTestCharacter* Owner = Cast<AGrapplingHookTestCharacter>(Hook->GetOwner()))
+	{
+		Owner->UpdateNetState();
+	}
+
+	INC_DWORD_STAT(STAT_GrappleStateTransitions);
+	CSV_CUSTOM_STAT(Grapple, StateTransitions, 1, ECsvCustomStatOp::Accumulate);
+}
+
+void UGrappleSubsystem::RegisterCharacter(AGrapplingHookTestCharacter* Character)
+{
+	Characters.Add(Character, Character->GetCharacterState());
+	UpdateTickEnabled(Character);
+}
+
+void UGrappleSubsystem::UnregisterCharacter(AGrapplingHookTestCharacter* Character)
+{
+	Characters.Remove(Character);
+}
+
+void UGrappleSubsystem::OnCharacterStateChanged(AGrapplingHookTestCharacter* Character, CharacterState NewState)
+{
+	Characters.Move(Character, NewState);
+	UpdateTickEnabled(Character);
+
+	INC_DWORD_STAT(STAT_GrappleStateTransitions);
+	CSV_CUSTOM_STAT(Grapple, StateTransitions, 1, ECsvCustomStatOp::Accumulate);
+}
+
+FGrappleStateTimings UGrappleSubsystem::GetHookStateTimings(ProjectileState State) const
+{
+	FGrappleStateTimings Total;
+	Hooks.ForEach([&Total, State](const AGrapplingHookTestProjectile* Hook) { Total += Hook->GetStateTimings(State); });
+	return Total;
+}
+
+FGrappleStateTimings UGrappleSubsystem::GetCharacterStateTimings(CharacterState State) const
+{
+	FGrappleStateTimings Total;
+	Characters.ForEach([&Total, State](const AGrapplingHookTestCharacter* Character) { Total += Character->GetStateTimings(State); });
+	return Total;
+}
+
+int32 UGrappleSubsystem::GetSignificanceBucketCount() const
+{
+	return FMath::Clamp(SignificanceBuckets.Num(), 1, MaxSignificanceBuckets);
+}
+
+int32 UGrappleSubsystem::GetSignificanceBucket(const FVector& Location, const APawn* Instigator) const
+{
+	// Our own hooks and swing always get full detail
+	if (Viewers.Num() == 0 || (Instigator != nullptr && Instigator->IsLocallyControlled()))
+		return 0;
+
+	float ClosestDistanceSquared = MAX_flt;
+	bool bInView = false;
+	for (const FSignificanceViewer& Viewer : Viewers)
+	{
+		const FVector ToLocation = Location - Viewer.Location;
+		const float DistanceSquared = ToLocation.SizeSquared();
+		ClosestDistanceSquared = FMath::Min(ClosestDistanceSquared, DistanceSquared);
+		bInView = bInView || Viewer.Forward.IsZero() || (ToLocation | Viewer.Forward) >= SignificanceCosViewAngle * FMath::Sqrt(DistanceSquared);
+	}
+
+	const int32 LastBucket = GetSignificanceBucketCount() - 1;
+	int32 Bucket = 0;
+	while (Bucket < LastBucket && ClosestDistanceSquared > FMath::Square(SignificanceBuckets[Bucket].MaxDistance))
+	{
+		++Bucket;
+	}
+
+	// Nobody looks at it, one bucket less detail
+	return bInView ? Bucket : FMath::Min(Bucket + 1, LastBucket);
+}
+
+void UGrappleSubsystem::UpdateSignificance()
+{
+	SCOPE_CYCLE_COUNTER(STAT_GrappleSignificanceUpdate);
+
+	Viewers.Reset();
+	SignificanceCosViewAngle = FMath::Cos(FMath::DegreesToRadians(SignificanceViewAngle));
+	if (CVarSignificance.GetValueOnGameThread() != 0 && SignificanceBuckets.Num() > 1)
+	{
+		// Player controllers have a view point on servers too, from their pawn
+		for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
+		{
+			const APlayerController* PlayerController = Iterator->Get();
+			if (PlayerController == nullptr)
+				continue;
+
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+			Viewers.Add({ ViewLocation, ViewRotation.Vector() });
+		}
+		for (const FVector& ViewLocation : ExtraViewLocations)
+		{
+			Viewers.Add({ ViewLocation, FVector::ZeroVector });
+		}
+	}
+
+	// The tiers only take the settings again when they change
+	const int32 BucketCount = GetSignificanceBucketCount();
+	Pendulums.SetTierCount(BucketCount);
+	for (int32 Bucket = 0; Bucket < BucketCount; ++Bucket)
+	{
+		const FGrappleSignificanceBucket& Settings = SignificanceBuckets.IsValidIndex(Bucket) ? SignificanceBuckets[Bucket] : FullDetailBucket;
+		Pendulums.SetStepMultiplier(Bucket, Settings.PendulumStepMultiplier);
+	}
+
+	int32 BucketCounts[MaxSignificanceBuckets] = {};
+	auto UpdateHook = [this, &BucketCounts](AGrapplingHookTestProjectile* Hook)
+	{
+		const int32 Bucket = GetSignificanceBucket(Hook->GetActorLocation(), Hook->GetInstigator());
+		const FGrappleSignificanceBucket& Settings = SignificanceBuckets.IsValidIndex(Bucket) ? SignificanceBuckets[Bucket] : FullDetailBucket;
+		Hook->SetSignificance(Settings.HookUpdateInterval, Settings.MaxRopeSegments);
+		++BucketCounts[Bucket];
+	};
+
+	// Docked hooks have no rope and nothing to update
+	for (AGrapplingHookTestProjectile* Hook : Hooks.Get(ProjectileState::LAUNCHING))
+	{
+		UpdateHook(Hook);
+	}
+	for (AGrapplingHookTestProjectile* Hook : Hooks.Get(ProjectileState::RETRACTING))
+	{
+		UpdateHook(Hook);
+	}
+	for (AGrapplingHookTestProjectile* Hook : Hooks.Get(ProjectileState::HOOKED))
+	{
+		UpdateHook(Hook);
+	}
+
+	for (AGrapplingHookTestCharacter* Character : Characters.Get(CharacterState::SWINGING))
+	{
+		const int32 Bucket = GetSignificanceBucket(Character->GetActorLocation(), Character);
+		Pendulums.SetTier(Character->PendulumHandle, Bucket);
+		++BucketCounts[Bucket];
+	}
+
+	SET_DWORD_STAT(STAT_GrappleSignificance0, BucketCounts[0]);
+	SET_DWORD_STAT(STAT_GrappleSignificance1, BucketCounts[1]);
+	SET_DWORD_STAT(STAT_GrappleSignificance2, BucketCounts[2]);
+	SET_DWORD_STAT(STAT_GrappleSignificance3, BucketCounts[3]);
+	CSV_CUSTOM_STAT(Grapple, Significance0, BucketCounts[0], ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Grapple, Significance1, BucketCounts[1], ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Grapple, Significance2, BucketCounts[2], ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Grapple, Significance3, BucketCounts[3], ECsvCustomStatOp::Set);
+}
+
+void UGrappleSubsystem::UpdateTickEnabled(AGrapplingHookTestProjectile* Hook) const
+{
+	// Only states with an update handler tick, a docked hook costs nothing per frame
+	Hook->SetActorTickEnabled(!bBatchedTick && AGrapplingHookTestProjectile::FStateMachine::HasUpdate(Hook->GetProjectileState()));
+}
+
+void UGrappleSubsystem::UpdateTickEnabled(AGrapplingHookTestCharacter* Character) const
+{
+	Character->SetActorTickEnabled(!bBatchedTick && AGrapplingHookTestCharacter::FStateMachine::HasUpdate(Character->GetCharacterState()));
+}
+
+void UGrappleSubsystem::ApplyTickMode()
+{
+	Hooks.ForEach([this](AGrapplingHookTestProjectile* Hook) { UpdateTickEnabled(Hook); });
+	Characters.ForEach([this](AGrapplingHookTestCharacter* Character) { UpdateTickEnabled(Character); });
+}
+
+void UGrappleSubsystem::UpdateHooks(float DeltaTime)
+{
+	// Docked hooks have nothing to update
+	Hooks.BeginIteration();
+
+	// Far hooks skip frames and catch up with the time they skipped
+	float HookDeltaTime;
+	for (AGrapplingHookTestProjectile* Hook : Hooks.Get(ProjectileState::LAUNCHING))
+	{
+		if (Hook->ConsumeUpdateTime(DeltaTime, HookDeltaTime))
+			Hook->StateMachine.UpdateIn<ProjectileState::LAUNCHING>(*Hook, HookDeltaTime);
+	}
+
+	for (AGrapplingHookTestProjectile* Hook : Hooks.Get(ProjectileState::RETRACTING))
+	{
+		if (Hook->ConsumeUpdateTime(DeltaTime, HookDeltaTime))
+			Hook->StateMachine.UpdateIn<ProjectileState::RETRACTING>(*Hook, HookDeltaTime);
+	}
+
+	for (AGrapplingHookTestProjectile* Hook : Hooks.Get(ProjectileState::HOOKED))
+	{
+		if (Hook->ConsumeUpdateTime(DeltaTime, HookDeltaTime))
+			Hook->StateMachine.UpdateIn<ProjectileState::HOOKED>(*Hook, HookDeltaTime);
+	}
+
+	Hooks.EndIteration();
+}
+
+void UGrappleSubsystem::UpdatePendulums(float DeltaTime)
+{
+	Pendulums.BeginUpdate(DeltaTime);
+
+	// Swingers are independent, each task steps its own lane groups
+	const int32 GroupCount = Pendulums.GetLaneGroupCount();
+	const int32 TaskCount = FMath::DivideAndRoundUp(GroupCount, PendulumGroupsPerTask);
+	ParallelFor(TaskCount, [this, GroupCount](int32 TaskIndex)
+	{
+		const int32 FirstGroup = TaskIndex * PendulumGroupsPerTask;
+		Pendulums.UpdateLaneGroups(FirstGroup, FMath::Min(PendulumGroupsPerTask, GroupCount - FirstGroup));
+	}, CVarParallel.GetValueOnGameThread() == 0);
+}
+
+void UGrappleSubsystem::SimulateRopes()
+{
+	{
+		SCOPE_CYCLE_COUNTER(STAT_GrappleParallelRopes);
+		CSV_SCOPED_TIMING_STAT(Grapple, ParallelRopes);
+
+		const int32 JobCount = RopeJobs.Num();
+		const int32 TaskCount = FMath::DivideAndRoundUp(JobCount, RopesPerTask);
+		ParallelFor(TaskCount, [this, JobCount](int32 TaskIndex)
+		{
+			const int32 LastJob = FMath::Min((TaskIndex + 1) * RopesPerTask, JobCount);
+			for (int32 JobIndex = TaskIndex * RopesPerTask; JobIndex < LastJob; ++JobIndex)
+			{
+				const FRopeJob& Job = RopeJobs[JobIndex];
+				Job.Rope->Update(Job.DeltaTime, Job.Start, Job.End, Job.Gravity);
+			}
+		}, CVarParallel.GetValueOnGameThread() == 0);
+	}
+
+	// Components are only touched from the game thread
+	SCOPE_CYCLE_COUNTER(STAT_GrappleRopeApply);
+	for (const FRopeJob& Job : RopeJobs)
+	{
+		Job.Hook->ApplyRope();
+	}
+	RopeJobs.Reset();
+}
+
+void UGrappleSubsystem::UpdateReplication(float DeltaTime)
+{
+	const ENetMode NetMode = GetWorld()->GetNetMode();
+	if (NetMode != NM_ListenServer && NetMode != NM_DedicatedServer)
+		return;
+
+	const TArray<AGrapplingHookTestCharacter*>& Swingers = Characters.Get(CharacterState::SWINGING);
+	for (AGrapplingHookTestCharacter* Character : Swingers)
+	{
+		Character->UpdateNetSwing(DeltaTime, SwingNetUpdateInterval);
+	}
+
+	// NetReportBits is added to when the actors replicate, read back here once a second
+	NetReportTime += DeltaTime;
+	if (NetReportTime < 1.f)
+		return;
+
+	const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	const int32 Connections = NetDriver != nullptr ? NetDriver->ClientConnections.Num() : 0;
+	NetBytesPerSwinger = Connections > 0 && Swingers.Num() > 0 ? NetReportBits / 8.f / NetReportTime / (Connections * Swingers.Num()) : 0.f;
+	NetReportBits = 0;
+	NetReportTime = 0.f;
+
+	SET_FLOAT_STAT(STAT_GrappleNetBytesPerSwinger, NetBytesPerSwinger);
+	CSV_CUSTOM_STAT(Grapple, NetBytesPerSwinger, NetBytesPerSwinger, ECsvCustomStatOp::Set);
+}
+
+void UGrappleSubsystem::FollowSimulatedSwings()
+{
+	if (GetWorld()->GetNetMode() != NM_Client)
+		return;
+
+	// Moving them can end their swing
+	Characters.BeginIteration();
+	for (AGrapplingHookTestCharacter* Character : Characters.Get(CharacterState::SWINGING))
+	{
+		if (Character->GetLocalRole() != ROLE_SimulatedProxy || !Pendulums.IsValid(Character->PendulumHandle))
+			continue;
+
+		Character->SetActorLocation(ToUnreal(Pendulums.GetPosition(Character->PendulumHandle)));
+		Character->GetCharacterMovement()->Velocity = ToUnreal(Pendulums.GetVelocity(Character->PendulumHandle));
+	}
+	Characters.EndIteration();
+}
+
+void UGrappleSubsystem::RecordFrame(float DeltaTime)
+{
+	// Sampled once everything moved, hooks and characters that tick on their own included
+	Recorder.RecordFrame(DeltaTime);
+
+	Characters.ForEach([this](AGrapplingHookTestCharacter* Character)
+	{
+		Recorder.RecordSample(Character);
+
+		FVector SwingOffset, SwingVelocity;
+		if (GetSwingState(Character, SwingOffset, SwingVelocity))
+		{
+			Recorder.RecordPendulumSample(Character, SwingOffset, SwingVelocity);
+		}
+	});
+
+	// Docked hooks follow their dock and hooked ones do not move
+	for (const AGrapplingHookTestProjectile* Hook : Hooks.Get(ProjectileState::LAUNCHING))
+	{
+		Recorder.RecordSample(Hook);
+	}
+	for (const AGrapplingHookTestProjectile* Hook : Hooks.Get(ProjectileState::RETRACTING))
+	{
+		Recorder.RecordSample(Hook);
+	}
+}
+
+bool UGrappleSubsystem::AreSnapshotsEnabled() const
+{
+	const int32 Mode = CVarSnapshots.GetValueOnGameThread();
+	return Mode >= 2 || (Mode == 1 && GetWorld()->GetNetMode() != NM_Standalone);
+}
+
+void UGrappleSubsystem::SaveSnapshots(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GrappleSnapshotSave);
+
+	// Idle characters are saved once when they settle, that frame still holds until they fire again
+	const uint32 Frame = GetSnapshotFrame();
+	GrapplingSnapshots = 0;
+	Characters.ForEach([this, Frame, DeltaTime](AGrapplingHookTestCharacter* Character)
+	{
+		const GrappleCore::FCharacterSnapshot* Newest = Character->Snapshots.Find(Character->Snapshots.GetNewestFrame());
+		if (Newest != nullptr && !IsGrappling(*Newest) && !IsGrappling(Character))
+			return;
+
+		SaveSnapshot(Character, Frame, DeltaTime);
+		const GrappleCore::FCharacterSnapshot* Saved = Character->Snapshots.Find(Frame);
+		if (Saved != nullptr && IsGrappling(*Saved))
+		{
+			++GrapplingSnapshots;
+		}
+	});
+}
+
+GrappleCore::FCharacterSnapshot* UGrappleSubsystem::SaveSnapshot(AGrapplingHookTestCharacter* Character, uint32 Frame, float DeltaTime)
+{
+	// Frames older than the ring holds arrive out of order and would drop the newer ones
+	GrappleCore::FCharacterSnapshot* Slot = Character->Snapshots.Save(Frame);
+	if (Slot == nullptr)
+		return nullptr;
+
+	GrappleCore::FCharacterSnapshot& Snapshot = *Slot;
+	Snapshot.Location = ToGrappleCore(Character->GetActorLocation());
+	Snapshot.Velocity = ToGrappleCore(Character->GetVelocity());
+	Snapshot.DeltaTime = DeltaTime;
+	Snapshot.SwingForward = Character->SwingSteering.X;
+	Snapshot.SwingRight = Character->SwingSteering.Y;
+	Snapshot.PendulumTime = Pendulums.GetAccumulatedTime(Character->PendulumHandle);
+	Snapshot.PendulumStep = Pendulums.GetFixedTimeStep(Character->PendulumHandle);
+
+	// Characters never own more hooks than a snapshot holds, see AGrapplingHookTestCharacter::NumHooks
+	ensureMsgf(Character->Projectiles.Num() <= GrappleCore::FCharacterSnapshot::MaxHooks, TEXT("%s has %d hooks, snapshots only save %d"),
+		*Character->GetName(), Character->Projectiles.Num(), GrappleCore::FCharacterSnapshot::MaxHooks);
+	Snapshot.HookCount = static_cast<uint8>(FMath::Min(Character->Projectiles.Num(), GrappleCore::FCharacterSnapshot::MaxHooks));
+	for (int32 HookIndex = 0; HookIndex < Snapshot.HookCount; ++HookIndex)
+	{
+		Character->Projectiles[HookIndex]->SaveSnapshot(Snapshot.Hooks[HookIndex]);
+	}
+
+	Snapshot.SwingHook = -1;
+	if (Character->GetCharacterState() == CharacterState::SWINGING && Pendulums.IsValid(Character->PendulumHandle))
+	{
+		const int32 SwingHook = Character->Projectiles.Find(Character->SwingProjectile);
+		if (SwingHook != INDEX_NONE && SwingHook < Snapshot.HookCount)
+		{
+			Snapshot.SwingHook = static_cast<int8>(SwingHook);
+			Pendulums.GetSwingerState(Character->PendulumHandle, Snapshot.Swing);
+		}
+	}
+	return Slot;
+}
+
+void UGrappleSubsystem::ApplySnapshot(AGrapplingHookTestCharacter* Character, const GrappleCore::FCharacterSnapshot& Snapshot)
+{
+	// Hooks first, hooking or unhooking one starts or ends the swing
+	const int32 HookCount = FMath::Min<int32>(Snapshot.HookCount, Character->Projectiles.Num());
+	for (int32 HookIndex = 0; HookIndex < HookCount; ++HookIndex)
+	{
+		Character->Projectiles[HookIndex]->RestoreSnapshot(Snapshot.Hooks[HookIndex]);
+	}
+
+	Character->SetActorLocation(ToUnreal(Snapshot.Location));
+	Character->GetCharacterMovement()->Velocity = ToUnreal(Snapshot.Velocity);
+
+	// The hook changes above swing on whichever hook hooks first, swing on the saved one
+	AGrapplingHookTestProjectile* SwingHook = Snapshot.SwingHook >= 0 && Snapshot.SwingHook < HookCount ? Character->Projectiles[Snapshot.SwingHook] : nullptr;
+	if (Character->SwingProjectile != SwingHook)
+	{
+		if (Character->GetCharacterState() == CharacterState::SWINGING)
+		{
+			Character->SetCharacterState(Character->GetUnhookedState());
+		}
+		if (SwingHook != nullptr)
+		{
+			Character->SwingProjectile = SwingHook;
+			Character->SetCharacterState(CharacterState::SWINGING);
+		}
+	}
+
+	// The pendulum takes its whole saved state back, whatever the character's state changes started
+	if (Snapshot.SwingHook >= 0 && Character->GetCharacterState() == CharacterState::SWINGING && Pendulums.IsValid(Character->PendulumHandle))
+	{
+		Pendulums.SetSwingerState(Character->PendulumHandle, Snapshot.Swing);
+		Character->SwingInput = Character->SwingSteering = FVector2D(Snapshot.SwingForward, Snapshot.SwingRight);
+	}
+}
+
+void UGrappleSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GrappleSubsystemTick);
+	CSV_SCOPED_TIMING_STAT(Grapple, SubsystemTick);
+
+	const bool bWantsBatchedTick = CVarBatchedTick.GetValueOnGameThread() != 0;
+	if (bWantsBatchedTick != bBatchedTick)
+	{
+		bBatchedTick = bWantsBatchedTick;
+		ApplyTickMode();
+	}
+
+	Pendulums.SetFixedTimeStep(CVarPendulumFixedTimeStep.GetValueOnGameThread());
+	Pendulums.SetMaxSubsteps(CVarPendulumMaxSubsteps.GetValueOnGameThread());
+	Pendulums.SetDamping(CVarPendulumDamping.GetValueOnGameThread());
+	UpdateSignificance();
+
+	// Only the swings of simulated proxies, the others were stepped by their moves
+	{
+		SCOPE_CYCLE_COUNTER(STAT_GrapplePendulumStep);
+		CSV_SCOPED_TIMING_STAT(Grapple, PendulumStep);
+		FGrappleCycleScope PendulumScope(FrameTimings.PendulumCycles);
+		UpdatePendulums(DeltaTime);
+	}
+	FollowSimulatedSwings();
+	UpdateReplication(DeltaTime);
+
+	// Swingers already moved in their movement component, the ropes follow them in the same frame
+	if (bBatchedTick)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_GrappleHookUpdate);
+		CSV_SCOPED_TIMING_STAT(Grapple, HookUpdate);
+		FGrappleCycleScope HookScope(FrameTimings.HookCycles);
+		UpdateHooks(DeltaTime);
+	}
+
+	// Batched hooks only queued their ropes, they are all simulated together once every hook moved
+	if (RopeJobs.Num() > 0)
+	{
+		// Still part of the hook updates, for timings that subtract the ropes from them
+		FGrappleCycleScope HookScope(FrameTimings.HookCycles);
+		FGrappleCycleScope RopeScope(FrameTimings.RopeCycles);
+		SimulateRopes();
+	}
+
+	// The rope manager flushed in its own tick before this one, batched ropes are pushed now to be drawn this frame
+	if (RopeManager != nullptr)
+	{
+		RopeManager->FlushInstances();
+	}
+
+	const int32 ActiveHooks = Hooks.Get(ProjectileState::LAUNCHING).Num() + Hooks.Get(ProjectileState::RETRACTING).Num() + Hooks.Get(ProjectileState::HOOKED).Num();
+	const int32 Swingers = Pendulums.Num();
+	SET_DWORD_STAT(STAT_GrappleActiveHooks, ActiveHooks);
+	SET_DWORD_STAT(STAT_GrappleSwingers, Swingers);
+	CSV_CUSTOM_STAT(Grapple, ActiveHooks, ActiveHooks, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Grapple, Swingers, Swingers, ECsvCustomStatOp::Set);
+
+	if (AreSnapshotsEnabled())
+	{
+		SaveSnapshots(DeltaTime);
+	}
+
+	if (Recorder.IsRecording())
+	{
+		RecordFrame(DeltaTime);
+	}
+}
+
+FGrappleFrameTimings UGrappleSubsystem::ConsumeFrameTimings()
+{
+	const FGrappleFrameTimings Timings = FrameTimings;
+	FrameTimings = FGrappleFrameTimings();
+	return Timings;
+}
+
+void UGrappleSubsystem::RecordLaunch(float Latency, float FrameStartLatency, float LeadTime)
+{
+	// Timestamps ahead of the frame, from a client clock reset, launch without a lead and count as no latency
+	Latency = FMath::Max(Latency, 0.f);
+	FrameStartLatency = FMath::Max(FrameStartLatency, 0.f);
+
+	++LaunchStats.Launches;
+	LaunchStats.TotalLatency += Latency;
+	LaunchStats.MaxLatency = FMath::Max<double>(LaunchStats.MaxLatency, Latency);
+	LaunchStats.TotalFrameStartLatency += FrameStartLatency;
+	LaunchStats.MaxFrameStartLatency = FMath::Max<double>(LaunchStats.MaxFrameStartLatency, FrameStartLatency);
+	LaunchStats.TotalLeadTime += LeadTime;
+
+	INC_DWORD_STAT(STAT_GrappleHookLaunches);
+	SET_FLOAT_STAT(STAT_GrappleHookLaunchLatency, Latency * 1000.f);
+	SET_FLOAT_STAT(STAT_GrappleHookFrameStartLatency, FrameStartLatency * 1000.f);
+	SET_FLOAT_STAT(STAT_GrappleHookLaunchLead, LeadTime * 1000.f);
+	CSV_CUSTOM_STAT(Grapple, HookLaunchLatencyMs, Latency * 1000.f, ECsvCustomStatOp::Max);
+	CSV_CUSTOM_STAT(Grapple, HookFrameStartLatencyMs, FrameStartLatency * 1000.f, ECsvCustomStatOp::Max);
+	CSV_CUSTOM_STAT(Grapple, HookLaunchLeadMs, LeadTime * 1000.f, ECsvCustomStatOp::Max);
+}
+
+float UGrappleSubsystem::GetFrameStartTime() const
+{
+	// The world's clock moves to the end of the frame before anything ticks
+	const UWorld* World = GetWorld();
+	return World->bInTick ? World->GetTimeSeconds() - World->GetDeltaSeconds() : World->GetTimeSeconds();
+}
+
+FGrappleLaunchStats UGrappleSubsystem::ConsumeLaunchStats()
+{
+	const FGrappleLaunchStats Stats = LaunchStats;
+	LaunchStats = FGrappleLaunchStats();
+	return Stats;
+}
+
+bool UGrappleSubsystem::IsTickable() const
+{
+	// The class default object is created too and must not tick
+	// Idle hooks and characters are not worth a tick, unless their frames are recorded or they still have to save the frame they settle in
+	return !IsTemplate() && (Pendulums.Num() > 0
+		|| Recorder.IsRecording()
+		|| (GrapplingSnapshots > 0 && AreSnapshotsEnabled())
+		|| Hooks.Get(ProjectileState::LAUNCHING).Num() > 0
+		|| Hooks.Get(ProjectileState::RETRACTING).Num() > 0
+		|| Hooks.Get(ProjectileState::HOOKED).Num() > 0
+		|| Characters.Get(CharacterState::SWINGING).Num() > 0);
+}
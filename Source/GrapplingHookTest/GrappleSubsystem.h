@@ -0,0 +1,348 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "SphericalPendulumTiers.h"
+#include "GrappleCoreConversions.h"
+#include "GrappleStateLists.h"
+#include "GrappleRecording.h"
+#include "GrapplingHookTestCharacter.h"
+#include "GrapplingHookTestProjectile.h"
+#include "GrappleSubsystem.generated.h"
+
+class AGrappleRopeManager;
+
+/** Game thread cycles spent in each grapple phase, summed until ConsumeFrameTimings is called */
+struct FGrappleFrameTimings
+{
+	uint64 PendulumCycles = 0;
+	uint64 SwingCycles = 0;
+	/** Hook state updates, rope simulation included */
+	uint64 HookCycles = 0;
+	uint64 RopeCycles = 0;
+};
+
+/** Hook launches since the last call to ConsumeLaunchStats */
+struct FGrappleLaunchStats
+{
+	int32 Launches = 0;
+	/** Simulation time from the fire input to the start of the hook's first flight, in seconds */
+	double TotalLatency = 0.0;
+	double MaxLatency = 0.0;
+	/** The same latency had the hooks launched at the start of the frame without a lead, in seconds */
+	double TotalFrameStartLatency = 0.0;
+	double MaxFrameStartLatency = 0.0;
+	/** Flight time the launches caught up on, for shots fired before the frame or the server got to them, in seconds */
+	double TotalLeadTime = 0.0;
+};
+
+/** Adds the cycles spent in its scope to a FGrappleFrameTimings counter */
+struct FGrappleCycleScope
+{
+	explicit FGrappleCycleScope(uint64& InCounter)
+		: Counter(InCounter)
+		, StartCycles(FPlatformTime::Cycles64())
+	{
+	}
+
+	~FGrappleCycleScope()
+	{
+		Counter += FPlatformTime::Cycles64() - StartCycles;
+	}
+
+private:
+	uint64& Counter;
+	uint64 StartCycles;
+};
+
+/**
+ * Detail of the hooks and swingers in one band of distance to the closest viewer.
+ * Buckets are listed from the closest to the furthest, see UGrappleSubsystem::SignificanceBuckets.
+ */
+USTRUCT()
+struct FGrappleSignificanceBucket
+{
+	GENERATED_BODY()
+
+	/** Objects closer than this to a viewer are in this bucket or a closer one, in cm. Ignored on the last bucket. */
+	UPROPERTY()
+	float MaxDistance = 0.f;
+
+	/** Hooks update once every this many frames, with the time of the frames they skipped */
+	UPROPERTY()
+	int32 HookUpdateInterval = 1;
+
+	/** Upper bound of rope segments, 0 hides the rope */
+	UPROPERTY()
+	int32 MaxRopeSegments = 16;
+
+	/** Swingers step this many fixed pendulum steps at once */
+	UPROPERTY()
+	int32 PendulumStepMultiplier = 1;
+};
+
+/** Parked hooks of one projectile class */
+USTRUCT()
+struct FGrappleHookPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	TArray<AGrapplingHookTestProjectile*> FreeHooks;
+};
+
+/**
+ * Per-world owner of the batched grapple simulation.
+ * Characters register a pendulum when they start swinging and steer it. Their UGrappleCharacterMovementComponent steps
+ * it by each move during the movement phase, sweeps the capsule toward it and pushes it back when something blocks the
+ * swing. Only the swings of simulated proxies are stepped together here, once a frame.
+ * Ropes are drawn by a single AGrappleRopeManager spawned on first use.
+ * Hooks are pooled: the first request for a projectile class spawns HookPoolSize of them, later requests reuse parked ones.
+ *
+ * Unless grapple.BatchedTick is 0, live hooks do not tick on their own: they are kept in dense per-state lists and every
+ * list is updated in a single loop per frame, after the pendulums are stepped.
+ * Either way only states with an update handler are ticked, docked hooks and characters cost nothing.
+ *
+ * Pendulums and batched ropes are integrated in a parallel phase that only touches plain simulation state, spread over
+ * the task graph unless grapple.Parallel is 0. The results are written back to the rope manager on the game thread.
+ *
+ * Live hooks and swingers are sorted into SignificanceBuckets by their distance to the closest player view, one bucket
+ * further when they are out of every view. Far buckets update hooks less often, simplify or hide ropes, and step their
+ * pendulums with longer fixed steps. Without any viewer, in the benchmark and the replays, everything gets full detail.
+ *
+ * On a server, characters replicate their hooks and swing as a compact FGrappleNetState instead of transforms, the
+ * swing every SwingNetUpdateInterval. Clients step the pendulums of other players' characters and move them along.
+ * stat Grapple shows the replicated bytes per second of each swinger.
+ * Dedicated servers strip the cosmetics, see AreCosmeticsEnabled: hooks fly, hook and retract, and pendulums swing,
+ * but no rope is simulated or drawn and firing plays nothing.
+ *
+ * Unless grapple.Snapshots is 0, the grapple state of every grappling character is saved at the end of each frame in
+ * its snapshot ring, so a rollback can restore a past frame and simulate the following ones again with their inputs.
+ * Idle characters only save the frame they settle in.
+ *
+ * grapple.Record.Start streams the session to a file that FGrappleReplay, and the GrappleBenchmark commandlet's
+ * -Replay mode, can play back headlessly.
+ */
+UCLASS(config = Game)
+class UGrappleSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Starts a swing from Location around Anchor, see GrappleCore::SphericalPendulumBatch::Add. A swing stepped by
+	 * movement is left to StepSwing, the others are stepped with every other swinger each frame.
+	 */
+	GrappleCore::SphericalPendulumTiers::FHandle AddPendulum(const FVector& Anchor, const FVector& Location, const FVector& Velocity, const FVector& Forward, float Gravity, float SteerAcceleration, bool bStepByMovement);
+	void RemovePendulum(GrappleCore::SphericalPendulumTiers::FHandle Handle);
+	FVector GetPendulumPosition(GrappleCore::SphericalPendulumTiers::FHandle Handle) const { return ToUnreal(Pendulums.GetPosition(Handle)); }
+
+	/**
+	 * Acceleration a swinging character's moves carry for its steering input, at most MaxAcceleration. The moves take
+	 * the steering to the server and to the replayed moves with it.
+	 */
+	FVector GetSwingAcceleration(const AGrapplingHookTestCharacter* Character, float MaxAcceleration) const;
+	/** Steps the swing of a character by exactly one of its moves, steered by the move's acceleration, if its movement steps it */
+	void StepSwing(AGrapplingHookTestCharacter* Character, const FVector& Acceleration, float MaxAcceleration, float DeltaTime);
+	/** Copies the whole state of a character's swing, for a saved move that may have to undo its step. False if it is not swinging. */
+	bool SaveSwing(const AGrapplingHookTestCharacter* Character, GrappleCore::SphericalPendulumBatch::FSwingerState& OutState) const;
+	void RestoreSwing(const AGrapplingHookTestCharacter* Character, const GrappleCore::SphericalPendulumBatch::FSwingerState& State);
+	/** Where a swinging character's movement should take it and at which velocity, false if it is not swinging */
+	bool GetSwingTarget(const AGrapplingHookTestCharacter* Character, FVector& OutLocation, FVector& OutVelocity) const;
+	/** Restarts a character's swing from where its movement actually ended, when the sweep was blocked */
+	void ConstrainSwing(const AGrapplingHookTestCharacter* Character, const FVector& Location, const FVector& Velocity);
+	/** Puts a character's swing at Offset from Anchor, a new anchor or rope length restarts its pendulum */
+	void SetSwingState(AGrapplingHookTestCharacter* Character, const FVector& Anchor, const FVector& Offset, const FVector& Velocity);
+	/** Restarts an owning client's swing from the server's correction, the moves it replays then step it again */
+	void ReconcileSwing(AGrapplingHookTestCharacter* Character, const FVector& Location, const FVector& Velocity);
+
+	/** Frame number snapshots are saved under, one per world tick */
+	static uint32 GetSnapshotFrame() { return static_cast<uint32>(GFrameCounter); }
+	/** Puts a character, its hooks and its swing back where they were at the end of Frame, false if it is not saved */
+	bool RestoreSnapshot(AGrapplingHookTestCharacter* Character, uint32 Frame);
+	/**
+	 * Restores Frame, then simulates the character's hooks and swing again through the next FrameCount saved frames
+	 * with their saved inputs, saving them anew. Returns the number of frames simulated again.
+	 */
+	int32 Resimulate(AGrapplingHookTestCharacter* Character, uint32 Frame, int32 FrameCount);
+	/** True while Resimulate runs, cosmetics such as ropes skip those frames */
+	bool IsResimulating() const { return bResimulating; }
+
+	/**
+	 * False on dedicated servers unless grapple.Cosmetics says otherwise, and always in server builds. Ropes, fire
+	 * sounds and fire animations are skipped then, only hooks and pendulums are simulated.
+	 */
+	bool AreCosmeticsEnabled() const;
+
+	/** Returns the world's rope manager, spawning it if needed */
+	AGrappleRopeManager* GetRopeManager();
+	AGrappleRopeManager* FindRopeManager() const { return RopeManager; }
+
+	/** Queues a rope simulation for the parallel rope phase of this frame, the hook's rope is redrawn once it ran */
+	void QueueRopeSimulation(AGrapplingHookTestProjectile* Hook, float DeltaTime, const GrappleCore::Vec3& RopeStart, const GrappleCore::Vec3& RopeEnd, const GrappleCore::Vec3& Gravity);
+
+	/** Number of hooks spawned up front for each projectile class */
+	UPROPERTY(Config)
+	int32 HookPoolSize = 16;
+
+	/** From the closest to the furthest, at most MaxSignificanceBuckets. Empty gives everything full detail. */
+	UPROPERTY(Config)
+	TArray<FGrappleSignificanceBucket> SignificanceBuckets;
+
+	/** Half angle of the view cone, objects outside every view cone drop one bucket, in degrees */
+	UPROPERTY(Config)
+	float SignificanceViewAngle = 60.f;
+
+	/** Buckets past this one are merged into it, stats have a counter for each */
+	static const int32 MaxSignificanceBuckets = 4;
+
+	/** Seconds between two swing updates of a character's replicated state, clients step the swing in between */
+	UPROPERTY(Config)
+	float SwingNetUpdateInterval = 0.1f;
+
+	/**
+	 * Bytes of replicated grapple state per second, per swinger and per client connection, over the last second.
+	 * Property headers and packet overhead come on top, see stat net. Zero unless this world is a server.
+	 */
+	float GetNetBytesPerSwinger() const { return NetBytesPerSwinger; }
+	/** Counts a character's replicated state sent to one connection of this world */
+	void AddNetStateBits(int32 Bits) { NetReportBits += Bits; }
+
+	/** Viewers that have no player controller, such as the benchmark's crowd camera. They see in every direction. */
+	void SetExtraViewLocations(const TArray<FVector>& Locations) { ExtraViewLocations = Locations; }
+
+	/** Hands out a parked hook docked on DockPosition. Only spawns when the pool of HookClass is exhausted. */
+	AGrapplingHookTestProjectile* AcquireHook(TSubclassOf<AGrapplingHookTestProjectile> HookClass, APawn* HookOwner, USceneComponent* DockPosition);
+	/** Parks a hook until it is acquired again, it is never destroyed */
+	void ReleaseHook(AGrapplingHookTestProjectile* Hook);
+	void PrewarmHooks(TSubclassOf<AGrapplingHookTestProjectile> HookClass, int32 Count);
+
+	void RegisterHook(AGrapplingHookTestProjectile* Hook);
+	void UnregisterHook(AGrapplingHookTestProjectile* Hook);
+	void OnHookStateChanged(AGrapplingHookTestProjectile* Hook, ProjectileState NewState);
+
+	void RegisterCharacter(AGrapplingHookTestCharacter* Character);
+	void UnregisterCharacter(AGrapplingHookTestCharacter* Character);
+	void OnCharacterStateChanged(AGrapplingHookTestCharacter* Character, CharacterState NewState);
+
+	/** State counters summed over every registered hook or character */
+	FGrappleStateTimings GetHookStateTimings(ProjectileState State) const;
+	FGrappleStateTimings GetCharacterStateTimings(CharacterState State) const;
+
+	/** Phase timings are summed by the subsystem and by the actors that tick on their own */
+	FGrappleFrameTimings& GetFrameTimings() { return FrameTimings; }
+	/** Returns the timings summed since the last call and starts over */
+	FGrappleFrameTimings ConsumeFrameTimings();
+
+	/**
+	 * Counts a hook that started flying Latency seconds of simulation time after its fire input, LeadTime seconds
+	 * along its path. FrameStartLatency is where a launch at the start of the frame would have started.
+	 */
+	void RecordLaunch(float Latency, float FrameStartLatency, float LeadTime);
+	/** Simulation time hooks launched now start flying from: the start of the frame being ticked, or of the next one */
+	float GetFrameStartTime() const;
+	FGrappleLaunchStats ConsumeLaunchStats();
+
+	/** When false every hook and character runs its own actor tick, for comparison */
+	bool IsBatchedTickEnabled() const { return bBatchedTick; }
+
+	int32 GetHookCount(ProjectileState State) const { return Hooks.Get(State).Num(); }
+	int32 GetCharacterCount(CharacterState State) const { return Characters.Get(State).Num(); }
+
+	/** Offset from the anchor and velocity of a swinging character, false if it is not swinging */
+	bool GetSwingState(const AGrapplingHookTestCharacter* Character, FVector& OutOffset, FVector& OutVelocity) const;
+
+	/** Appends this world's grapple session to the recording at Path, see GrappleRecording.h */
+	bool StartRecording(const FString& Path);
+	void StopRecording();
+	/** Fed by the actors, does nothing unless a recording was started */
+	FGrappleRecorder& GetRecorder() { return Recorder; }
+	/** Steps the pendulums with the settings a session was recorded with */
+	void ApplySessionSettings(const GrappleRecording::FSessionHeader& Header);
+
+	// USubsystem interface
+	virtual void Deinitialize() override;
+	// End of USubsystem interface
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+	virtual TStatId GetStatId() const override { RETURN_QUICK_DECLARE_CYCLE_STAT(UGrappleSubsystem, STATGROUP_Tickables); }
+	// End of FTickableGameObject interface
+
+private:
+	void UpdateSignificance();
+	int32 GetSignificanceBucket(const FVector& Location, const APawn* Instigator) const;
+	int32 GetSignificanceBucketCount() const;
+	void UpdateTickEnabled(AGrapplingHookTestProjectile* Hook) const;
+	void UpdateTickEnabled(AGrapplingHookTestCharacter* Character) const;
+	void ApplyTickMode();
+	void UpdateHooks(float DeltaTime);
+	void UpdatePendulums(float DeltaTime);
+	void SimulateRopes();
+	void RecordFrame(float DeltaTime);
+	bool AreSnapshotsEnabled() const;
+	void SaveSnapshots(float DeltaTime);
+	/** Returns the saved snapshot, null when Frame is older than the ring holds */
+	GrappleCore::FCharacterSnapshot* SaveSnapshot(AGrapplingHookTestCharacter* Character, uint32 Frame, float DeltaTime);
+	void ApplySnapshot(AGrapplingHookTestCharacter* Character, const GrappleCore::FCharacterSnapshot& Snapshot);
+	/** Server: refreshes the swings in the replicated character states and measures what they cost */
+	void UpdateReplication(float DeltaTime);
+	/** Other players' characters follow their pendulums, their movement is not replicated while they swing */
+	void FollowSimulatedSwings();
+
+	/** One tier per significance bucket */
+	GrappleCore::SphericalPendulumTiers Pendulums;
+	/** Steps the swing of the character Resimulate runs, kept so it does not allocate again */
+	GrappleCore::SphericalPendulumBatch ResimulationPendulum;
+
+	struct FSignificanceViewer
+	{
+		FVector Location;
+		/** Zero for viewers that see in every direction */
+		FVector Forward;
+	};
+	TArray<FSignificanceViewer> Viewers;
+	TArray<FVector> ExtraViewLocations;
+	/** Cosine of SignificanceViewAngle, taken once per frame */
+	float SignificanceCosViewAngle = 0.5f;
+
+	/** One rope of the parallel rope phase, the worker threads only see the simulation and its inputs */
+	struct FRopeJob
+	{
+		AGrapplingHookTestProjectile* Hook;
+		GrappleCore::RopeSimulation* Rope;
+		GrappleCore::Vec3 Start;
+		GrappleCore::Vec3 End;
+		GrappleCore::Vec3 Gravity;
+		float DeltaTime;
+	};
+	TArray<FRopeJob> RopeJobs;
+
+	TGrappleStateLists<AGrapplingHookTestProjectile, ProjectileState, static_cast<int32>(ProjectileState::HOOKED) + 1> Hooks;
+	TGrappleStateLists<AGrapplingHookTestCharacter, CharacterState, static_cast<int32>(CharacterState::SWINGING) + 1> Characters;
+	bool bBatchedTick = true;
+	bool bResimulating = false;
+	/** Characters whose newest snapshot has them grappling, they save one more frame once idle */
+	int32 GrapplingSnapshots = 0;
+
+	FGrappleFrameTimings FrameTimings;
+	FGrappleLaunchStats LaunchStats;
+	FGrappleRecorder Recorder;
+
+	float NetReportTime = 0.f;
+	uint64 NetReportBits = 0;
+	float NetBytesPerSwinger = 0.f;
+
+	UPROPERTY(Transient)
+	AGrappleRopeManager* RopeManager;
+
+	UPROPERTY(Transient)
+	TMap<UClass*, FGrappleHookPool> HookPools;
+
+	AGrapplingHookTestProjectile* SpawnParkedHook(TSubclassOf<AGrapplingHookTestProjectile> HookClass);
+};
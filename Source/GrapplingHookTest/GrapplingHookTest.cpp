@@ -4,4 +4,8 @@
 #include "Modules/ModuleManager.h"
 
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, GrapplingHookTest, "GrapplingHookTest" );
+
+DEFINE_LOG_CATEGORY(LogGrapple);
+
+CSV_DEFINE_CATEGORY_MODULE(GRAPPLINGHOOKTEST_API, Grapple, true);
  
\ No newline at end of file
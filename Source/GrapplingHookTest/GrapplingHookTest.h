@@ -3,3 +3,14 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogGrapple, Log, All);
+
+/** Trace channel swept by the flying hooks, whatever blocks it can be hooked. See the collision profiles in DefaultEngine.ini. */
+#define ECC_GrappleHook ECC_GameTraceChannel2
+
+DECLARE_STATS_GROUP(TEXT("Grapple"), STATGROUP_Grapple, STATCAT_Advanced);
+
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(GRAPPLINGHOOKTEST_API, Grapple);
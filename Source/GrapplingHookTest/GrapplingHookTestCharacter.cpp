@@ -1,21 +1,44 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "GrapplingHookTestCharacter.h"
+#include "GrappleCharacterMovementComponent.h"
+#include "GrappleSubsystem.h"
+#include "GrapplingHookTest.h"
 #include "Animation/AnimInstance.h"
 #include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/InputComponent.h"
+#include "Engine/AssetManager.h"
 #include "GameFramework/InputSettings.h"
 #include "Kismet/GameplayStatics.h"
 #include "MotionControllerComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "Net/UnrealNetwork.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogFPChar, Warning, All);
 
+DECLARE_CYCLE_STAT(TEXT("Character Tick"), STAT_GrappleCharacterTick, STATGROUP_Grapple);
+DECLARE_CYCLE_STAT(TEXT("Character State Transition"), STAT_GrappleCharacterTransition, STATGROUP_Grapple);
+
+namespace
+{
+	/** Replicated anchors are rounded to the centimeter, hooks closer than this to them are where the server has them */
+	const float NetAnchorTolerance = 2.f;
+
+	/** The hook got from Server to Local on its own, without an input the server could have refused */
+	bool IsHookStateAhead(ProjectileState Local, ProjectileState Server)
+	{
+		return (Server == ProjectileState::LAUNCHING && Local == ProjectileState::HOOKED)
+			|| (Server == ProjectileState::RETRACTING && Local == ProjectileState::DOCKED);
+	}
+}
+
 //////////////////////////////////////////////////////////////////////////
 // AGrapplingHookTestCharacter
 
-AGrapplingHookTestCharacter::AGrapplingHookTestCharacter()
+AGrapplingHookTestCharacter::AGrapplingHookTestCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UGrappleCharacterMovementComponent>(ACharacter::CharacterMovementComponentName))
+	, StateMachine(CharacterState::GROUNDED)
 {
 	PrimaryActorTick.bCanEverTick = true;
 	SetActorTickEnabled(true);
@@ -56,8 +79,6 @@ AGrapplingHookTestCharacter::AGrapplingHookTestCharacter()
 
 	// Default offset from the character location for projectiles to spawn
 	GunOffset = FVector(100.0f, 0.0f, 10.0f);
-
-	SetCharacterState(CharacterState::GROUNDED);
 }
 
 void AGrapplingHookTestCharacter::BeginPlay()
@@ -70,70 +91,169 @@ void AGrapplingHookTestCharacter::BeginPlay()
 
 	SkeletalMesh->SetHiddenInGame(false, true);
 
-	// Spawn projectile
-	if (ProjectileClass != nullptr)
+	StateMachine.Start(*this, GetUnhookedState());
+
+	// The subsystem decides whether we tick on our own or in its batch
+	GetWorld()->GetSubsystem<UGrappleSubsystem>()->RegisterCharacter(this);
+
+	// The hooks wait for their class, loaded assets are only referenced
+	BeginPlaySeconds = FPlatformTime::Seconds();
+	TArray<FSoftObjectPath> AssetPaths;
+	GetStreamedAssetPaths(GetWorld()->GetSubsystem<UGrappleSubsystem>()->AreCosmeticsEnabled(), AssetPaths);
+	const bool bLoaded = !AssetPaths.ContainsByPredicate([](const FSoftObjectPath& Path) { return Path.ResolveObject() == nullptr; });
+
+	FStreamableManager& Streamable = UAssetManager::GetStreamableManager();
+	if (bLoaded)
 	{
-		UWorld* const World = GetWorld();
-		if (World != nullptr)
-		{
-			const FRotator SpawnRotation = GetControlRotation();
-			// MuzzleOffset is in camera space, so transform it to world space before offsetting from the character location to find the final muzzle position
-			const FVector SpawnLocation = ((MuzzleLocation != nullptr) ? MuzzleLocation->GetComponentLocation() : GetActorLocation()) + SpawnRotation.RotateVector(GunOffset);
+		StreamedAssets = AssetPaths.Num() > 0 ? Streamable.RequestSyncLoad(AssetPaths) : nullptr;
+		OnAssetsLoaded();
+	}
+	else
+	{
+		StreamedAssets = Streamable.RequestAsyncLoad(AssetPaths, FStreamableDelegate::CreateUObject(this, &AGrapplingHookTestCharacter::OnAssetsLoaded), FStreamableManager::AsyncLoadHighPriority);
+	}
+}
 
-			// spawn the projectile at the muzzle
-			Projectile = World->SpawnActor<AGrapplingHookTestProjectile>(ProjectileClass, SpawnLocation, SpawnRotation);
-			Projectile->Init(MuzzleLocation);
-		}
+void AGrapplingHookTestCharacter::GetStreamedAssetPaths(bool bCosmetics, TArray<FSoftObjectPath>& OutPaths) const
+{
+	if (!ProjectileClass.IsNull())
+	{
+		OutPaths.Add(ProjectileClass.ToSoftObjectPath());
+	}
+
+	if (bCosmetics && !FireSound.IsNull())
+	{
+		OutPaths.Add(FireSound.ToSoftObjectPath());
+	}
+	if (bCosmetics && !FireAnimation.IsNull())
+	{
+		OutPaths.Add(FireAnimation.ToSoftObjectPath());
 	}
 }
 
-void AGrapplingHookTestCharacter::Tick(float DeltaTime)
+TSharedPtr<FStreamableHandle> AGrapplingHookTestCharacter::LoadStreamedAssets() const
 {
-	Update(DeltaTime);
+	TArray<FSoftObjectPath> AssetPaths;
+	GetStreamedAssetPaths(true, AssetPaths);
+	return AssetPaths.Num() > 0 ? UAssetManager::GetStreamableManager().RequestSyncLoad(AssetPaths) : nullptr;
 }
 
-void AGrapplingHookTestCharacter::Update(float DeltaTime)
+void AGrapplingHookTestCharacter::OnAssetsLoaded()
 {
-	if (CharacterStateVar == CharacterState::GROUNDED)
+	// Streaming can end after we left play
+	if (bAssetsReady || !HasActorBegunPlay() || IsPendingKill())
+		return;
+
+	bAssetsReady = true;
+
+	// Take our hooks from the world's pool, they dock on the muzzle
+	// Replication and rollback snapshots cover a fixed number of hooks, values set past the property's clamp are cut
+	if (UClass* HookClass = ProjectileClass.Get())
 	{
-		if (StateStepVar == StateStep::ON_ENTER) {
-			Grounded_Enter();
+		if (NumHooks > GrappleCore::MaxHooksPerCharacter)
+		{
+			UE_LOG(LogGrapple, Warning, TEXT("%s has %d hooks, only %d are used"), *GetName(), NumHooks, GrappleCore::MaxHooksPerCharacter);
 		}
-		if (StateStepVar == StateStep::ON_UPDATE) {
-			Grounded_Update();
+
+		UGrappleSubsystem* GrappleSubsystem = GetWorld()->GetSubsystem<UGrappleSubsystem>();
+		const int32 HookCount = FMath::Min(NumHooks, GrappleCore::MaxHooksPerCharacter);
+		for (int32 HookIndex = 0; HookIndex < HookCount; ++HookIndex)
+		{
+			AGrapplingHookTestProjectile* Hook = GrappleSubsystem->AcquireHook(HookClass, this, MuzzleLocation);
+			if (Hook != nullptr)
+			{
+				Hook->OnHooked.AddUObject(this, &AGrapplingHookTestCharacter::OnHookHooked);
+				Hook->OnUnhooked.AddUObject(this, &AGrapplingHookTestCharacter::OnHookUnhooked);
+				Projectiles.Add(Hook);
+			}
 		}
 	}
 
-	if (CharacterStateVar == CharacterState::SWINGING)
+	// The first replicated state can arrive before the hooks are acquired
+	if (HasAuthority())
 	{
-		if (StateStepVar == StateStep::ON_ENTER) {
-			Swinging_Enter(DeltaTime);
-		}
-		if (StateStepVar == StateStep::ON_UPDATE) {
-			Swinging_Update(DeltaTime);
+		UpdateNetState();
+	}
+	else
+	{
+		OnRep_NetState();
+	}
+
+	// Time to the first shot the player can fire, from launch and from spawn
+	if (IsLocallyControlled())
+	{
+		UE_LOG(LogGrapple, Display, TEXT("%s ready to fire %.3f s after launch, %.3f s after BeginPlay"),
+			*GetName(), FPlatformTime::Seconds() - GStartTime, FPlatformTime::Seconds() - BeginPlaySeconds);
+	}
+}
+
+void AGrapplingHookTestCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	// Give the pendulum slot back if we are removed mid-swing
+	if (GetCharacterState() == CharacterState::SWINGING)
+		Swinging_Exit();
+
+	// Hooks go back to the pool for the next character
+	UGrappleSubsystem* GrappleSubsystem = GetWorld()->GetSubsystem<UGrappleSubsystem>();
+	if (GrappleSubsystem != nullptr)
+	{
+		for (AGrapplingHookTestProjectile* Hook : Projectiles)
+		{
+			Hook->OnHooked.RemoveAll(this);
+			Hook->OnUnhooked.RemoveAll(this);
+			GrappleSubsystem->ReleaseHook(Hook);
 		}
+		GrappleSubsystem->UnregisterCharacter(this);
 	}
+	Projectiles.Reset();
+
+	if (StreamedAssets.IsValid() && StreamedAssets->IsLoadingInProgress())
+	{
+		StreamedAssets->CancelHandle();
+	}
+	StreamedAssets.Reset();
+	bAssetsReady = false;
 }
 
-void AGrapplingHookTestCharacter::SetCharacterState(CharacterState newState)
+void AGrapplingHookTestCharacter::Tick(float DeltaTime)
 {
-	// Append any GameStates you add to this example to this switch statement...
-	switch (CharacterStateVar)
-	{
-	case CharacterState::GROUNDED:
-		//Docked_Exit();
-		break;
-	case CharacterState::SWINGING:
-		//Launching_Exit();
-		break;
-	default:
-		UE_LOG(LogTemp, Error, TEXT("Unexpected state has not been implemented!"), newState);
-		return;
+	SCOPE_CYCLE_COUNTER(STAT_GrappleCharacterTick);
+	CSV_SCOPED_TIMING_STAT(Grapple, CharacterTick);
+	StateMachine.Update(*this, DeltaTime);
+}
+
+void AGrapplingHookTestCharacter::OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PreviousCustomMode)
+{
+	Super::OnMovementModeChanged(PrevMovementMode, PreviousCustomMode);
+
+	// Swinging owns the movement until the hook lets go
+	if (GetCharacterState() != CharacterState::SWINGING && GetCharacterState() != GetUnhookedState())
+	{
+		SetCharacterState(GetUnhookedState());
 	}
+}
 
-	// Set new GameStates state and begin OnEnter of that state
-	CharacterStateVar = newState;
-	StateStepVar = StateStep::ON_ENTER;
+void AGrapplingHookTestCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AGrapplingHookTestCharacter, NetState);
+}
+
+void AGrapplingHookTestCharacter::SetCharacterState(CharacterState newState)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GrappleCharacterTransition);
+
+	UGrappleSubsystem* GrappleSubsystem = GetWorld()->GetSubsystem<UGrappleSubsystem>();
+	GrappleSubsystem->GetRecorder().RecordTransition(this, newState);
+
+	// Exit and enter run right away, the new state is live this frame
+	StateMachine.SetState(*this, newState);
+
+	// Characters registered while the lists are iterated are not linked yet, the lists still file them under this state
+	GrappleSubsystem->OnCharacterStateChanged(this, GetCharacterState());
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -165,88 +285,287 @@ void AGrapplingHookTestCharacter::SetupPlayerInputComponent(class UInputComponen
 	PlayerInputComponent->BindAxis("LookUpRate", this, &AGrapplingHookTestCharacter::LookUpAtRate);
 }
 
-void AGrapplingHookTestCharacter::Grounded_Enter()
+void AGrapplingHookTestCharacter::OnHookHooked(AGrapplingHookTestProjectile* Hook)
 {
-	GetCharacterMovement()->GravityScale = 1.f;
-	
-	StateStepVar = StateStep::ON_UPDATE;
+	if (GetCharacterState() == CharacterState::SWINGING)
+		return;
+
+	SwingProjectile = Hook;
+	SetCharacterState(CharacterState::SWINGING);
+}
+
+void AGrapplingHookTestCharacter::OnHookUnhooked(AGrapplingHookTestProjectile* Hook)
+{
+	if (GetCharacterState() == CharacterState::SWINGING && Hook == SwingProjectile)
+	{
+		SetCharacterState(GetUnhookedState());
+	}
 }
 
-void AGrapplingHookTestCharacter::Grounded_Update()
+CharacterState AGrapplingHookTestCharacter::GetUnhookedState() const
 {
-	if (Projectile->GetProjectileState() == ProjectileState::HOOKED)
-		SetCharacterState(CharacterState::SWINGING);
+	const UGrappleCharacterMovementComponent* Movement = Cast<UGrappleCharacterMovementComponent>(GetCharacterMovement());
+	const bool bAirborne = GetCharacterMovement()->IsFalling() || (Movement != nullptr && Movement->IsSwinging());
+	return bAirborne ? CharacterState::JUMPING : CharacterState::GROUNDED;
 }
 
 void AGrapplingHookTestCharacter::Swinging_Enter()
 {
-	GetCharacterMovement()->StopMovementImmediately();
-	GetCharacterMovement()->GravityScale = 0.f;
-
-	FVector  ropeVector = Projectile->GetRopeVector();
-	ropeVector.Normalize();
-	float startAngle = -FMath::Acos(ropeVector | GetActorUpVector());
-	FVector velocity = GetVelocity() * ;
-	FVector forwardVec = GetActorForwardVector();
-	float projectedVelToFVec = FVector::DotProduct(velocity, forwardVec);
-	FVector bottomTriangle = forwardVec * projectedVelToFVec;
-	FVector triangleOpposite = -ropeVector + bottomTriangle;
-	float angleWithLength = FVector::DotProduct(ropeVector, triangleOpposite);
-	float angleWithoutLength = angleWithLength / (ropeVector.Size() * triangleOpposite.Size());
-	float angle = FMath::Acos(angleWithoutLength);
-	//float startVelocity = FVector::DotProduct(GetVelocity(), GetActorForwardVector());
-	//startVelocity = FMath::Acos(FVector::DotProduct(ropeVector, GetActorForwardVector() * startVelocity)) / (ropeVector.Size() * (GetActorForwardVector() * startVelocity).Size());
-	PendulumVar = Pendulum(Projectile->GetCollisionComp()->GetComponentLocation(), angleWithoutLength, startAngle, Projectile->GetRopeLength(), GetWorld()->GetGravityZ(), ropeVector.X, ropeVector.Y);
-	
-	StateStepVar = StateStep::ON_UPDATE;
+	// The swing starts where we are, our velocity becomes the swing speed minus the part along the rope
+	// Steering is relative to where we face now, the basis is built once for the whole swing
+	// Our movement steps the pendulum move by move, unless we are a simulated proxy that does not run moves
+	UGrappleSubsystem* GrappleSubsystem = GetWorld()->GetSubsystem<UGrappleSubsystem>();
+	SwingForward = GetActorForwardVector();
+	PendulumHandle = GrappleSubsystem->AddPendulum(SwingProjectile->GetCollisionComp()->GetComponentLocation(), GetActorLocation(), GetVelocity(), SwingForward, GetWorld()->GetGravityZ(), SwingSteerAcceleration, GetLocalRole() != ROLE_SimulatedProxy);
+	SwingInput = SwingSteering = FVector2D::ZeroVector;
+
+	// From now on the movement component follows the pendulum
+	GetCharacterMovement()->SetMovementMode(MOVE_Custom, static_cast<uint8>(EGrappleMovementMode::Swinging));
+
+	// The swing replicates through NetState, other clients step it themselves instead of receiving transforms
+	if (HasAuthority())
+	{
+		SetReplicateMovement(false);
+	}
 }
 
-void AGrapplingHookTestCharacter::Swinging_Update(float deltaTime)
+void AGrapplingHookTestCharacter::Swinging_Exit()
 {
-	GetCharacterMovement()->StopMovementImmediately();
-	PendulumVar.update(deltaTime);
-	
-	SetActorLocation(PendulumVar.GetPosition() /*+ MuzzleLocation->GetComponentLocation()*/);
+	UGrappleSubsystem* GrappleSubsystem = GetWorld()->GetSubsystem<UGrappleSubsystem>();
+	if (GrappleSubsystem != nullptr)
+	{
+		GrappleSubsystem->RemovePendulum(PendulumHandle);
+	}
+	PendulumHandle = GrappleCore::SphericalPendulumTiers::InvalidHandle;
+	SwingInput = SwingSteering = FVector2D::ZeroVector;
+	SwingProjectile = nullptr;
+
+	// Letting go keeps the swing velocity, the fall starts from it
+	if (GetCharacterMovement()->MovementMode == MOVE_Custom)
+	{
+		GetCharacterMovement()->SetMovementMode(MOVE_Falling);
+	}
+
+	if (HasAuthority())
+	{
+		SetReplicateMovement(true);
+	}
+}
+
+void AGrapplingHookTestCharacter::UpdateNetState()
+{
+	if (!HasAuthority() || GetNetMode() == NM_Standalone)
+		return;
+
+	FGrappleNetState NewState;
+	NewState.SetHookCount(Projectiles.Num());
+	for (int32 HookIndex = 0; HookIndex < NewState.GetHookCount(); ++HookIndex)
+	{
+		NewState.SetHookState(HookIndex, Projectiles[HookIndex]->GetProjectileState());
+	}
+	NewState.InputId = LastInputId;
+
+	const int32 SwingHook = Projectiles.Find(SwingProjectile);
+	FVector SwingOffset, SwingVelocity;
+	if (SwingHook != INDEX_NONE && SwingHook < NewState.GetHookCount()
+		&& GetWorld()->GetSubsystem<UGrappleSubsystem>()->GetSwingState(this, SwingOffset, SwingVelocity))
+	{
+		NewState.bSwinging = true;
+		NewState.SwingHook = static_cast<uint8>(SwingHook);
+		NewState.Anchor = SwingProjectile->getHookPosition();
+		NewState.SetSwing(SwingOffset, SwingVelocity);
+	}
+
+	NetState = NewState;
+	NetSwingAge = 0.f;
+}
+
+void AGrapplingHookTestCharacter::UpdateNetSwing(float DeltaTime, float Interval)
+{
+	NetSwingAge += DeltaTime;
+	if (NetSwingAge >= Interval)
+	{
+		UpdateNetState();
+	}
+}
+
+void AGrapplingHookTestCharacter::OnRep_NetState()
+{
+	// The server has not seen all our inputs yet, what it sent is already outdated here
+	const bool bPredicting = IsLocallyControlled();
+	if (bPredicting && NetState.InputId != LastInputId)
+		return;
+
+	bool bReanchored = false;
+	const int32 HookCount = FMath::Min(NetState.GetHookCount(), Projectiles.Num());
+	for (int32 HookIndex = 0; HookIndex < HookCount; ++HookIndex)
+	{
+		AGrapplingHookTestProjectile* Hook = Projectiles[HookIndex];
+		const ProjectileState ServerState = NetState.GetHookState(HookIndex);
+		if (bPredicting && IsHookStateAhead(Hook->GetProjectileState(), ServerState))
+			continue;
+
+		// Only the swing hook's anchor is replicated, other hooked hooks stay where they hooked here
+		FVector HookLocation = Hook->getHookPosition();
+		if (NetState.bSwinging && NetState.SwingHook == HookIndex && !HookLocation.Equals(NetState.Anchor, NetAnchorTolerance))
+		{
+			HookLocation = NetState.Anchor;
+			bReanchored = Hook->GetProjectileState() == ProjectileState::HOOKED;
+		}
+		Hook->ApplyNetState(ServerState, HookLocation);
+	}
+
+	if (!NetState.bSwinging || GetCharacterState() != CharacterState::SWINGING || !Projectiles.IsValidIndex(NetState.SwingHook) || SwingProjectile != Projectiles[NetState.SwingHook])
+		return;
+
+	// Our own swing is ahead of the server's, it only moves to the server's anchor and keeps its motion
+	UGrappleSubsystem* GrappleSubsystem = GetWorld()->GetSubsystem<UGrappleSubsystem>();
+	if (bPredicting)
+	{
+		if (bReanchored)
+		{
+			GrappleSubsystem->SetSwingState(this, NetState.Anchor, GetActorLocation() - NetState.Anchor, GetVelocity());
+		}
+		return;
+	}
+
+	FVector SwingOffset, SwingVelocity;
+	NetState.GetSwing(SwingOffset, SwingVelocity);
+	GrappleSubsystem->SetSwingState(this, NetState.Anchor, SwingOffset, SwingVelocity);
 }
 
 void AGrapplingHookTestCharacter::OnFire()
 {
-	// try and fire a projectile
-	if (Projectile != nullptr)
+	// Input is gathered once a frame, a press waited half of the last one on average
+	FireInput(GetWorld()->GetDeltaSeconds() * 0.5f);
+}
+
+void AGrapplingHookTestCharacter::FireInput(float ElapsedTime)
+{
+	// No hook to fire until the projectile class streamed in
+	if (!bAssetsReady)
+		return;
+
+	UGrappleSubsystem* GrappleSubsystem = GetWorld()->GetSubsystem<UGrappleSubsystem>();
+	GrappleSubsystem->GetRecorder().RecordInput(this, GrappleRecording::EInput::Fire);
+
+	// The hook flies from the start of the frame, it catches up the time that went by since the input
+	const float LeadTime = FMath::Clamp(ElapsedTime, 0.f, MaxFireLeadTime);
+
+	// The server fires as well and corrects us if its hook went somewhere else
+	FireHook(GrappleSubsystem->GetFrameStartTime() - ElapsedTime, LeadTime);
+	if (!HasAuthority())
 	{
-		Projectile->Fire();
+		// The shot comes before the move after the last one stamped, the server lines it up with our moves from there
+		const FNetworkPredictionData_Client_Character* ClientData = GetCharacterMovement()->GetPredictionData_Client_Character();
+		ServerFire(++LastInputId, ClientData != nullptr ? ClientData->CurrentTimeStamp - LeadTime : 0.f);
 	}
 
+	// Nobody hears or sees the shot on a dedicated server
+	if (!GrappleSubsystem->AreCosmeticsEnabled())
+		return;
+
 	// try and play the sound if specified
-	if (FireSound != nullptr)
+	if (USoundBase* Sound = FireSound.Get())
 	{
-		UGameplayStatics::PlaySoundAtLocation(this, FireSound, GetActorLocation());
+		UGameplayStatics::PlaySoundAtLocation(this, Sound, GetActorLocation());
 	}
 
 	// try and play a firing animation if specified
-	if (FireAnimation != nullptr)
+	if (UAnimMontage* Montage = FireAnimation.Get())
 	{
 		// Get the animation object for the arms mesh
 		UAnimInstance* AnimInstance = SkeletalMesh->GetAnimInstance();
 		if (AnimInstance != nullptr)
 		{
-			AnimInstance->Montage_Play(FireAnimation, 1.f);
+			AnimInstance->Montage_Play(Montage, 1.f);
 		}
 	}
 }
 
 void AGrapplingHookTestCharacter::OnRetract()
 {
-	// try and fire the projectile
-	if (Projectile != nullptr)
+	GetWorld()->GetSubsystem<UGrappleSubsystem>()->GetRecorder().RecordInput(this, GrappleRecording::EInput::Retract);
+
+	RetractHooks();
+	if (!HasAuthority())
 	{
-		Projectile->Retract();
+		ServerRetract(++LastInputId);
 	}
 }
 
+bool AGrapplingHookTestCharacter::FireHook(float InputTime, float LeadTime)
+{
+	// try and fire the first docked hook
+	for (AGrapplingHookTestProjectile* Hook : Projectiles)
+	{
+		if (Hook->FireFromInput(InputTime, LeadTime))
+			return true;
+	}
+	return false;
+}
+
+void AGrapplingHookTestCharacter::RetractHooks()
+{
+	// try and retract every hook that is out
+	for (AGrapplingHookTestProjectile* Hook : Projectiles)
+	{
+		Hook->Retract();
+	}
+}
+
+bool AGrapplingHookTestCharacter::ServerFire_Validate(uint8 InputId, float ClientTimeStamp)
+{
+	return FMath::IsFinite(ClientTimeStamp);
+}
+
+void AGrapplingHookTestCharacter::ServerFire_Implementation(uint8 InputId, float ClientTimeStamp)
+{
+	LastInputId = InputId;
+
+	// Moves the server already ran past the shot moved the character without its hook, the hook catches up.
+	// A shot ahead of the moves, or a timestamp from before the client's clock reset, launches from the dock.
+	const FNetworkPredictionData_Server_Character* ServerData = GetCharacterMovement()->GetPredictionData_Server_Character();
+	const float Lead = ServerData != nullptr ? ServerData->CurrentClientTimeStamp - ClientTimeStamp : 0.f;
+	const float LeadTime = Lead > 0.f && Lead <= MaxFireLeadTime ? Lead : 0.f;
+
+	FireHook(GetWorld()->GetSubsystem<UGrappleSubsystem>()->GetFrameStartTime() - LeadTime, LeadTime);
+
+	// Acknowledges the input even when no hook was docked, the owner undoes its prediction then
+	UpdateNetState();
+}
+
+bool AGrapplingHookTestCharacter::ServerRetract_Validate(uint8 InputId)
+{
+	return true;
+}
+
+void AGrapplingHookTestCharacter::ServerRetract_Implementation(uint8 InputId)
+{
+	LastInputId = InputId;
+	RetractHooks();
+	UpdateNetState();
+}
+
+void AGrapplingHookTestCharacter::SetSwingInput(float Forward, float Right)
+{
+	// The next moves pick it up, see UGrappleCharacterMovementComponent::ScaleInputAcceleration
+	const FVector2D NewInput(Forward, Right);
+	if (GetCharacterState() != CharacterState::SWINGING || NewInput == SwingInput)
+		return;
+
+	SwingInput = NewInput;
+	GetWorld()->GetSubsystem<UGrappleSubsystem>()->GetRecorder().RecordSwingInput(this, Forward, Right);
+}
+
 void AGrapplingHookTestCharacter::MoveForward(float Value)
 {
-	if (Value != 0.0f)
+	// The pendulum owns the movement while swinging
+	if (GetCharacterState() == CharacterState::SWINGING)
+	{
+		SetSwingInput(Value, SwingInput.Y);
+	}
+	else if (Value != 0.0f)
 	{
 		// add movement in that direction
 		AddMovementInput(GetActorForwardVector(), Value);
@@ -255,7 +574,11 @@ void AGrapplingHookTestCharacter::MoveForward(float Value)
 
 void AGrapplingHookTestCharacter::MoveRight(float Value)
 {
-	if (Value != 0.0f)
+	if (GetCharacterState() == CharacterState::SWINGING)
+	{
+		SetSwingInput(SwingInput.X, Value);
+	}
+	else if (Value != 0.0f)
 	{
 		// add movement in that direction
 		AddMovementInput(GetActorRightVector(), Value);
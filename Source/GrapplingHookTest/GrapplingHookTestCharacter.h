@@ -4,8 +4,12 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "Engine/StreamableManager.h"
 #include "GrapplingHookTestProjectile.h"
-#include "Pendulum.h"
+#include "GrappleStateMachine.h"
+#include "GrappleNetState.h"
+#include "GrappleSnapshot.h"
+#include "SphericalPendulumTiers.h"
 
 #include "GrapplingHookTestCharacter.generated.h"
 
@@ -34,28 +38,86 @@ class AGrapplingHookTestCharacter : public ACharacter
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	class UCameraComponent* FirstPersonCameraComponent;
 
-	UPROPERTY(VisibleDefaultsOnly, Category = Projectile)
-	class AGrapplingHookTestProjectile* Projectile;
+	/** Hooks taken from the world's hook pool, NumHooks of them */
+	UPROPERTY(VisibleInstanceOnly, Category = Projectile)
+	TArray<class AGrapplingHookTestProjectile*> Projectiles;
 
-	CharacterState CharacterStateVar = CharacterState::GROUNDED;
+	/** Hook the character is swinging from */
+	UPROPERTY(VisibleInstanceOnly, Category = Projectile)
+	class AGrapplingHookTestProjectile* SwingProjectile;
 
-	enum StateStep { ON_ENTER, ON_UPDATE };
-	StateStep StateStepVar;
+	/** Handle of this character's pendulum in the world's UGrappleSubsystem while swinging */
+	GrappleCore::SphericalPendulumTiers::FHandle PendulumHandle = GrappleCore::SphericalPendulumTiers::InvalidHandle;
 
-	Pendulum PendulumVar;
+	/** Steering held by the player, the replay or a bot, forward and right. Moves carry it as their acceleration. */
+	FVector2D SwingInput = FVector2D::ZeroVector;
 
-	void Update(float DeltaTime);
+	/** Steering of the last move that stepped the swing, back from its acceleration. The same on the owner and the server. */
+	FVector2D SwingSteering = FVector2D::ZeroVector;
+
+	/** Where the character faced when the swing started, steering is relative to it */
+	FVector SwingForward = FVector::ForwardVector;
+
+	/** Hook and swing state the server replicates instead of transforms, see FGrappleNetState */
+	UPROPERTY(ReplicatedUsing = OnRep_NetState)
+	FGrappleNetState NetState;
+
+	/** Owning client: last fire or retract sent to the server. Server: last one applied. */
+	uint8 LastInputId = 0;
+
+	/** Time since the swing was last written to NetState, on the server */
+	float NetSwingAge = 0.f;
+
+	/** Keeps the assets streamed in at BeginPlay loaded */
+	TSharedPtr<FStreamableHandle> StreamedAssets;
+	/** The projectile class and the cosmetics that are not stripped are loaded, the hooks are acquired */
+	bool bAssetsReady = false;
+	/** Time BeginPlay ran, the ready time is measured from it */
+	double BeginPlaySeconds = 0.0;
+
+	/** Grapple state at the end of each of the last frames, saved and restored by the grapple subsystem */
+	GrappleCore::SnapshotRing<GrappleCore::FCharacterSnapshot, 64> Snapshots;
 
 	void SetCharacterState(CharacterState newState);
 
+	// Reads the pendulum handle to drive the swing movement
+	friend class UGrappleSubsystem;
+
 public:
-	AGrapplingHookTestCharacter();
+	AGrapplingHookTestCharacter(const FObjectInitializer& ObjectInitializer);
+
+	/** Position in the grapple subsystem's per-state character lists */
+	FGrappleListLink GrappleListLink;
+
+	CharacterState GetCharacterState() const { return StateMachine.GetState(); }
+	const TArray<AGrapplingHookTestProjectile*>& GetHooks() const { return Projectiles; }
+	/** Time and CPU counters of one state of this character */
+	const FGrappleStateTimings& GetStateTimings(CharacterState State) const { return StateMachine.GetTimings(State); }
+
+	/** Server: writes the hook states, and the swing if any, to the replicated NetState */
+	void UpdateNetState();
+	/** Server: refreshes the swing in NetState once it is older than Interval, clients extrapolate in between */
+	void UpdateNetSwing(float DeltaTime, float Interval);
+
+	/** False until BeginPlay's assets streamed in, firing does nothing before */
+	bool AreAssetsReady() const { return bAssetsReady; }
+	/**
+	 * Loads the assets BeginPlay streams, cosmetics included, and keeps them loaded while the handle lives.
+	 * For headless tools that fire as soon as they spawn, on the class default object.
+	 */
+	TSharedPtr<FStreamableHandle> LoadStreamedAssets() const;
 
 protected:
 	virtual void BeginPlay();
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	UFUNCTION()
 	virtual void Tick(float DeltaTime) override;
 
+	/** Moves between GROUNDED and JUMPING when the movement component starts or stops falling */
+	virtual void OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PreviousCustomMode = 0) override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 public:
 	/** Base turn rate, in deg/sec. Other scaling may affect final turn rate. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera)
@@ -69,27 +131,56 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
 	FVector GunOffset;
 
-	/** Projectile class to spawn */
+	/** Projectile class to spawn, streamed in at BeginPlay */
+	UPROPERTY(EditDefaultsOnly, Category = Projectile)
+	TSoftClassPtr<class AGrapplingHookTestProjectile> ProjectileClass;
+
+	/** Acceleration of full steering input while swinging, in cm/s^2 */
+	UPROPERTY(EditDefaultsOnly, Category = Gameplay)
+	float SwingSteerAcceleration = 600.f;
+
+	/**
+	 * Longest time a shot can have been fired before the frame it launches in, or on the server before the server's
+	 * moves of that client got there. The hook catches up that far along its path. Older or inconsistent timestamps
+	 * launch without lead.
+	 */
 	UPROPERTY(EditDefaultsOnly, Category = Projectile)
-	TSubclassOf<class AGrapplingHookTestProjectile> ProjectileClass;
+	float MaxFireLeadTime = 0.25f;
 
-	/** Sound to play each time we fire */
+	/** Number of hooks the character can have out at the same time, at most GrappleCore::MaxHooksPerCharacter */
+	UPROPERTY(EditDefaultsOnly, Category = Projectile, meta = (ClampMin = "0", ClampMax = "8"))
+	int32 NumHooks = 1;
+
+	/** Sound to play each time we fire, streamed in at BeginPlay unless cosmetics are stripped */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
-	class USoundBase* FireSound;
+	TSoftObjectPtr<class USoundBase> FireSound;
 
-	/** AnimMontage to play each time we fire */
+	/** AnimMontage to play each time we fire, streamed in at BeginPlay unless cosmetics are stripped */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
-	class UAnimMontage* FireAnimation;
+	TSoftObjectPtr<class UAnimMontage> FireAnimation;
 
 	/** Whether to use motion controller location for aiming. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
 	uint32 bUsingMotionControllers : 1;
 
-protected:
-
-	/** Fires a projectile. */
+	/**
+	 * Fires a projectile. Bound to input, also called by the replay.
+	 * Owning clients fire and retract right away and tell the server, which has the last word.
+	 */
 	void OnFire();
+	/**
+	 * Fires for an input ElapsedTime seconds before the start of the frame the hook launches in, the hook catches up
+	 * that far along its path. Called by OnFire, and by the benchmark bots with the exact time of their shots.
+	 */
+	void FireInput(float ElapsedTime);
 	void OnRetract();
+	/**
+	 * Steers the swing along the basis taken when the hook grabbed: forward is where the character faced, right orbits
+	 * the anchor. Fed by MoveForward and MoveRight while swinging, and by the replay. Ignored when not swinging.
+	 */
+	void SetSwingInput(float Forward, float Right);
+
+protected:
 
 	/** Handles moving forward/backward */
 	void MoveForward(float Val);
@@ -122,13 +213,47 @@ public:
 
 private:
 
-	void Grounded_Enter();
-	void Grounded_Update();
-	void Grounded_Exit();
+	/** Launches the first docked hook LeadTime seconds along its path for an input at InputTime, false if none was docked */
+	bool FireHook(float InputTime, float LeadTime);
+	void RetractHooks();
+
+	void GetStreamedAssetPaths(bool bCosmetics, TArray<FSoftObjectPath>& OutPaths) const;
+	/** Takes the hooks from the pool and catches up with the replicated state */
+	void OnAssetsLoaded();
+
+	/** ClientTimeStamp is where the shot falls on the timeline of the client's moves */
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerFire(uint8 InputId, float ClientTimeStamp);
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerRetract(uint8 InputId);
+
+	/**
+	 * Rebuilds the hooks and the swing from the server's state. Simulated proxies follow it as is. The owner keeps its
+	 * prediction while the server has not applied all of its inputs, or when its hooks are one step ahead of the
+	 * server's, and only re-anchors a swing on a hook the server placed elsewhere. Its swing is corrected by the
+	 * movement component, see UGrappleCharacterMovementComponent::OnClientCorrectionReceived.
+	 */
+	UFUNCTION()
+	void OnRep_NetState();
+
+	/** Bound to every hook we own, starts swinging from the first hook that grabs onto something */
+	void OnHookHooked(AGrapplingHookTestProjectile* Hook);
+	void OnHookUnhooked(AGrapplingHookTestProjectile* Hook);
 
+	/** GROUNDED or JUMPING, whichever matches the movement component. Swinging movement counts as falling. */
+	CharacterState GetUnhookedState() const;
+
+	/** Swinging moves in UGrappleCharacterMovementComponent, the state only switches the movement mode in and out */
 	FORCENOINLINE void Swinging_Enter();
-	void Swinging_Update(float deltaTime);
 	void Swinging_Exit();
 
+	typedef AGrapplingHookTestCharacter FCharacter;
+	typedef TGrappleStateMachine<FCharacter, CharacterState,
+		TGrappleState<CharacterState, CharacterState::GROUNDED, FCharacter>,
+		TGrappleState<CharacterState, CharacterState::JUMPING, FCharacter>,
+		TGrappleState<CharacterState, CharacterState::SWINGING, FCharacter, &FCharacter::Swinging_Enter, nullptr, &FCharacter::Swinging_Exit>
+	> FStateMachine;
+
+	FStateMachine StateMachine;
 };
 
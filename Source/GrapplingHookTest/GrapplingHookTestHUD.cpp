@@ -1,17 +1,24 @@
 // Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
 
 #include "GrapplingHookTestHUD.h"
+#include "Engine/AssetManager.h"
 #include "Engine/Canvas.h"
+#include "Engine/StreamableManager.h"
 #include "Engine/Texture2D.h"
 #include "TextureResource.h"
 #include "CanvasItem.h"
-#include "UObject/ConstructorHelpers.h"
 
 AGrapplingHookTestHUD::AGrapplingHookTestHUD()
 {
-	// Set the crosshair texture
-	static ConstructorHelpers::FObjectFinder<UTexture2D> CrosshairTexObj(TEXT("/Game/FirstPerson/Textures/FirstPersonCrosshair"));
-	CrosshairTex = CrosshairTexObj.Object;
+	// Set the crosshair texture, it is only loaded once the HUD plays
+	CrosshairTex = TSoftObjectPtr<UTexture2D>(FSoftObjectPath(TEXT("/Game/FirstPerson/Textures/FirstPersonCrosshair.FirstPersonCrosshair")));
+}
+
+void AGrapplingHookTestHUD::BeginPlay()
+{
+	Super::BeginPlay();
+
+	CrosshairHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(CrosshairTex.ToSoftObjectPath());
 }
 
 
@@ -19,6 +26,10 @@ void AGrapplingHookTestHUD::DrawHUD()
 {
 	Super::DrawHUD();
 
+	UTexture2D* Crosshair = CrosshairTex.Get();
+	if (Crosshair == nullptr)
+		return;
+
 	// Draw very simple crosshair
 
 	// find center of the Canvas
@@ -29,7 +40,7 @@ void AGrapplingHookTestHUD::DrawHUD()
 										   (Center.Y + 20.0f));
 
 	// draw the crosshair
-	FCanvasTileItem TileItem( CrosshairDrawPosition, CrosshairTex->Resource, FLinearColor::White);
+	FCanvasTileItem TileItem( CrosshairDrawPosition, Crosshair->Resource, FLinearColor::White);
 	TileItem.BlendMode = SE_BLEND_Translucent;
 	Canvas->DrawItem( TileItem );
 }
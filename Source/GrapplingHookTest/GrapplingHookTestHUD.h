@@ -17,9 +17,16 @@ public:
 	/** Primary draw call for the HUD */
 	virtual void DrawHUD() override;
 
+protected:
+	/** Streams the crosshair in */
+	virtual void BeginPlay() override;
+
 private:
-	/** Crosshair asset pointer */
-	class UTexture2D* CrosshairTex;
+	/** Crosshair asset pointer, nothing is drawn until it streamed in */
+	TSoftObjectPtr<class UTexture2D> CrosshairTex;
+
+	/** Keeps the crosshair loaded */
+	TSharedPtr<struct FStreamableHandle> CrosshairHandle;
 
 };
 
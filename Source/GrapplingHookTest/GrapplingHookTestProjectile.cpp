@@ -1,10 +1,29 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "GrapplingHookTestProjectile.h"
-
-#include "GameFramework/ProjectileMovementComponent.h"
+#include "GrappleCoreConversions.h"
+#include "GrappleRopeManager.h"
+#include "GrappleSubsystem.h"
+#include "GrapplingHookTest.h"
+#include "HookBallistics.h"
+
+#include "Engine/CollisionProfile.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "UObject/ConstructorHelpers.h"
+
+DECLARE_CYCLE_STAT(TEXT("Hook Tick"), STAT_GrappleHookTick, STATGROUP_Grapple);
+DECLARE_CYCLE_STAT(TEXT("Hook State Transition"), STAT_GrappleHookTransition, STATGROUP_Grapple);
+DECLARE_CYCLE_STAT(TEXT("Rope Update"), STAT_GrappleRopeUpdate, STATGROUP_Grapple);
+DECLARE_CYCLE_STAT(TEXT("Rope Simulation"), STAT_GrappleRopeSimulation, STATGROUP_Grapple);
+DECLARE_CYCLE_STAT(TEXT("Hook Flight"), STAT_GrappleHookFlight, STATGROUP_Grapple);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hook Updates Skipped"), STAT_GrappleHookUpdatesSkipped, STATGROUP_Grapple);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hook Flight Sweeps"), STAT_GrappleHookFlightSweeps, STATGROUP_Grapple);
 
 AGrapplingHookTestProjectile::AGrapplingHookTestProjectile()
+	: StateMachine(ProjectileState::DOCKED)
 {
 	PrimaryActorTick.bCanEverTick = true;
 	SetActorTickEnabled(true);
@@ -12,156 +31,383 @@ AGrapplingHookTestProjectile::AGrapplingHookTestProjectile()
 	// Use a sphere as a simple collision representation
 	CollisionComp = CreateDefaultSubobject<USphereComponent>(TEXT("SphereComp"));
 	CollisionComp->InitSphereRadius(5.0f);
-	CollisionComp->OnComponentHit.AddDynamic(this, &AGrapplingHookTestProjectile::OnHit);		// set up a notification for when this component hits something blocking
+	// Nothing collides with the hook, its flight sweeps the GrappleHook trace channel itself
+	CollisionComp->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
 
 	// Players can't walk on it
 	CollisionComp->SetWalkableSlopeOverride(FWalkableSlopeOverride(WalkableSlope_Unwalkable, 0.f));
 	CollisionComp->CanCharacterStepUpOn = ECB_No;
 
-	Rope = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Rope"));
-	Rope->SetupAttachment(CollisionComp);
-
-	Rope->SetWorldScale3D(FVector(0.f, 0.f, 0.f));
+	// The rope has no component of its own, the world's rope manager draws it. Dedicated servers draw none.
+	if (!IsRunningDedicatedServer())
+	{
+		static ConstructorHelpers::FObjectFinder<UStaticMesh> RopeMeshObj(TEXT("/Engine/BasicShapes/Cylinder"));
+		RopeMesh = RopeMeshObj.Object;
+	}
 	
 	// Set as root component
 	RootComponent = CollisionComp;
-
-	// Use a ProjectileMovementComponent to govern this projectile's movement
-	ProjectileMovement = CreateDefaultSubobject<UProjectileMovementComponent>(TEXT("ProjectileComp"));
-	ProjectileMovement->UpdatedComponent = CollisionComp;
-	ProjectileMovement->bRotationFollowsVelocity = true;
-	ProjectileMovement->bShouldBounce = true;
-
-	SetProjectileState(ProjectileState::DOCKED);
 }
 
 void AGrapplingHookTestProjectile::Init(USceneComponent* dockPosition)
 {
 	DockPosition = dockPosition;
 
-	UStaticMesh* staticMesh = Rope->GetStaticMesh();
-	if (staticMesh)
+	RopeSim.SetIterations(RopeIterations);
+
+	SetActorHiddenInGame(false);
+	StateMachine.Start(*this, ProjectileState::DOCKED);
+
+	// The rope follows the dock, update it after the owner and its movement moved
+	AActor* owner = GetOwner();
+	if (owner != nullptr)
+	{
+		AddTickPrerequisiteActor(owner);
+		if (ACharacter* ownerCharacter = Cast<ACharacter>(owner))
+		{
+			AddTickPrerequisiteComponent(ownerCharacter->GetCharacterMovement());
+		}
+	}
+
+	// The subsystem decides whether we tick on our own or in its batch
+	GetWorld()->GetSubsystem<UGrappleSubsystem>()->RegisterHook(this);
+}
+
+void AGrapplingHookTestProjectile::Park()
+{
+	HideRope();
+
+	AActor* owner = GetOwner();
+	if (owner != nullptr)
+	{
+		RemoveTickPrerequisiteActor(owner);
+		if (ACharacter* ownerCharacter = Cast<ACharacter>(owner))
+		{
+			RemoveTickPrerequisiteComponent(ownerCharacter->GetCharacterMovement());
+		}
+	}
+
+	CollisionComp->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+
+	SetActorHiddenInGame(true);
+	SetActorTickEnabled(false);
+	GetWorld()->GetSubsystem<UGrappleSubsystem>()->UnregisterHook(this);
+
+	// Without a dock there is nothing to enter, Init enters DOCKED again
+	DockPosition = nullptr;
+	StateMachine.Reset(ProjectileState::DOCKED);
+}
+
+void AGrapplingHookTestProjectile::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	HideRope();
+
+	UGrappleSubsystem* grappleSubsystem = GetWorld()->GetSubsystem<UGrappleSubsystem>();
+	if (grappleSubsystem != nullptr)
 	{
-		float meshDiameterX = staticMesh->GetBoundingBox().GetExtent().X;
-		float meshDiameterY = staticMesh->GetBoundingBox().GetExtent().Y;
-		Rope->SetWorldScale3D(FVector(RopeDiameter / meshDiameterX, RopeDiameter / meshDiameterY, 0.f));
+		grappleSubsystem->UnregisterHook(this);
 	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
-void AGrapplingHookTestProjectile::Fire()
+bool AGrapplingHookTestProjectile::Fire(float LeadTime)
 {
-	if(ProjectileStateVar == ProjectileState::DOCKED)
-		SetProjectileState(ProjectileState::LAUNCHING);
+	if (GetProjectileState() != ProjectileState::DOCKED)
+		return false;
+
+	// Launching_Enter runs now, the next update flies the whole frame on top of the lead
+	// Only the hook catches up, the rope is stepped once by that update
+	SetProjectileState(ProjectileState::LAUNCHING);
+	if (LeadTime > 0.f && GetProjectileState() == ProjectileState::LAUNCHING)
+	{
+		MeasureLaunch(GetWorld()->GetSubsystem<UGrappleSubsystem>()->GetFrameStartTime() - LeadTime, LeadTime);
+		FlyOrHook(LeadTime);
+	}
+	return true;
+}
+
+bool AGrapplingHookTestProjectile::FireFromInput(float InputTime, float LeadTime)
+{
+	if (GetProjectileState() != ProjectileState::DOCKED)
+		return false;
+
+	// A launch at the frame start, as without a lead, would start flying this much after the input
+	bMeasureLaunch = true;
+	LaunchInputTime = InputTime;
+	LaunchFrameStartTime = GetWorld()->GetSubsystem<UGrappleSubsystem>()->GetFrameStartTime();
+	return Fire(LeadTime);
 }
 
 void AGrapplingHookTestProjectile::Retract()
 {
-	if (ProjectileStateVar == ProjectileState::LAUNCHING || ProjectileStateVar == ProjectileState::HOOKED)
+	if (GetProjectileState() == ProjectileState::LAUNCHING || GetProjectileState() == ProjectileState::HOOKED)
 		SetProjectileState(ProjectileState::RETRACTING);
 }
 
-void AGrapplingHookTestProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+void AGrapplingHookTestProjectile::ApplyReplayedState(ProjectileState newState)
 {
-	if (ProjectileStateVar == ProjectileState::LAUNCHING)
-		SetProjectileState(ProjectileState::HOOKED);
+	if (GetProjectileState() != newState)
+		SetProjectileState(newState);
 }
 
-void AGrapplingHookTestProjectile::Tick(float DeltaTime)
+void AGrapplingHookTestProjectile::ApplyNetState(ProjectileState newState, const FVector& hookedLocation)
+{
+	if (newState != ProjectileState::HOOKED)
+	{
+		ApplyReplayedState(newState);
+		return;
+	}
+
+	// Hooked_Enter measures the rope from where the hook is
+	SetActorLocation(hookedLocation);
+	if (GetProjectileState() == ProjectileState::HOOKED)
+	{
+		RopeSim.SetRestLength(GetRopeLength() * RopeSlack);
+		return;
+	}
+	SetProjectileState(ProjectileState::HOOKED);
+}
+
+void AGrapplingHookTestProjectile::SaveSnapshot(GrappleCore::FHookSnapshot& OutSnapshot) const
 {
-	Update(DeltaTime);
+	OutSnapshot.Location = ToGrappleCore(GetActorLocation());
+	OutSnapshot.FlightVelocity = ToGrappleCore(FlightVelocity);
+	OutSnapshot.RopeRestLength = RopeSim.GetRestLength();
+	OutSnapshot.State = static_cast<uint8>(GetProjectileState());
 }
 
-void AGrapplingHookTestProjectile::Update(float DeltaTime)
+void AGrapplingHookTestProjectile::RestoreSnapshot(const GrappleCore::FHookSnapshot& Snapshot)
 {
-	if (ProjectileStateVar == ProjectileState::DOCKED)
+	// Moved before the state changes, Hooked_Enter measures the rope from there. Docked_Enter snaps to the dock.
+	const ProjectileState newState = static_cast<ProjectileState>(Snapshot.State);
+	if (newState != ProjectileState::DOCKED)
 	{
-		if (StateStepVar == StateStep::ON_ENTER) {
-			Docked_Enter();
-		}
-		if (StateStepVar == StateStep::ON_UPDATE) {
-			//Docked_Update();
-		}
+		SetActorLocation(ToUnreal(Snapshot.Location));
 	}
+	ApplyReplayedState(newState);
 
-	if (ProjectileStateVar == ProjectileState::LAUNCHING)
+	FlightVelocity = ToUnreal(Snapshot.FlightVelocity);
+	RopeSim.SetRestLength(Snapshot.RopeRestLength);
+	if (newState == ProjectileState::LAUNCHING)
 	{
-		if (StateStepVar == StateStep::ON_ENTER) {
-			Launching_Enter();
-		}
-		if (StateStepVar == StateStep::ON_UPDATE) {
-			Launching_Update();
-		}
+		SetActorRotation(FlightVelocity.ToOrientationQuat());
 	}
+}
 
-	if (ProjectileStateVar == ProjectileState::RETRACTING)
+void AGrapplingHookTestProjectile::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GrappleHookTick);
+	CSV_SCOPED_TIMING_STAT(Grapple, HookTick);
+	FGrappleCycleScope HookScope(GetWorld()->GetSubsystem<UGrappleSubsystem>()->GetFrameTimings().HookCycles);
+
+	float updateTime;
+	if (ConsumeUpdateTime(DeltaTime, updateTime))
 	{
-		if (StateStepVar == StateStep::ON_ENTER) {
-			Retracting_Enter();
-		}
-		if (StateStepVar == StateStep::ON_UPDATE) {
-			Retracting_Update(DeltaTime);
-		}
+		StateMachine.Update(*this, updateTime);
 	}
+}
 
-	if (ProjectileStateVar == ProjectileState::HOOKED)
+void AGrapplingHookTestProjectile::SetSignificance(int32 UpdateInterval, int32 MaxRopeSegments)
+{
+	SignificanceUpdateInterval = FMath::Max(UpdateInterval, 1);
+	SignificanceRopeSegments = FMath::Max(MaxRopeSegments, 0);
+}
+
+bool AGrapplingHookTestProjectile::ConsumeUpdateTime(float DeltaTime, float& OutDeltaTime)
+{
+	SkippedUpdateTime += DeltaTime;
+
+	// Spread over the frames so hooks of the same bucket do not all update together
+	if (SignificanceUpdateInterval > 1 && (GFrameCounter + GetUniqueID()) % SignificanceUpdateInterval != 0)
 	{
-		if (StateStepVar == StateStep::ON_ENTER) {
-			Hooked_Enter();
-		}
-		if (StateStepVar == StateStep::ON_UPDATE) {
-			Hooked_Update();
-		}
+		INC_DWORD_STAT(STAT_GrappleHookUpdatesSkipped);
+		CSV_CUSTOM_STAT(Grapple, HookUpdatesSkipped, 1, ECsvCustomStatOp::Accumulate);
+		return false;
 	}
+
+	OutDeltaTime = SkippedUpdateTime;
+	SkippedUpdateTime = 0.f;
+	return true;
 }
 
-void AGrapplingHookTestProjectile::UpdateRope()
+void AGrapplingHookTestProjectile::ShowRope()
 {
-	CollisionComp->SetWorldRotation(FRotator::ZeroRotator);
-	
-	// Scale
-	float newRopeHeight = (CollisionComp->GetComponentLocation() - DockPosition->GetComponentLocation()).Size();
-	FVector previousScale = Rope->GetComponentScale();
-	Rope->SetWorldScale3D(FVector(previousScale.X, previousScale.Y, (newRopeHeight / 2) / Rope->GetStaticMesh()->GetBoundingBox().GetExtent().Z));
+	if (RopeId != INDEX_NONE)
+		return;
 
-	// Location
-	FVector newLocation = DockPosition->GetComponentLocation();
-	Rope->SetWorldLocation(newLocation);
+	UGrappleSubsystem* grappleSubsystem = GetWorld()->GetSubsystem<UGrappleSubsystem>();
+	RopeId = grappleSubsystem->GetRopeManager()->RegisterRope(RopeMesh);
+}
 
-	// Rotation
-	Rope->SetWorldRotation((CollisionComp->GetComponentLocation() - DockPosition->GetComponentLocation()).Rotation());
-	Rope->AddRelativeRotation(FRotator(-90.f, 0.f, 0.f));
+void AGrapplingHookTestProjectile::HideRope()
+{
+	if (RopeId == INDEX_NONE)
+		return;
+
+	UGrappleSubsystem* grappleSubsystem = GetWorld()->GetSubsystem<UGrappleSubsystem>();
+	AGrappleRopeManager* ropeManager = grappleSubsystem != nullptr ? grappleSubsystem->FindRopeManager() : nullptr;
+	if (ropeManager != nullptr)
+	{
+		ropeManager->UnregisterRope(RopeId);
+	}
+	RopeId = INDEX_NONE;
 }
 
-void AGrapplingHookTestProjectile::SetProjectileState(ProjectileState newState)
+void AGrapplingHookTestProjectile::UpdateRope(float DeltaTime, const FVector& RopeStart, const FVector& RopeEnd)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GrappleRopeUpdate);
+
+	// Only the flight rotates the hook
+	if (GetProjectileState() != ProjectileState::LAUNCHING && !CollisionComp->GetComponentQuat().IsIdentity())
+	{
+		CollisionComp->SetWorldRotation(FQuat::Identity);
+	}
+
+	// The rope is cosmetic, it catches up once a rollback is re-simulated
+	UGrappleSubsystem* grappleSubsystem = GetWorld()->GetSubsystem<UGrappleSubsystem>();
+	if (grappleSubsystem->IsResimulating())
+		return;
+
+	// Servers only need the hook point, nobody sees their ropes
+	if (!grappleSubsystem->AreCosmeticsEnabled())
+	{
+		HideRope();
+		return;
+	}
+
+	FGrappleCycleScope RopeScope(grappleSubsystem->GetFrameTimings().RopeCycles);
+
+	// Too far to be worth a rope, it comes back straight once the hook gets closer
+	const int32 desiredSegments = GetDesiredRopeSegments();
+	if (desiredSegments == 0)
+	{
+		HideRope();
+		return;
+	}
+
+	const bool bShown = RopeId == INDEX_NONE;
+	if (bShown)
+	{
+		ShowRope();
+		RopeSim.Reset(ToGrappleCore(RopeStart), ToGrappleCore(RopeEnd), desiredSegments);
+	}
+
+	AGrappleRopeManager* ropeManager = grappleSubsystem->FindRopeManager();
+	if (ropeManager == nullptr || RopeId == INDEX_NONE)
+		return;
+
+	// Ends are compared to the last applied update so slow drifts still add up
+	const float toleranceSquared = FMath::Square(RopeUpdateTolerance);
+	if (!bShown
+		&& desiredSegments == RopeSim.GetSegmentCount()
+		&& RopeSim.GetLastMaxStep() <= RopeUpdateTolerance
+		&& FVector::DistSquared(RopeStart, LastRopeStart) <= toleranceSquared
+		&& FVector::DistSquared(RopeEnd, LastRopeEnd) <= toleranceSquared)
+	{
+		ropeManager->SkipRopeUpdate(RopeId);
+		return;
+	}
+
+	RopeSim.SetSegmentCount(desiredSegments);
+	LastRopeStart = RopeStart;
+	LastRopeEnd = RopeEnd;
+
+	const GrappleCore::Vec3 gravity(0.f, 0.f, GetWorld()->GetGravityZ());
+	if (grappleSubsystem->IsBatchedTickEnabled())
+	{
+		grappleSubsystem->QueueRopeSimulation(this, DeltaTime, ToGrappleCore(RopeStart), ToGrappleCore(RopeEnd), gravity);
+		return;
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_GrappleRopeSimulation);
+		RopeSim.Update(DeltaTime, ToGrappleCore(RopeStart), ToGrappleCore(RopeEnd), gravity);
+	}
+	ApplyRope();
+}
+
+void AGrapplingHookTestProjectile::ApplyRope()
 {
-	// Append any GameStates you add to this example to this switch statement...
-	switch (ProjectileStateVar)
-	{
-	case ProjectileState::DOCKED:
-		//Docked_Exit();
-		break;
-	case ProjectileState::LAUNCHING:
-		//Launching_Exit();
-		break;
-	case ProjectileState::RETRACTING:
-		//Retracting_Exit();
-		break;
-	case ProjectileState::HOOKED:
-		//Hooked_Exit();
-		break;
-	default:
-		UE_LOG(LogTemp, Error, TEXT("Unexpected state has not been implemented!"), newState);
+	// The hook may have docked since its rope was queued
+	AGrappleRopeManager* ropeManager = GetWorld()->GetSubsystem<UGrappleSubsystem>()->FindRopeManager();
+	if (ropeManager == nullptr || RopeId == INDEX_NONE)
 		return;
+
+	const std::vector<GrappleCore::Vec3>& ropePoints = RopeSim.GetPositions();
+	ropeManager->UpdateRope(RopeId, ropePoints.data(), static_cast<int32>(ropePoints.size()), RopeDiameter);
+}
+
+int32 AGrapplingHookTestProjectile::GetDesiredRopeSegments() const
+{
+	const AGrappleRopeManager* ropeManager = GetWorld()->GetSubsystem<UGrappleSubsystem>()->FindRopeManager();
+	const int32 maxSegments = ropeManager != nullptr ? ropeManager->MaxSegmentsPerRope : RopeSegments;
+
+	// The subsystem gives the local player's own rope full detail
+	return FMath::Min3(RopeSegments, maxSegments, SignificanceRopeSegments);
+}
+
+bool AGrapplingHookTestProjectile::Fly(float DeltaTime, FHitResult& OutHit)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GrappleHookFlight);
+	FGrappleCycleScope FlightScope(FlightSweepCycles);
+
+	const GrappleCore::Vec3 gravity(0.f, 0.f, GetWorld()->GetGravityZ());
+	GrappleCore::Vec3 position = ToGrappleCore(GetActorLocation());
+	GrappleCore::Vec3 velocity = ToGrappleCore(FlightVelocity);
+
+	// Enough chords of FlightSweepLength to cover the distance flown, longer frames sweep longer chords past the cap
+	const float distance = velocity.Size() * DeltaTime + 0.5f * FMath::Abs(gravity.Z) * FMath::Square(DeltaTime);
+	const int32 sweepCount = FMath::Clamp(FMath::CeilToInt(distance / FMath::Max(FlightSweepLength, 1.f)), 1, FMath::Max(MaxFlightSweepsPerUpdate, 1));
+	const float stepTime = DeltaTime / sweepCount;
+
+	FCollisionQueryParams queryParams(SCENE_QUERY_STAT(GrappleHookFlight), false, this);
+	queryParams.AddIgnoredActor(GetOwner());
+	// A hook launched from inside something flies out of it rather than hooking where it starts
+	queryParams.bFindInitialOverlaps = false;
+	const FCollisionShape shape = FCollisionShape::MakeSphere(CollisionComp->GetScaledSphereRadius());
+
+	bool bHit = false;
+	int32 sweeps = 0;
+	while (sweeps < sweepCount && !bHit)
+	{
+		const FVector start = ToUnreal(position);
+		GrappleCore::HookBallistics::Step(position, velocity, gravity, stepTime, ProjectileSpeed);
+		++sweeps;
+
+		bHit = GetWorld()->SweepSingleByChannel(OutHit, start, ToUnreal(position), FQuat::Identity, ECC_GrappleHook, shape, queryParams)
+			&& !OutHit.bStartPenetrating;
 	}
 
-	// Set new GameStates state and begin OnEnter of that state
-	ProjectileStateVar = newState;
-	StateStepVar = StateStep::ON_ENTER;
+	FlightSweepCount += sweeps;
+	INC_DWORD_STAT_BY(STAT_GrappleHookFlightSweeps, sweeps);
+	CSV_CUSTOM_STAT(Grapple, HookFlightSweeps, sweeps, ECsvCustomStatOp::Accumulate);
+
+	if (bHit)
+		return true;
+
+	FlightVelocity = ToUnreal(velocity);
+	SetActorLocationAndRotation(ToUnreal(position), FlightVelocity.ToOrientationQuat());
+	return false;
 }
 
-ProjectileState AGrapplingHookTestProjectile::GetProjectileState()
+void AGrapplingHookTestProjectile::SetProjectileState(ProjectileState newState)
 {
-	return ProjectileStateVar;
+	SCOPE_CYCLE_COUNTER(STAT_GrappleHookTransition);
+
+	// Recorded before the enter handler runs, a replay starts the state from the same place
+	UGrappleSubsystem* grappleSubsystem = GetWorld()->GetSubsystem<UGrappleSubsystem>();
+	grappleSubsystem->GetRecorder().RecordTransition(this, newState);
+
+	// Frames skipped in the old state do not carry over
+	SkippedUpdateTime = 0.f;
+
+	// Exit and enter run right away, the new state is live this frame
+	StateMachine.SetState(*this, newState);
+
+	// Hooks registered while the lists are iterated are not linked yet, the lists still file them under this state
+	grappleSubsystem->OnHookStateChanged(this, GetProjectileState());
 }
 
 void AGrapplingHookTestProjectile::Docked_Enter()
@@ -169,79 +415,100 @@ void AGrapplingHookTestProjectile::Docked_Enter()
 	CollisionComp->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 	CollisionComp->SetEnableGravity(false);
 	AttachToComponent(DockPosition, FAttachmentTransformRules::SnapToTargetNotIncludingScale);
-	ProjectileMovement->StopMovementImmediately();
-	ProjectileMovement->ProjectileGravityScale = 0.f;
-	ProjectileMovement->MaxSpeed = 0.f;
 
 	SetActorLocation(DockPosition->GetComponentLocation());
 
-	Rope->SetVisibility(false);
-	
-	StateStepVar = StateStep::ON_UPDATE;
+	HideRope();
 }
 
-void AGrapplingHookTestProjectile::Launching_Enter()
+void AGrapplingHookTestProjectile::Docked_Exit()
 {
-	CollisionComp->SetCollisionProfileName("Projectile");
-	CollisionComp->SetEnableGravity(true);
 	DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
-	ProjectileMovement->ProjectileGravityScale = 1.f;
-	ProjectileMovement->MaxSpeed = ProjectileSpeed;
+}
 
-	ProjectileMovement->Velocity = GetActorRightVector() * ProjectileSpeed;
+void AGrapplingHookTestProjectile::Launching_Enter()
+{
+	// The hook flies itself in Launching_Update, nothing moves it in between
+	FlightVelocity = GetActorRightVector() * ProjectileSpeed;
+	FlightSweepCount = 0;
+	FlightSweepCycles = 0;
+}
 
-	Rope->SetVisibility(true);
-	
-	StateStepVar = StateStep::ON_UPDATE;
+void AGrapplingHookTestProjectile::MeasureLaunch(float FlightStartTime, float LeadTime)
+{
+	if (!bMeasureLaunch)
+		return;
+
+	bMeasureLaunch = false;
+	GetWorld()->GetSubsystem<UGrappleSubsystem>()->RecordLaunch(FlightStartTime - LaunchInputTime, LaunchFrameStartTime - LaunchInputTime, LeadTime);
 }
 
-void AGrapplingHookTestProjectile::Launching_Update()
+bool AGrapplingHookTestProjectile::FlyOrHook(float DeltaTime)
 {
-	UpdateRope();
+	FHitResult hit;
+	if (!Fly(DeltaTime, hit))
+		return true;
+
+	// Snapped onto the surface, the hooked rope gets its length from there
+	SetActorLocation(hit.ImpactPoint);
+	SetProjectileState(ProjectileState::HOOKED);
+	return false;
 }
 
-void AGrapplingHookTestProjectile::Retracting_Enter()
+void AGrapplingHookTestProjectile::Launching_Update(float DeltaTime)
 {
-	CollisionComp->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-	CollisionComp->SetEnableGravity(false);
-	ProjectileMovement->StopMovementImmediately();
-	ProjectileMovement->ProjectileGravityScale = 0.f;
-	ProjectileMovement->MaxSpeed = 0.f;
-	
-	StateStepVar = StateStep::ON_UPDATE;
+	// Updates fly the time up to now, skipped frames included
+	MeasureLaunch(GetWorld()->GetTimeSeconds() - DeltaTime, 0.f);
+	if (!FlyOrHook(DeltaTime))
+		return;
+
+	const FVector ropeStart = DockPosition->GetComponentLocation();
+	const FVector ropeEnd = CollisionComp->GetComponentLocation();
+
+	// The rope pays out with the hook
+	RopeSim.SetRestLength(FVector::Dist(ropeStart, ropeEnd) * RopeSlack);
+	UpdateRope(DeltaTime, ropeStart, ropeEnd);
 }
 
-void AGrapplingHookTestProjectile::Retracting_Update(float DeltaTime)
+void AGrapplingHookTestProjectile::Launching_Exit()
 {
-	FVector newPosition = GetActorLocation();
-	FVector direction = (DockPosition->GetComponentLocation() - GetActorLocation()).GetSafeNormal();
+	FlightVelocity = FVector::ZeroVector;
+	bMeasureLaunch = false;
 
-	newPosition += direction * (retractingSpeedinCMPerSec * DeltaTime);
-	SetActorLocation(newPosition);
-	
-	float distanceToDockingSquared = FVector::DistSquared(DockPosition->GetComponentLocation(), GetActorLocation());
+	UE_LOG(LogGrapple, Verbose, TEXT("%s flew with %d sweeps in %.3f ms"), *GetName(), FlightSweepCount, GetFlightSweepTime() * 1000.f);
+}
+
+void AGrapplingHookTestProjectile::Retracting_Update(float DeltaTime)
+{
+	const FVector ropeStart = DockPosition->GetComponentLocation();
+	const FVector ropeEnd = ToUnreal(GrappleCore::HookBallistics::Retract(ToGrappleCore(GetActorLocation()), ToGrappleCore(ropeStart), retractingSpeedinCMPerSec, DeltaTime));
+	SetActorLocation(ropeEnd);
 	
-	if (distanceToDockingSquared <= (RetractingToDockingDistance * RetractingToDockingDistance))
+	const float distanceToDocking = FVector::Dist(ropeStart, ropeEnd);
+	if (distanceToDocking <= RetractingToDockingDistance)
 	{
 		SetProjectileState(ProjectileState::DOCKED);
 		return;
 	}
 	
-	UpdateRope();
+	RopeSim.SetRestLength(distanceToDocking * RopeSlack);
+	UpdateRope(DeltaTime, ropeStart, ropeEnd);
 }
 
 void AGrapplingHookTestProjectile::Hooked_Enter()
 {
-	CollisionComp->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-	CollisionComp->SetEnableGravity(false);
-	ProjectileMovement->StopMovementImmediately();
-	ProjectileMovement->ProjectileGravityScale = 0.f;
-	ProjectileMovement->MaxSpeed = 0.f;
+	// The rope length is fixed once hooked, it sags when the owner gets closer to the hook
+	RopeSim.SetRestLength(GetRopeLength() * RopeSlack);
+
+	OnHooked.Broadcast(this);
+}
 
-	StateStepVar = StateStep::ON_UPDATE;
+void AGrapplingHookTestProjectile::Hooked_Update(float DeltaTime)
+{
+	UpdateRope(DeltaTime, DockPosition->GetComponentLocation(), CollisionComp->GetComponentLocation());
 }
 
-void AGrapplingHookTestProjectile::Hooked_Update()
+void AGrapplingHookTestProjectile::Hooked_Exit()
 {
-	UpdateRope();
+	OnUnhooked.Broadcast(this);
 }
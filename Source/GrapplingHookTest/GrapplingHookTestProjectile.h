@@ -5,10 +5,17 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "Components/SphereComponent.h"
+#include "GrappleSnapshot.h"
+#include "RopeSimulation.h"
+#include "GrappleStateLists.h"
+#include "GrappleStateMachine.h"
 #include "GrapplingHookTestProjectile.generated.h"
 
 enum class ProjectileState { DOCKED, LAUNCHING, RETRACTING, HOOKED };
 
+class AGrapplingHookTestProjectile;
+DECLARE_MULTICAST_DELEGATE_OneParam(FGrappleHookEvent, AGrapplingHookTestProjectile*);
+
 UCLASS(config = Game)
 class AGrapplingHookTestProjectile : public AActor
 {
@@ -18,18 +25,40 @@ class AGrapplingHookTestProjectile : public AActor
 	UPROPERTY(VisibleDefaultsOnly, Category = Projectile)
 	class USphereComponent* CollisionComp;
 
-	UPROPERTY(VisibleDefaultsOnly, Category = Projectile)
-	class UStaticMeshComponent* Rope;
+	/** Mesh stretched over every rope segment, all ropes of a world are drawn as instances of it by AGrappleRopeManager */
+	UPROPERTY(EditDefaultsOnly, Category = Projectile)
+	class UStaticMesh* RopeMesh;
 
 	UPROPERTY(EditDefaultsOnly, Category = Projectile)
 	float RopeDiameter = 1.f;
 
-	/** Projectile movement component */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
-	class UProjectileMovementComponent* ProjectileMovement;
+	/** Rope segments at full detail, far ropes use fewer, see UGrappleSubsystem::SignificanceBuckets */
+	UPROPERTY(EditDefaultsOnly, Category = Rope)
+	int32 RopeSegments = 16;
+
+	/** Constraint relaxation passes per frame */
+	UPROPERTY(EditDefaultsOnly, Category = Rope)
+	int32 RopeIterations = 4;
+
+	/** Rope rest length relative to the hook distance, above 1 lets the rope sag */
+	UPROPERTY(EditDefaultsOnly, Category = Rope)
+	float RopeSlack = 1.05f;
+
+	/** The rope is not simulated nor redrawn while its ends and particles move less than this, in cm */
+	UPROPERTY(EditDefaultsOnly, Category = Rope)
+	float RopeUpdateTolerance = 0.1f;
 
 	float ProjectileSpeed = 3000.f;
-	USceneComponent* DockPosition;
+
+	/** Longest chord of the flight arc covered by a single sweep, in cm. Shorter follows the arc closer with more sweeps. */
+	UPROPERTY(EditDefaultsOnly, Category = Projectile)
+	float FlightSweepLength = 100.f;
+
+	/** Sweeps per update at most, past it the chords get longer. The whole path is swept either way, nothing is skipped. */
+	UPROPERTY(EditDefaultsOnly, Category = Projectile)
+	int32 MaxFlightSweepsPerUpdate = 8;
+
+	USceneComponent* DockPosition = nullptr;
 
 	UPROPERTY(EditDefaultsOnly, Category = Projectile)
 	float retractingSpeedinCMPerSec = 300.f;
@@ -38,56 +67,139 @@ class AGrapplingHookTestProjectile : public AActor
 public:
 	AGrapplingHookTestProjectile();
 
+	/** Docks the hook on dockPosition and wakes it up, also used when it comes out of the hook pool */
 	void Init(USceneComponent* dockPosition);
+	/** Puts the hook to sleep while it waits in the hook pool */
+	void Park();
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
-	ProjectileState GetProjectileState();
+	ProjectileState GetProjectileState() const { return StateMachine.GetState(); }
+	/** Time and CPU counters of one state of this hook */
+	const FGrappleStateTimings& GetStateTimings(ProjectileState State) const { return StateMachine.GetTimings(State); }
 
 	FVector getHookPosition() { return CollisionComp->GetComponentLocation(); }
 
-	void Fire();
+	/**
+	 * Launches a docked hook right away, false if it was not docked. A shot fired LeadTime seconds before this call
+	 * flies that far along its path at once, as if it had launched on time.
+	 */
+	bool Fire(float LeadTime = 0.f);
+	/**
+	 * Fires as Fire does, for a fire input at simulation time InputTime. Once the hook first flies, the subsystem is
+	 * told how long after the input its flight starts, see UGrappleSubsystem::RecordLaunch.
+	 */
+	bool FireFromInput(float InputTime, float LeadTime);
 	void Retract();
-
-	/** called when projectile hits something */
-	UFUNCTION()
-	void OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
+	/** Forces a state read from a grapple recording, for the transitions the replay world cannot cause itself */
+	void ApplyReplayedState(ProjectileState newState);
+	/** Forces the state the server replicated. A hooked hook is moved to hookedLocation first and its rope measured there. */
+	void ApplyNetState(ProjectileState newState, const FVector& hookedLocation);
+
+	/** State, place and flight of the hook for a rollback snapshot, the rope is left out */
+	void SaveSnapshot(GrappleCore::FHookSnapshot& OutSnapshot) const;
+	void RestoreSnapshot(const GrappleCore::FHookSnapshot& Snapshot);
+
+	/** Detail picked by the grapple subsystem from the hook's distance to the viewers */
+	void SetSignificance(int32 UpdateInterval, int32 MaxRopeSegments);
+	/**
+	 * Whether the hook updates this frame. Far hooks only update once every few frames, OutDeltaTime then also covers
+	 * the frames they skipped.
+	 */
+	bool ConsumeUpdateTime(float DeltaTime, float& OutDeltaTime);
+
+	/** Sweeps of the current or last flight, and their game thread time in seconds */
+	int32 GetFlightSweepCount() const { return FlightSweepCount; }
+	float GetFlightSweepTime() const { return static_cast<float>(FPlatformTime::ToSeconds64(FlightSweepCycles)); }
+
+	/** Broadcast when the hook grabs onto something, so the owner does not have to poll */
+	FGrappleHookEvent OnHooked;
+	/** Broadcast when a hooked hook lets go */
+	FGrappleHookEvent OnUnhooked;
 
 	UFUNCTION()
 	virtual void Tick(float DeltaTime) override;
 
 	/** Returns CollisionComp subobject **/
 	FORCEINLINE class USphereComponent* GetCollisionComp() const { return CollisionComp; }
-	/** Returns ProjectileMovement subobject **/
-	FORCEINLINE class UProjectileMovementComponent* GetProjectileMovement() const { return ProjectileMovement; }
 	/** Returns Projectile's rope's length **/
 	FORCEINLINE FVector GetRopeVector() const { return CollisionComp->GetComponentLocation() - DockPosition->GetComponentLocation(); }
 	/** Returns Projectile's rope's length **/
 	FORCEINLINE float GetRopeLength() const { return (CollisionComp->GetComponentLocation() - DockPosition->GetComponentLocation()).Size(); }
 
-private:
-	ProjectileState ProjectileStateVar;
+	/** Position in the grapple subsystem's per-state hook lists */
+	FGrappleListLink GrappleListLink;
 
-	enum StateStep { ON_ENTER, ON_UPDATE };
-	StateStep StateStepVar;
-
-	void Update(float DeltaTime);
-	void UpdateRope();
+private:
+	// Drives the state machine directly when ticking is batched
+	friend class UGrappleSubsystem;
+
+	GrappleCore::RopeSimulation RopeSim;
+	/** Instance block in the rope manager while the rope is shown */
+	int32 RopeId = INDEX_NONE;
+	// Set by SetSignificance
+	int32 SignificanceUpdateInterval = 1;
+	int32 SignificanceRopeSegments = MAX_int32;
+	/** Time of the frames skipped since the last update */
+	float SkippedUpdateTime = 0.f;
+
+	FVector FlightVelocity = FVector::ZeroVector;
+	int32 FlightSweepCount = 0;
+	uint64 FlightSweepCycles = 0;
+
+	// Set by FireFromInput until the first flight reports the launch
+	bool bMeasureLaunch = false;
+	float LaunchInputTime = 0.f;
+	float LaunchFrameStartTime = 0.f;
+
+	/** Rope ends at the last applied update */
+	FVector LastRopeStart = FVector::ZeroVector;
+	FVector LastRopeEnd = FVector::ZeroVector;
+
+	void ShowRope();
+	void HideRope();
+	/**
+	 * Simulates and redraws the rope between RopeStart and RopeEnd, unless it is at rest and its ends did not move.
+	 * With batched ticking the simulation is queued on the grapple subsystem instead and redrawn after its rope phase.
+	 */
+	void UpdateRope(float DeltaTime, const FVector& RopeStart, const FVector& RopeEnd);
+	/** Pushes the simulated rope to the rope manager, game thread only */
+	void ApplyRope();
+	int32 GetDesiredRopeSegments() const;
+
+	/**
+	 * Moves the flying hook along its ballistic arc, sweeping it chord by chord on the GrappleHook trace channel.
+	 * Returns true and stops at the first hookable surface in the way, without moving the hook there.
+	 */
+	bool Fly(float DeltaTime, FHitResult& OutHit);
+	/** Flies the hook and hooks it on what it hit, false once it hooked. The rope is left to the state updates. */
+	bool FlyOrHook(float DeltaTime);
+	/** Reports the launch of a hook fired from an input at its first flight, which starts at FlightStartTime */
+	void MeasureLaunch(float FlightStartTime, float LeadTime);
 	
 	void SetProjectileState(ProjectileState newState);
 
 	void Docked_Enter();
-	//void Docked_Update();
-	//void Docked_Exit();
+	void Docked_Exit();
 
 	void Launching_Enter();
-	void Launching_Update();
+	void Launching_Update(float DeltaTime);
 	void Launching_Exit();
 
-	void Retracting_Enter();
 	void Retracting_Update(float DeltaTime);
-	void Retracting_Exit();
 
 	void Hooked_Enter();
-	void Hooked_Update();
+	void Hooked_Update(float DeltaTime);
 	void Hooked_Exit();
+
+	typedef AGrapplingHookTestProjectile FHook;
+	typedef TGrappleStateMachine<FHook, ProjectileState,
+		TGrappleState<ProjectileState, ProjectileState::DOCKED, FHook, &FHook::Docked_Enter, nullptr, &FHook::Docked_Exit>,
+		TGrappleState<ProjectileState, ProjectileState::LAUNCHING, FHook, &FHook::Launching_Enter, &FHook::Launching_Update, &FHook::Launching_Exit>,
+		TGrappleState<ProjectileState, ProjectileState::RETRACTING, FHook, nullptr, &FHook::Retracting_Update>,
+		TGrappleState<ProjectileState, ProjectileState::HOOKED, FHook, &FHook::Hooked_Enter, &FHook::Hooked_Update, &FHook::Hooked_Exit>
+	> FStateMachine;
+
+	FStateMachine StateMachine;
 };
 
@@ -0,0 +1,176 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+/**
+ * Accuracy and determinism tests of the grapple core, registered with ctest by Tests/CMakeLists.txt. Without an argument every test
+ * runs, otherwise only the named one. The exit code is non-zero when a test fails.
+ *
+ *   GrappleCoreTests SwingPredictorError
+ */
+
+#include "PendulumBatch.h"
+#include "SphericalPendulumTiers.h"
+#include "SwingPredictor.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace GrappleCore;
+
+namespace
+{
+	const float Gravity = -980.f;
+
+	/** The interpolation of the default tables, see SwingPredictor::MaxTableErrorBound */
+	bool TestSwingPredictorTables()
+	{
+		const float TableError = SwingPredictor::Get().GetTableError();
+		std::printf("  table error %g rad, bound %g rad\n", TableError, SwingPredictor::MaxTableErrorBound);
+		return TableError <= SwingPredictor::MaxTableErrorBound;
+	}
+
+	/**
+	 * Predicted swings against PendulumBatch's RK4 at a 0.5 ms step over five seconds, on a grid over the start angles,
+	 * angular velocities and rope lengths of the game's swings
+	 */
+	bool TestSwingPredictorError()
+	{
+		const SwingPredictor& Predictor = SwingPredictor::Get();
+		const float Duration = 5.f;
+		const int32_t Samples = 300;
+
+		PendulumBatch Batch;
+		Batch.SetIntegrator(PendulumIntegrator::RK4);
+		Batch.SetFixedTimeStep(0.0005f);
+		Batch.SetMaxSubsteps(1 << 20);
+
+		std::vector<SwingPredictor::FSwing> Swings;
+		std::vector<PendulumBatch::FHandle> Handles;
+		std::vector<float> Lengths;
+		for (int32_t AngleIndex = 0; AngleIndex <= 12; ++AngleIndex)
+		{
+			for (int32_t VelocityIndex = 0; VelocityIndex <= 8; ++VelocityIndex)
+			{
+				for (int32_t LengthIndex = 0; LengthIndex <= 4; ++LengthIndex)
+				{
+					const float Angle = -1.2f + 0.2f * AngleIndex;
+					const float Velocity = -2.f + 0.5f * VelocityIndex;
+					const float Length = 200.f + 450.f * LengthIndex;
+
+					SwingPredictor::FSwing Swing;
+					if (Predictor.MakeSwing(Angle, Velocity, Length, Gravity, Swing))
+					{
+						Swings.push_back(Swing);
+						Handles.push_back(Batch.Add(Vec3(), Velocity, Angle, Length, Gravity, 1.f, 0.f));
+						Lengths.push_back(Length);
+					}
+				}
+			}
+		}
+
+		float MaxAngleError = 0.f;
+		float MaxPositionError = 0.f;
+		for (int32_t Sample = 1; Sample <= Samples; ++Sample)
+		{
+			Batch.Update(Duration / Samples);
+			const float Time = Duration * Sample / Samples;
+			for (size_t Swinger = 0; Swinger < Swings.size(); ++Swinger)
+			{
+				// Both angles at the last fixed step, the batch's positions are interpolated
+				const float Angle = Predictor.GetAngle(Swings[Swinger], Time);
+				const float SteppedAngle = Batch.GetAngle(Handles[Swinger]);
+				const Vec3 Position = SwingPredictor::GetPosition(Vec3(), Lengths[Swinger], 1.f, 0.f, Angle);
+				const Vec3 SteppedPosition = SwingPredictor::GetPosition(Vec3(), Lengths[Swinger], 1.f, 0.f, SteppedAngle);
+				MaxAngleError = std::max(MaxAngleError, std::abs(std::remainder(SteppedAngle - Angle, 2.f * Pi)));
+				MaxPositionError = std::max(MaxPositionError, (Position - SteppedPosition).Size());
+			}
+		}
+
+		std::printf("  %d swings, angle error %g rad, position error %g cm, bound %g cm\n", static_cast<int32_t>(Swings.size()),
+			MaxAngleError, MaxPositionError, SwingPredictor::MaxPositionErrorBound);
+		return !Swings.empty() && MaxPositionError <= SwingPredictor::MaxPositionErrorBound;
+	}
+
+	/**
+	 * A swinger stepped on its own by whole fixed steps lands bit for bit where Update takes it, its neighbours in the
+	 * batch do not move, and Update leaves owner stepped swingers alone
+	 */
+	bool TestPendulumStepSwinger()
+	{
+		const float FixedTimeStep = 1.f / 60.f;
+		const int32_t Frames = 300;
+
+		SphericalPendulumBatch Updated, Stepped;
+		SphericalPendulumBatch::FHandle UpdatedHandles[3], SteppedHandles[3];
+		for (int32_t Swinger = 0; Swinger < 3; ++Swinger)
+		{
+			const Vec3 Offset(300.f + 100.f * Swinger, 50.f * Swinger, -400.f);
+			const Vec3 Velocity(0.f, 200.f, 0.f);
+			UpdatedHandles[Swinger] = Updated.Add(Vec3(), Offset, Velocity, Vec3(1.f, 0.f, 0.f), Gravity, 600.f);
+			SteppedHandles[Swinger] = Stepped.Add(Vec3(), Offset, Velocity, Vec3(1.f, 0.f, 0.f), Gravity, 600.f);
+			Updated.SetSteering(UpdatedHandles[Swinger], 0.5f, -0.25f);
+			Stepped.SetSteering(SteppedHandles[Swinger], 0.5f, -0.25f);
+		}
+		Updated.SetFixedTimeStep(FixedTimeStep);
+		Stepped.SetFixedTimeStep(FixedTimeStep);
+
+		const Vec3 StillOffset = Stepped.GetOffset(SteppedHandles[0]);
+		for (int32_t Frame = 0; Frame < Frames; ++Frame)
+		{
+			Updated.Update(FixedTimeStep);
+			Stepped.StepSwinger(SteppedHandles[1], FixedTimeStep);
+		}
+
+		const bool bSameSteps = Updated.GetOffset(UpdatedHandles[1]) == Stepped.GetOffset(SteppedHandles[1])
+			&& Updated.GetVelocity(UpdatedHandles[1]) == Stepped.GetVelocity(SteppedHandles[1]);
+		const bool bNeighboursStill = Stepped.GetOffset(SteppedHandles[0]) == StillOffset;
+
+		SphericalPendulumTiers Tiers;
+		const SphericalPendulumTiers::FHandle Handle = Tiers.Add(Vec3(), Vec3(300.f, 0.f, -400.f), Vec3(), Vec3(1.f, 0.f, 0.f), Gravity, 600.f);
+		Tiers.SetOwnerStepped(Handle, true);
+		const Vec3 OwnerOffset = Tiers.GetOffset(Handle);
+		Tiers.Update(1.f);
+		const bool bOwnerStepped = Tiers.GetOffset(Handle) == OwnerOffset && Tiers.Num() == 1 && Tiers.Num(0) == 0;
+
+		std::printf("  same steps %d, neighbours still %d, owner stepped %d\n", bSameSteps, bNeighboursStill, bOwnerStepped);
+		return bSameSteps && bNeighboursStill && bOwnerStepped;
+	}
+
+	struct FTest
+	{
+		const char* Name;
+		bool (*Run)();
+	};
+
+	const FTest Tests[] =
+	{
+		{ "SwingPredictorTables", &TestSwingPredictorTables },
+		{ "SwingPredictorError", &TestSwingPredictorError },
+		{ "PendulumStepSwinger", &TestPendulumStepSwinger },
+	};
+}
+
+int main(int ArgumentCount, char** Arguments)
+{
+	int32_t Failures = 0;
+	int32_t Runs = 0;
+	for (const FTest& Test : Tests)
+	{
+		if (ArgumentCount > 1 && std::strcmp(Arguments[1], Test.Name) != 0)
+			continue;
+
+		std::printf("%s\n", Test.Name);
+		const bool bPassed = Test.Run();
+		std::printf("  %s\n", bPassed ? "passed" : "FAILED");
+		Failures += bPassed ? 0 : 1;
+		++Runs;
+	}
+
+	if (Runs == 0)
+	{
+		std::printf("No test named %s\n", Arguments[1]);
+		return 1;
+	}
+	return Failures > 0 ? 1 : 0;
+}